@@ -0,0 +1,55 @@
+#version 330 core
+// Color pass: maps the output of the iteration pass (shader.frag) to colors.
+out vec4 FragColor;
+in vec4 gl_FragCoord;
+
+// (count, smooth escape fraction) per texel.
+uniform sampler2D iterations;
+// Texels of the iterations texture per output pixel along each side: below 1 for a preview,
+// s for an s x s supersampled texture.
+uniform vec2 texel_scale;
+// Texels averaged per output pixel along each side.
+uniform int samples;
+// One linearly filtered lookup table per layer (colormap::to_rgb32f()).
+uniform sampler1DArray color_tables;
+// Layer of color_tables.
+uniform uint color_map;
+
+// The view block of shader.frag, for max_iters: counts at the limit map to black.
+layout(std140) uniform ViewBlock {
+    float x_offset;
+    float y_offset;
+    float zoom;
+    float x_offset_lo;
+    float y_offset_lo;
+    float zoom_lo;
+    float zoom_mantissa;
+    int zoom_exponent;
+    int orbit_length;
+    uint kernel;
+    uint max_iters;
+    bool interior_checks;
+};
+
+vec3 get_color(uint iterations) {
+    if (iterations == max_iters) {
+        return vec3(0.0f, 0.0f, 0.0f);
+    }
+    // Centers of the first and last entry at 0 and 1, like colormap::get_color().
+    float size = float(textureSize(color_tables, 0).x);
+    float val = float(iterations) / float(max_iters);
+    float u = (val * (size - 1.0f) + 0.5f) / size;
+    return texture(color_tables, vec2(u, float(color_map))).rgb;
+}
+
+void main() {
+    ivec2 first = ivec2(floor(gl_FragCoord.xy) * texel_scale);
+    vec3 color = vec3(0.0f, 0.0f, 0.0f);
+    for (int y = 0; y < samples; ++y) {
+        for (int x = 0; x < samples; ++x) {
+            vec2 texel = texelFetch(iterations, first + ivec2(x, y), 0).xy;
+            color += get_color(uint(texel.x));
+        }
+    }
+    FragColor = vec4(color / float(samples * samples), 1.0);
+}
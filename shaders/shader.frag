@@ -1,531 +1,73 @@
 #version 330 core
+// For `precise`, which stops the compiler from simplifying away the rounding errors tracked by
+// the double-float arithmetic.
+#extension GL_ARB_gpu_shader5 : enable
+#ifndef GL_ARB_gpu_shader5
+#define precise
+#endif
 
-out vec4 FragColor;
+// Iteration pass: (count, smooth escape fraction) of each pixel, colored later by color.frag.
+out vec2 Iterations;
 in vec4 gl_FragCoord;
+// Size of the target, which changes with every pass of the progressive renderer.
 uniform vec2 view_port;
-uniform float x_offset;
-uniform float y_offset;
-uniform float zoom;
-uniform uint color_map;
+uniform samplerBuffer reference_orbit;
 
-#define MAX_ITERS 1000U
-#define THRESHOLD 4.0f
+// Adaptive supersampling (aa::find_edges()): with sample_side above 1, the target has
+// sample_side x sample_side texels per pixel of full_iterations, the counts of the full
+// resolution pass. Only the texels of the pixels that differ from a neighbor by more than
+// edge_threshold * max_iters are iterated, at a jittered position within their cell; the
+// others copy the count of their pixel.
+uniform int sample_side;
+uniform sampler2D full_iterations;
+uniform float edge_threshold;
+
+#define KERNEL_FLOAT 0U
+#define KERNEL_DOUBLE_FLOAT 1U
+#define KERNEL_PERTURBATION 2U
+
+// The view, written by the host in a single buffer update per frame (shaders::ViewBlock). Only
+// 4-byte scalars: the std140 offsets are the declaration order, with no padding.
+layout(std140) uniform ViewBlock {
+    float x_offset;
+    float y_offset;
+    float zoom;
+
+    // Double-float: the view is (x_offset + x_offset_lo, ...), each value split by the host
+    // into its float rounding and the float rounding of the remainder.
+    float x_offset_lo;
+    float y_offset_lo;
+    float zoom_lo;
+
+    // Perturbation: the view is zoom_mantissa * 2^zoom_exponent wide and each pixel iterates
+    // its delta from reference_orbit, the host-computed orbit of the pixel at the view anchor.
+    float zoom_mantissa;
+    int zoom_exponent;
+    int orbit_length;
+
+    uint kernel;
 
-vec3[] g_viridis_data = vec3[](
-        vec3(0.267004, 0.004874, 0.329415),
-        vec3(0.268510, 0.009605, 0.335427),
-        vec3(0.269944, 0.014625, 0.341379),
-        vec3(0.271305, 0.019942, 0.347269),
-        vec3(0.272594, 0.025563, 0.353093),
-        vec3(0.273809, 0.031497, 0.358853),
-        vec3(0.274952, 0.037752, 0.364543),
-        vec3(0.276022, 0.044167, 0.370164),
-        vec3(0.277018, 0.050344, 0.375715),
-        vec3(0.277941, 0.056324, 0.381191),
-        vec3(0.278791, 0.062145, 0.386592),
-        vec3(0.279566, 0.067836, 0.391917),
-        vec3(0.280267, 0.073417, 0.397163),
-        vec3(0.280894, 0.078907, 0.402329),
-        vec3(0.281446, 0.084320, 0.407414),
-        vec3(0.281924, 0.089666, 0.412415),
-        vec3(0.282327, 0.094955, 0.417331),
-        vec3(0.282656, 0.100196, 0.422160),
-        vec3(0.282910, 0.105393, 0.426902),
-        vec3(0.283091, 0.110553, 0.431554),
-        vec3(0.283197, 0.115680, 0.436115),
-        vec3(0.283229, 0.120777, 0.440584),
-        vec3(0.283187, 0.125848, 0.444960),
-        vec3(0.283072, 0.130895, 0.449241),
-        vec3(0.282884, 0.135920, 0.453427),
-        vec3(0.282623, 0.140926, 0.457517),
-        vec3(0.282290, 0.145912, 0.461510),
-        vec3(0.281887, 0.150881, 0.465405),
-        vec3(0.281412, 0.155834, 0.469201),
-        vec3(0.280868, 0.160771, 0.472899),
-        vec3(0.280255, 0.165693, 0.476498),
-        vec3(0.279574, 0.170599, 0.479997),
-        vec3(0.278826, 0.175490, 0.483397),
-        vec3(0.278012, 0.180367, 0.486697),
-        vec3(0.277134, 0.185228, 0.489898),
-        vec3(0.276194, 0.190074, 0.493001),
-        vec3(0.275191, 0.194905, 0.496005),
-        vec3(0.274128, 0.199721, 0.498911),
-        vec3(0.273006, 0.204520, 0.501721),
-        vec3(0.271828, 0.209303, 0.504434),
-        vec3(0.270595, 0.214069, 0.507052),
-        vec3(0.269308, 0.218818, 0.509577),
-        vec3(0.267968, 0.223549, 0.512008),
-        vec3(0.266580, 0.228262, 0.514349),
-        vec3(0.265145, 0.232956, 0.516599),
-        vec3(0.263663, 0.237631, 0.518762),
-        vec3(0.262138, 0.242286, 0.520837),
-        vec3(0.260571, 0.246922, 0.522828),
-        vec3(0.258965, 0.251537, 0.524736),
-        vec3(0.257322, 0.256130, 0.526563),
-        vec3(0.255645, 0.260703, 0.528312),
-        vec3(0.253935, 0.265254, 0.529983),
-        vec3(0.252194, 0.269783, 0.531579),
-        vec3(0.250425, 0.274290, 0.533103),
-        vec3(0.248629, 0.278775, 0.534556),
-        vec3(0.246811, 0.283237, 0.535941),
-        vec3(0.244972, 0.287675, 0.537260),
-        vec3(0.243113, 0.292092, 0.538516),
-        vec3(0.241237, 0.296485, 0.539709),
-        vec3(0.239346, 0.300855, 0.540844),
-        vec3(0.237441, 0.305202, 0.541921),
-        vec3(0.235526, 0.309527, 0.542944),
-        vec3(0.233603, 0.313828, 0.543914),
-        vec3(0.231674, 0.318106, 0.544834),
-        vec3(0.229739, 0.322361, 0.545706),
-        vec3(0.227802, 0.326594, 0.546532),
-        vec3(0.225863, 0.330805, 0.547314),
-        vec3(0.223925, 0.334994, 0.548053),
-        vec3(0.221989, 0.339161, 0.548752),
-        vec3(0.220057, 0.343307, 0.549413),
-        vec3(0.218130, 0.347432, 0.550038),
-        vec3(0.216210, 0.351535, 0.550627),
-        vec3(0.214298, 0.355619, 0.551184),
-        vec3(0.212395, 0.359683, 0.551710),
-        vec3(0.210503, 0.363727, 0.552206),
-        vec3(0.208623, 0.367752, 0.552675),
-        vec3(0.206756, 0.371758, 0.553117),
-        vec3(0.204903, 0.375746, 0.553533),
-        vec3(0.203063, 0.379716, 0.553925),
-        vec3(0.201239, 0.383670, 0.554294),
-        vec3(0.199430, 0.387607, 0.554642),
-        vec3(0.197636, 0.391528, 0.554969),
-        vec3(0.195860, 0.395433, 0.555276),
-        vec3(0.194100, 0.399323, 0.555565),
-        vec3(0.192357, 0.403199, 0.555836),
-        vec3(0.190631, 0.407061, 0.556089),
-        vec3(0.188923, 0.410910, 0.556326),
-        vec3(0.187231, 0.414746, 0.556547),
-        vec3(0.185556, 0.418570, 0.556753),
-        vec3(0.183898, 0.422383, 0.556944),
-        vec3(0.182256, 0.426184, 0.557120),
-        vec3(0.180629, 0.429975, 0.557282),
-        vec3(0.179019, 0.433756, 0.557430),
-        vec3(0.177423, 0.437527, 0.557565),
-        vec3(0.175841, 0.441290, 0.557685),
-        vec3(0.174274, 0.445044, 0.557792),
-        vec3(0.172719, 0.448791, 0.557885),
-        vec3(0.171176, 0.452530, 0.557965),
-        vec3(0.169646, 0.456262, 0.558030),
-        vec3(0.168126, 0.459988, 0.558082),
-        vec3(0.166617, 0.463708, 0.558119),
-        vec3(0.165117, 0.467423, 0.558141),
-        vec3(0.163625, 0.471133, 0.558148),
-        vec3(0.162142, 0.474838, 0.558140),
-        vec3(0.160665, 0.478540, 0.558115),
-        vec3(0.159194, 0.482237, 0.558073),
-        vec3(0.157729, 0.485932, 0.558013),
-        vec3(0.156270, 0.489624, 0.557936),
-        vec3(0.154815, 0.493313, 0.557840),
-        vec3(0.153364, 0.497000, 0.557724),
-        vec3(0.151918, 0.500685, 0.557587),
-        vec3(0.150476, 0.504369, 0.557430),
-        vec3(0.149039, 0.508051, 0.557250),
-        vec3(0.147607, 0.511733, 0.557049),
-        vec3(0.146180, 0.515413, 0.556823),
-        vec3(0.144759, 0.519093, 0.556572),
-        vec3(0.143343, 0.522773, 0.556295),
-        vec3(0.141935, 0.526453, 0.555991),
-        vec3(0.140536, 0.530132, 0.555659),
-        vec3(0.139147, 0.533812, 0.555298),
-        vec3(0.137770, 0.537492, 0.554906),
-        vec3(0.136408, 0.541173, 0.554483),
-        vec3(0.135066, 0.544853, 0.554029),
-        vec3(0.133743, 0.548535, 0.553541),
-        vec3(0.132444, 0.552216, 0.553018),
-        vec3(0.131172, 0.555899, 0.552459),
-        vec3(0.129933, 0.559582, 0.551864),
-        vec3(0.128729, 0.563265, 0.551229),
-        vec3(0.127568, 0.566949, 0.550556),
-        vec3(0.126453, 0.570633, 0.549841),
-        vec3(0.125394, 0.574318, 0.549086),
-        vec3(0.124395, 0.578002, 0.548287),
-        vec3(0.123463, 0.581687, 0.547445),
-        vec3(0.122606, 0.585371, 0.546557),
-        vec3(0.121831, 0.589055, 0.545623),
-        vec3(0.121148, 0.592739, 0.544641),
-        vec3(0.120565, 0.596422, 0.543611),
-        vec3(0.120092, 0.600104, 0.542530),
-        vec3(0.119738, 0.603785, 0.541400),
-        vec3(0.119512, 0.607464, 0.540218),
-        vec3(0.119423, 0.611141, 0.538982),
-        vec3(0.119483, 0.614817, 0.537692),
-        vec3(0.119699, 0.618490, 0.536347),
-        vec3(0.120081, 0.622161, 0.534946),
-        vec3(0.120638, 0.625828, 0.533488),
-        vec3(0.121380, 0.629492, 0.531973),
-        vec3(0.122312, 0.633153, 0.530398),
-        vec3(0.123444, 0.636809, 0.528763),
-        vec3(0.124780, 0.640461, 0.527068),
-        vec3(0.126326, 0.644107, 0.525311),
-        vec3(0.128087, 0.647749, 0.523491),
-        vec3(0.130067, 0.651384, 0.521608),
-        vec3(0.132268, 0.655014, 0.519661),
-        vec3(0.134692, 0.658636, 0.517649),
-        vec3(0.137339, 0.662252, 0.515571),
-        vec3(0.140210, 0.665859, 0.513427),
-        vec3(0.143303, 0.669459, 0.511215),
-        vec3(0.146616, 0.673050, 0.508936),
-        vec3(0.150148, 0.676631, 0.506589),
-        vec3(0.153894, 0.680203, 0.504172),
-        vec3(0.157851, 0.683765, 0.501686),
-        vec3(0.162016, 0.687316, 0.499129),
-        vec3(0.166383, 0.690856, 0.496502),
-        vec3(0.170948, 0.694384, 0.493803),
-        vec3(0.175707, 0.697900, 0.491033),
-        vec3(0.180653, 0.701402, 0.488189),
-        vec3(0.185783, 0.704891, 0.485273),
-        vec3(0.191090, 0.708366, 0.482284),
-        vec3(0.196571, 0.711827, 0.479221),
-        vec3(0.202219, 0.715272, 0.476084),
-        vec3(0.208030, 0.718701, 0.472873),
-        vec3(0.214000, 0.722114, 0.469588),
-        vec3(0.220124, 0.725509, 0.466226),
-        vec3(0.226397, 0.728888, 0.462789),
-        vec3(0.232815, 0.732247, 0.459277),
-        vec3(0.239374, 0.735588, 0.455688),
-        vec3(0.246070, 0.738910, 0.452024),
-        vec3(0.252899, 0.742211, 0.448284),
-        vec3(0.259857, 0.745492, 0.444467),
-        vec3(0.266941, 0.748751, 0.440573),
-        vec3(0.274149, 0.751988, 0.436601),
-        vec3(0.281477, 0.755203, 0.432552),
-        vec3(0.288921, 0.758394, 0.428426),
-        vec3(0.296479, 0.761561, 0.424223),
-        vec3(0.304148, 0.764704, 0.419943),
-        vec3(0.311925, 0.767822, 0.415586),
-        vec3(0.319809, 0.770914, 0.411152),
-        vec3(0.327796, 0.773980, 0.406640),
-        vec3(0.335885, 0.777018, 0.402049),
-        vec3(0.344074, 0.780029, 0.397381),
-        vec3(0.352360, 0.783011, 0.392636),
-        vec3(0.360741, 0.785964, 0.387814),
-        vec3(0.369214, 0.788888, 0.382914),
-        vec3(0.377779, 0.791781, 0.377939),
-        vec3(0.386433, 0.794644, 0.372886),
-        vec3(0.395174, 0.797475, 0.367757),
-        vec3(0.404001, 0.800275, 0.362552),
-        vec3(0.412913, 0.803041, 0.357269),
-        vec3(0.421908, 0.805774, 0.351910),
-        vec3(0.430983, 0.808473, 0.346476),
-        vec3(0.440137, 0.811138, 0.340967),
-        vec3(0.449368, 0.813768, 0.335384),
-        vec3(0.458674, 0.816363, 0.329727),
-        vec3(0.468053, 0.818921, 0.323998),
-        vec3(0.477504, 0.821444, 0.318195),
-        vec3(0.487026, 0.823929, 0.312321),
-        vec3(0.496615, 0.826376, 0.306377),
-        vec3(0.506271, 0.828786, 0.300362),
-        vec3(0.515992, 0.831158, 0.294279),
-        vec3(0.525776, 0.833491, 0.288127),
-        vec3(0.535621, 0.835785, 0.281908),
-        vec3(0.545524, 0.838039, 0.275626),
-        vec3(0.555484, 0.840254, 0.269281),
-        vec3(0.565498, 0.842430, 0.262877),
-        vec3(0.575563, 0.844566, 0.256415),
-        vec3(0.585678, 0.846661, 0.249897),
-        vec3(0.595839, 0.848717, 0.243329),
-        vec3(0.606045, 0.850733, 0.236712),
-        vec3(0.616293, 0.852709, 0.230052),
-        vec3(0.626579, 0.854645, 0.223353),
-        vec3(0.636902, 0.856542, 0.216620),
-        vec3(0.647257, 0.858400, 0.209861),
-        vec3(0.657642, 0.860219, 0.203082),
-        vec3(0.668054, 0.861999, 0.196293),
-        vec3(0.678489, 0.863742, 0.189503),
-        vec3(0.688944, 0.865448, 0.182725),
-        vec3(0.699415, 0.867117, 0.175971),
-        vec3(0.709898, 0.868751, 0.169257),
-        vec3(0.720391, 0.870350, 0.162603),
-        vec3(0.730889, 0.871916, 0.156029),
-        vec3(0.741388, 0.873449, 0.149561),
-        vec3(0.751884, 0.874951, 0.143228),
-        vec3(0.762373, 0.876424, 0.137064),
-        vec3(0.772852, 0.877868, 0.131109),
-        vec3(0.783315, 0.879285, 0.125405),
-        vec3(0.793760, 0.880678, 0.120005),
-        vec3(0.804182, 0.882046, 0.114965),
-        vec3(0.814576, 0.883393, 0.110347),
-        vec3(0.824940, 0.884720, 0.106217),
-        vec3(0.835270, 0.886029, 0.102646),
-        vec3(0.845561, 0.887322, 0.099702),
-        vec3(0.855810, 0.888601, 0.097452),
-        vec3(0.866013, 0.889868, 0.095953),
-        vec3(0.876168, 0.891125, 0.095250),
-        vec3(0.886271, 0.892374, 0.095374),
-        vec3(0.896320, 0.893616, 0.096335),
-        vec3(0.906311, 0.894855, 0.098125),
-        vec3(0.916242, 0.896091, 0.100717),
-        vec3(0.926106, 0.897330, 0.104071),
-        vec3(0.935904, 0.898570, 0.108131),
-        vec3(0.945636, 0.899815, 0.112838),
-        vec3(0.955300, 0.901065, 0.118128),
-        vec3(0.964894, 0.902323, 0.123941),
-        vec3(0.974417, 0.903590, 0.130215),
-        vec3(0.983868, 0.904867, 0.136897),
-        vec3(0.993248, 0.906157, 0.143936));
-
-vec3[] g_inferno_data = vec3[](
-        vec3(0.001462, 0.000466, 0.003866),
-        vec3(0.002267, 0.000270, 0.018570),
-        vec3(0.003299, 0.002249, 0.024239),
-        vec3(0.004547, 0.003392, 0.030909),
-        vec3(0.006006, 0.004692, 0.038558),
-        vec3(0.007676, 0.006136, 0.046836),
-        vec3(0.009561, 0.007713, 0.055143),
-        vec3(0.011663, 0.009417, 0.063460),
-        vec3(0.013995, 0.011225, 0.071862),
-        vec3(0.016561, 0.013136, 0.080282),
-        vec3(0.019373, 0.015133, 0.088767),
-        vec3(0.022447, 0.017199, 0.097327),
-        vec3(0.025793, 0.019331, 0.105930),
-        vec3(0.029432, 0.021503, 0.114621),
-        vec3(0.033385, 0.023702, 0.123397),
-        vec3(0.037668, 0.025921, 0.132232),
-        vec3(0.042253, 0.028139, 0.141141),
-        vec3(0.046915, 0.030324, 0.150164),
-        vec3(0.051644, 0.032474, 0.159254),
-        vec3(0.056449, 0.034569, 0.168414),
-        vec3(0.061340, 0.036590, 0.177642),
-        vec3(0.066331, 0.038504, 0.186962),
-        vec3(0.071429, 0.040294, 0.196354),
-        vec3(0.076637, 0.041905, 0.205799),
-        vec3(0.081962, 0.043328, 0.215289),
-        vec3(0.087411, 0.044556, 0.224813),
-        vec3(0.092990, 0.045583, 0.234358),
-        vec3(0.098702, 0.046402, 0.243904),
-        vec3(0.104551, 0.047008, 0.253430),
-        vec3(0.110536, 0.047399, 0.262912),
-        vec3(0.116656, 0.047574, 0.272321),
-        vec3(0.122908, 0.047536, 0.281624),
-        vec3(0.129285, 0.047293, 0.290788),
-        vec3(0.135778, 0.046856, 0.299776),
-        vec3(0.142378, 0.046242, 0.308553),
-        vec3(0.149073, 0.045468, 0.317085),
-        vec3(0.155850, 0.044559, 0.325338),
-        vec3(0.162689, 0.043554, 0.333277),
-        vec3(0.169575, 0.042489, 0.340874),
-        vec3(0.176493, 0.041402, 0.348111),
-        vec3(0.183429, 0.040329, 0.354971),
-        vec3(0.190367, 0.039309, 0.361447),
-        vec3(0.197297, 0.038400, 0.367535),
-        vec3(0.204209, 0.037632, 0.373238),
-        vec3(0.211095, 0.037030, 0.378563),
-        vec3(0.217949, 0.036615, 0.383522),
-        vec3(0.224763, 0.036405, 0.388129),
-        vec3(0.231538, 0.036405, 0.392400),
-        vec3(0.238273, 0.036621, 0.396353),
-        vec3(0.244967, 0.037055, 0.400007),
-        vec3(0.251620, 0.037705, 0.403378),
-        vec3(0.258234, 0.038571, 0.406485),
-        vec3(0.264810, 0.039647, 0.409345),
-        vec3(0.271347, 0.040922, 0.411976),
-        vec3(0.277850, 0.042353, 0.414392),
-        vec3(0.284321, 0.043933, 0.416608),
-        vec3(0.290763, 0.045644, 0.418637),
-        vec3(0.297178, 0.047470, 0.420491),
-        vec3(0.303568, 0.049396, 0.422182),
-        vec3(0.309935, 0.051407, 0.423721),
-        vec3(0.316282, 0.053490, 0.425116),
-        vec3(0.322610, 0.055634, 0.426377),
-        vec3(0.328921, 0.057827, 0.427511),
-        vec3(0.335217, 0.060060, 0.428524),
-        vec3(0.341500, 0.062325, 0.429425),
-        vec3(0.347771, 0.064616, 0.430217),
-        vec3(0.354032, 0.066925, 0.430906),
-        vec3(0.360284, 0.069247, 0.431497),
-        vec3(0.366529, 0.071579, 0.431994),
-        vec3(0.372768, 0.073915, 0.432400),
-        vec3(0.379001, 0.076253, 0.432719),
-        vec3(0.385228, 0.078591, 0.432955),
-        vec3(0.391453, 0.080927, 0.433109),
-        vec3(0.397674, 0.083257, 0.433183),
-        vec3(0.403894, 0.085580, 0.433179),
-        vec3(0.410113, 0.087896, 0.433098),
-        vec3(0.416331, 0.090203, 0.432943),
-        vec3(0.422549, 0.092501, 0.432714),
-        vec3(0.428768, 0.094790, 0.432412),
-        vec3(0.434987, 0.097069, 0.432039),
-        vec3(0.441207, 0.099338, 0.431594),
-        vec3(0.447428, 0.101597, 0.431080),
-        vec3(0.453651, 0.103848, 0.430498),
-        vec3(0.459875, 0.106089, 0.429846),
-        vec3(0.466100, 0.108322, 0.429125),
-        vec3(0.472328, 0.110547, 0.428334),
-        vec3(0.478558, 0.112764, 0.427475),
-        vec3(0.484789, 0.114974, 0.426548),
-        vec3(0.491022, 0.117179, 0.425552),
-        vec3(0.497257, 0.119379, 0.424488),
-        vec3(0.503493, 0.121575, 0.423356),
-        vec3(0.509730, 0.123769, 0.422156),
-        vec3(0.515967, 0.125960, 0.420887),
-        vec3(0.522206, 0.128150, 0.419549),
-        vec3(0.528444, 0.130341, 0.418142),
-        vec3(0.534683, 0.132534, 0.416667),
-        vec3(0.540920, 0.134729, 0.415123),
-        vec3(0.547157, 0.136929, 0.413511),
-        vec3(0.553392, 0.139134, 0.411829),
-        vec3(0.559624, 0.141346, 0.410078),
-        vec3(0.565854, 0.143567, 0.408258),
-        vec3(0.572081, 0.145797, 0.406369),
-        vec3(0.578304, 0.148039, 0.404411),
-        vec3(0.584521, 0.150294, 0.402385),
-        vec3(0.590734, 0.152563, 0.400290),
-        vec3(0.596940, 0.154848, 0.398125),
-        vec3(0.603139, 0.157151, 0.395891),
-        vec3(0.609330, 0.159474, 0.393589),
-        vec3(0.615513, 0.161817, 0.391219),
-        vec3(0.621685, 0.164184, 0.388781),
-        vec3(0.627847, 0.166575, 0.386276),
-        vec3(0.633998, 0.168992, 0.383704),
-        vec3(0.640135, 0.171438, 0.381065),
-        vec3(0.646260, 0.173914, 0.378359),
-        vec3(0.652369, 0.176421, 0.375586),
-        vec3(0.658463, 0.178962, 0.372748),
-        vec3(0.664540, 0.181539, 0.369846),
-        vec3(0.670599, 0.184153, 0.366879),
-        vec3(0.676638, 0.186807, 0.363849),
-        vec3(0.682656, 0.189501, 0.360757),
-        vec3(0.688653, 0.192239, 0.357603),
-        vec3(0.694627, 0.195021, 0.354388),
-        vec3(0.700576, 0.197851, 0.351113),
-        vec3(0.706500, 0.200728, 0.347777),
-        vec3(0.712396, 0.203656, 0.344383),
-        vec3(0.718264, 0.206636, 0.340931),
-        vec3(0.724103, 0.209670, 0.337424),
-        vec3(0.729909, 0.212759, 0.333861),
-        vec3(0.735683, 0.215906, 0.330245),
-        vec3(0.741423, 0.219112, 0.326576),
-        vec3(0.747127, 0.222378, 0.322856),
-        vec3(0.752794, 0.225706, 0.319085),
-        vec3(0.758422, 0.229097, 0.315266),
-        vec3(0.764010, 0.232554, 0.311399),
-        vec3(0.769556, 0.236077, 0.307485),
-        vec3(0.775059, 0.239667, 0.303526),
-        vec3(0.780517, 0.243327, 0.299523),
-        vec3(0.785929, 0.247056, 0.295477),
-        vec3(0.791293, 0.250856, 0.291390),
-        vec3(0.796607, 0.254728, 0.287264),
-        vec3(0.801871, 0.258674, 0.283099),
-        vec3(0.807082, 0.262692, 0.278898),
-        vec3(0.812239, 0.266786, 0.274661),
-        vec3(0.817341, 0.270954, 0.270390),
-        vec3(0.822386, 0.275197, 0.266085),
-        vec3(0.827372, 0.279517, 0.261750),
-        vec3(0.832299, 0.283913, 0.257383),
-        vec3(0.837165, 0.288385, 0.252988),
-        vec3(0.841969, 0.292933, 0.248564),
-        vec3(0.846709, 0.297559, 0.244113),
-        vec3(0.851384, 0.302260, 0.239636),
-        vec3(0.855992, 0.307038, 0.235133),
-        vec3(0.860533, 0.311892, 0.230606),
-        vec3(0.865006, 0.316822, 0.226055),
-        vec3(0.869409, 0.321827, 0.221482),
-        vec3(0.873741, 0.326906, 0.216886),
-        vec3(0.878001, 0.332060, 0.212268),
-        vec3(0.882188, 0.337287, 0.207628),
-        vec3(0.886302, 0.342586, 0.202968),
-        vec3(0.890341, 0.347957, 0.198286),
-        vec3(0.894305, 0.353399, 0.193584),
-        vec3(0.898192, 0.358911, 0.188860),
-        vec3(0.902003, 0.364492, 0.184116),
-        vec3(0.905735, 0.370140, 0.179350),
-        vec3(0.909390, 0.375856, 0.174563),
-        vec3(0.912966, 0.381636, 0.169755),
-        vec3(0.916462, 0.387481, 0.164924),
-        vec3(0.919879, 0.393389, 0.160070),
-        vec3(0.923215, 0.399359, 0.155193),
-        vec3(0.926470, 0.405389, 0.150292),
-        vec3(0.929644, 0.411479, 0.145367),
-        vec3(0.932737, 0.417627, 0.140417),
-        vec3(0.935747, 0.423831, 0.135440),
-        vec3(0.938675, 0.430091, 0.130438),
-        vec3(0.941521, 0.436405, 0.125409),
-        vec3(0.944285, 0.442772, 0.120354),
-        vec3(0.946965, 0.449191, 0.115272),
-        vec3(0.949562, 0.455660, 0.110164),
-        vec3(0.952075, 0.462178, 0.105031),
-        vec3(0.954506, 0.468744, 0.099874),
-        vec3(0.956852, 0.475356, 0.094695),
-        vec3(0.959114, 0.482014, 0.089499),
-        vec3(0.961293, 0.488716, 0.084289),
-        vec3(0.963387, 0.495462, 0.079073),
-        vec3(0.965397, 0.502249, 0.073859),
-        vec3(0.967322, 0.509078, 0.068659),
-        vec3(0.969163, 0.515946, 0.063488),
-        vec3(0.970919, 0.522853, 0.058367),
-        vec3(0.972590, 0.529798, 0.053324),
-        vec3(0.974176, 0.536780, 0.048392),
-        vec3(0.975677, 0.543798, 0.043618),
-        vec3(0.977092, 0.550850, 0.039050),
-        vec3(0.978422, 0.557937, 0.034931),
-        vec3(0.979666, 0.565057, 0.031409),
-        vec3(0.980824, 0.572209, 0.028508),
-        vec3(0.981895, 0.579392, 0.026250),
-        vec3(0.982881, 0.586606, 0.024661),
-        vec3(0.983779, 0.593849, 0.023770),
-        vec3(0.984591, 0.601122, 0.023606),
-        vec3(0.985315, 0.608422, 0.024202),
-        vec3(0.985952, 0.615750, 0.025592),
-        vec3(0.986502, 0.623105, 0.027814),
-        vec3(0.986964, 0.630485, 0.030908),
-        vec3(0.987337, 0.637890, 0.034916),
-        vec3(0.987622, 0.645320, 0.039886),
-        vec3(0.987819, 0.652773, 0.045581),
-        vec3(0.987926, 0.660250, 0.051750),
-        vec3(0.987945, 0.667748, 0.058329),
-        vec3(0.987874, 0.675267, 0.065257),
-        vec3(0.987714, 0.682807, 0.072489),
-        vec3(0.987464, 0.690366, 0.079990),
-        vec3(0.987124, 0.697944, 0.087731),
-        vec3(0.986694, 0.705540, 0.095694),
-        vec3(0.986175, 0.713153, 0.103863),
-        vec3(0.985566, 0.720782, 0.112229),
-        vec3(0.984865, 0.728427, 0.120785),
-        vec3(0.984075, 0.736087, 0.129527),
-        vec3(0.983196, 0.743758, 0.138453),
-        vec3(0.982228, 0.751442, 0.147565),
-        vec3(0.981173, 0.759135, 0.156863),
-        vec3(0.980032, 0.766837, 0.166353),
-        vec3(0.978806, 0.774545, 0.176037),
-        vec3(0.977497, 0.782258, 0.185923),
-        vec3(0.976108, 0.789974, 0.196018),
-        vec3(0.974638, 0.797692, 0.206332),
-        vec3(0.973088, 0.805409, 0.216877),
-        vec3(0.971468, 0.813122, 0.227658),
-        vec3(0.969783, 0.820825, 0.238686),
-        vec3(0.968041, 0.828515, 0.249972),
-        vec3(0.966243, 0.836191, 0.261534),
-        vec3(0.964394, 0.843848, 0.273391),
-        vec3(0.962517, 0.851476, 0.285546),
-        vec3(0.960626, 0.859069, 0.298010),
-        vec3(0.958720, 0.866624, 0.310820),
-        vec3(0.956834, 0.874129, 0.323974),
-        vec3(0.954997, 0.881569, 0.337475),
-        vec3(0.953215, 0.888942, 0.351369),
-        vec3(0.951546, 0.896226, 0.365627),
-        vec3(0.950018, 0.903409, 0.380271),
-        vec3(0.948683, 0.910473, 0.395289),
-        vec3(0.947594, 0.917399, 0.410665),
-        vec3(0.946809, 0.924168, 0.426373),
-        vec3(0.946392, 0.930761, 0.442367),
-        vec3(0.946403, 0.937159, 0.458592),
-        vec3(0.946903, 0.943348, 0.474970),
-        vec3(0.947937, 0.949318, 0.491426),
-        vec3(0.949545, 0.955063, 0.507860),
-        vec3(0.951740, 0.960587, 0.524203),
-        vec3(0.954529, 0.965896, 0.540361),
-        vec3(0.957896, 0.971003, 0.556275),
-        vec3(0.961812, 0.975924, 0.571925),
-        vec3(0.966249, 0.980678, 0.587206),
-        vec3(0.971162, 0.985282, 0.602154),
-        vec3(0.976511, 0.989753, 0.616760),
-        vec3(0.982257, 0.994109, 0.631017),
-        vec3(0.988362, 0.998364, 0.644924));
+    // Iteration limit, owned by the host (App).
+    uint max_iters;
+
+    // Interior shortcuts (cpu::row_kernel()): the main cardioid and period-2 bulb test, and the
+    // exact cycle check, compared with the value saved at iteration FIRST_PERIOD_CHECK and then
+    // at every power of two.
+    bool interior_checks;
+};
+
+// Specialization: the host can define KERNEL (one of the KERNEL_* values) and INTERIOR_CHECKS
+// (true or false) ahead of this source. The branches on them are then resolved by the compiler
+// and each variant only contains its own kernel. Otherwise they are read from ViewBlock.
+#ifndef KERNEL
+#define KERNEL kernel
+#endif
+#ifndef INTERIOR_CHECKS
+#define INTERIOR_CHECKS interior_checks
+#endif
+
+#define THRESHOLD 4.0f
+#define FIRST_PERIOD_CHECK 2U
 
 float square(float x) {
     return x * x;
@@ -535,78 +77,266 @@ float sq_abs_val(float real, float imag) {
     return square(real) + square(imag);
 }
 
-uint calc_iters(float real, float imag) {
+bool in_main_bulbs(float real, float imag) {
+    float x = real - 0.25f;
+    float q = square(x) + square(imag);
+    return q * (q + x) <= 0.25f * square(imag) || square(real + 1.0f) + square(imag) <= 0.0625f;
+}
+
+// norm receives |z|^2 of the last iterate, past THRESHOLD unless max_iters was reached.
+uint calc_iters(float real, float imag, out float norm) {
+    norm = 0.0f;
+    if (INTERIOR_CHECKS && in_main_bulbs(real, imag)) {
+        return max_iters;
+    }
     float ref_real = real;
     float ref_imag = imag;
+    vec2 saved = vec2(real, imag);
+    uint next_save = FIRST_PERIOD_CHECK;
     uint iterations = 0U;
 
-    while ((iterations < MAX_ITERS) && (sq_abs_val(real, imag) <= THRESHOLD)) {
+    norm = sq_abs_val(real, imag);
+    while ((iterations < max_iters) && (norm <= THRESHOLD)) {
         float temp = square(real) - square(imag) + ref_real;
         imag = 2.0f * real * imag + ref_imag;
         real = temp;
         ++iterations;
+        norm = sq_abs_val(real, imag);
+        if (INTERIOR_CHECKS) {
+            if (vec2(real, imag) == saved) {
+                return max_iters;
+            }
+            if (iterations == next_save) {
+                saved = vec2(real, imag);
+                next_save *= 2U;
+            }
+        }
     }
     return iterations;
 }
 
-vec2 real_imag() {
-    return (((gl_FragCoord.xy / view_port - vec2(0.7f, 0.5f)) * zoom) + vec2(x_offset, y_offset)) * 2.5f;
+// Double-float arithmetic: a value is the unevaluated sum hi + lo of two floats, |lo| being at
+// most half an ulp of hi, for about 48 bits of mantissa. Based on the error-free transformations
+// of Knuth (two_sum) and Dekker (two_prod).
+
+vec2 quick_two_sum(float a, float b) {
+    precise float s = a + b;
+    precise float e = b - (s - a);
+    return vec2(s, e);
+}
+
+vec2 two_sum(float a, float b) {
+    precise float s = a + b;
+    precise float v = s - a;
+    precise float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+
+// Splits a in two halves of 12 significant bits, whose products are exact.
+vec2 split(float a) {
+    precise float t = 4097.0f * a;
+    precise float hi = t - (t - a);
+    precise float lo = a - hi;
+    return vec2(hi, lo);
+}
+
+vec2 two_prod(float a, float b) {
+    precise float p = a * b;
+    vec2 as = split(a);
+    vec2 bs = split(b);
+    precise float e = ((as.x * bs.x - p) + as.x * bs.y + as.y * bs.x) + as.y * bs.y;
+    return vec2(p, e);
 }
 
-vec3 inferno(float val) {
-    int index = int(val * float(g_inferno_data.length() - 1));
-    vec3 color = g_inferno_data[index];
-    return color;
+vec2 df_add(vec2 a, vec2 b) {
+    vec2 s = two_sum(a.x, b.x);
+    return quick_two_sum(s.x, s.y + a.y + b.y);
 }
 
-vec3 viridis(float val) {
-    int index = int(val * float(g_inferno_data.length() - 1));
-    vec3 color = g_viridis_data[index];
-    return color;
+vec2 df_mul(vec2 a, vec2 b) {
+    vec2 p = two_prod(a.x, b.x);
+    return quick_two_sum(p.x, p.y + a.x * b.y + a.y * b.x);
+}
+
+// calc_iters() in double-float. Only the escape test runs on the high parts. The bulb test is
+// left out: on the high parts alone it would misplace the boundary by more than a pixel.
+uint calc_iters_df(vec2 real, vec2 imag, out float norm) {
+    vec2 ref_real = real;
+    vec2 ref_imag = imag;
+    vec4 saved = vec4(real, imag);
+    uint next_save = FIRST_PERIOD_CHECK;
+    uint iterations = 0U;
+
+    norm = sq_abs_val(real.x, imag.x);
+    while ((iterations < max_iters) && (norm <= THRESHOLD)) {
+        vec2 temp = df_add(df_add(df_mul(real, real), -df_mul(imag, imag)), ref_real);
+        imag = df_add(df_mul(df_mul(vec2(2.0f, 0.0f), real), imag), ref_imag);
+        real = temp;
+        ++iterations;
+        norm = sq_abs_val(real.x, imag.x);
+        if (INTERIOR_CHECKS) {
+            if (vec4(real, imag) == saved) {
+                return max_iters;
+            }
+            if (iterations == next_save) {
+                saved = vec4(real, imag);
+                next_save *= 2U;
+            }
+        }
+    }
+    return iterations;
 }
 
-vec3 rainbow(float val) {
-    if (val == 1.0f) {
-        val -= 0.0001f;
+// 2^e, exact; flushes to zero below the normal float range.
+float pow2(int e) {
+    if (e < -126) {
+        return 0.0f;
     }
-    const float m = 0.25f;
-    uint num = uint(val / m);
-    if (num > 3U) {
-        num = 3U;
+    return intBitsToFloat((min(e, 127) + 127) << 23);
+}
+
+// Keeps the mantissa of a rescaled delta (delta = w * 2^e) around 1.
+void rescale(inout vec2 w, inout int e) {
+    float m = max(abs(w.x), abs(w.y));
+    if (m == 0.0f || (m > 1.0f / 256.0f && m < 256.0f)) {
+        return;
     }
-    float s = (val - float(num) * m) / m;
-
-    switch (num) {
-        case 0U:
-        return vec3(0.0f, s, 1.0f);
-        case 1U:
-        return vec3(0.0f, 1.0f, 1.0f - s);
-        case 2U:
-        return vec3(s, 1.0f, 0.0f);
-        case 3U:
-        return vec3(1.0f, 1.0f - s, 0.0f);
-        default:
-        return vec3(0.0f, 0.0f, 0.0f);
+    int k = ((floatBitsToInt(m) >> 23) & 0xff) - 127;
+    w *= pow2(-k);
+    e += k;
+}
+
+// Same count as calc_iters() for the pixel at reference + dc * 2^zoom_exponent. The delta
+// from the reference orbit is kept as w * 2^e so that it does not underflow at deep zooms.
+// When |z| < |delta| the delta is rebased on the start of the orbit (it would otherwise lose
+// its precision and glitch), and so it is when the reference escapes before the pixel.
+// The cycle check runs on the whole (m, w, e) state, the bulb test is left out.
+uint calc_iters_perturbed(vec2 dc, out float norm) {
+    norm = 0.0f;
+    vec2 w = vec2(0.0f, 0.0f);
+    int e = zoom_exponent;
+    int m = 0;
+    vec2 saved_w = w;
+    ivec2 saved_me = ivec2(m, e);
+    uint next_save = FIRST_PERIOD_CHECK;
+    for (uint k = 1U; k <= max_iters; ++k) {
+        vec2 x = texelFetch(reference_orbit, m).xy;
+        // delta' = 2 X delta + delta^2 + dc
+        vec2 linear = 2.0f * vec2(x.x * w.x - x.y * w.y, x.x * w.y + x.y * w.x);
+        vec2 quadratic = vec2(square(w.x) - square(w.y), 2.0f * w.x * w.y) * pow2(e);
+        w = linear + quadratic + dc * pow2(zoom_exponent - e);
+        rescale(w, e);
+        ++m;
+
+        vec2 delta = w * pow2(e);
+        vec2 z = texelFetch(reference_orbit, m).xy + delta;
+        float z_norm = sq_abs_val(z.x, z.y);
+        if (z_norm > THRESHOLD) {
+            norm = z_norm;
+            return k - 1U;
+        }
+        if (z_norm < sq_abs_val(delta.x, delta.y) || m + 1 == orbit_length) {
+            w = z;
+            e = 0;
+            rescale(w, e);
+            m = 0;
+        }
+        if (INTERIOR_CHECKS) {
+            if (w == saved_w && ivec2(m, e) == saved_me) {
+                return max_iters;
+            }
+            if (k == next_save) {
+                saved_w = w;
+                saved_me = ivec2(m, e);
+                next_save *= 2U;
+            }
+        }
     }
+    return max_iters;
+}
+
+// Position of the sample in the target: the fragment center, or a point of its cell when
+// supersampling.
+vec2 frag_xy;
+
+vec2 real_imag() {
+    return (((frag_xy / view_port - vec2(0.7f, 0.5f)) * zoom) + vec2(x_offset, y_offset)) * 2.5f;
+}
+
+// real_imag() in double-float: (real.x + real.y, imag.x + imag.y).
+void real_imag_df(out vec2 real, out vec2 imag) {
+    vec2 xy = frag_xy / view_port - vec2(0.7f, 0.5f);
+    vec2 df_zoom = vec2(zoom, zoom_lo);
+    real = df_mul(df_add(df_mul(vec2(xy.x, 0.0f), df_zoom), vec2(x_offset, x_offset_lo)),
+                  vec2(2.5f, 0.0f));
+    imag = df_mul(df_add(df_mul(vec2(xy.y, 0.0f), df_zoom), vec2(y_offset, y_offset_lo)),
+                  vec2(2.5f, 0.0f));
+}
+
+vec2 delta_c() {
+    return (frag_xy / view_port - vec2(0.7f, 0.5f)) * zoom_mantissa * 2.5f;
 }
 
-vec3 get_color(uint iterations) {
-    if (iterations == MAX_ITERS) {
-        return vec3(0.0f, 0.0f, 0.0f);
+// Fractional part of the continuous escape count n + 1 - log2(log2(|z|)).
+float smooth_fraction(uint iterations, float norm) {
+    if (iterations == max_iters) {
+        return 0.0f;
     }
-    switch (color_map) {
-        case 0U:
-        return rainbow(float(iterations) / MAX_ITERS);
-        case 1U:
-        return inferno(float(iterations) / MAX_ITERS);
-        case 2U:
-        return viridis(float(iterations) / MAX_ITERS);
+    return clamp(1.0f - log2(0.5f * log2(norm)), 0.0f, 1.0f);
+}
+
+bool on_edge(ivec2 pixel) {
+    // Not textureSize(): targets can be larger than the area drawn (gl::Framebuffer::resize()).
+    ivec2 last = ivec2(view_port) / sample_side - 1;
+    float center = texelFetch(full_iterations, pixel, 0).x;
+    float limit = float(max_iters);
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            ivec2 at = clamp(pixel + ivec2(x, y), ivec2(0), last);
+            float neighbor = texelFetch(full_iterations, at, 0).x;
+            if (abs(neighbor - center) > edge_threshold * limit
+                || (neighbor == limit) != (center == limit)) {
+                return true;
+            }
+        }
     }
-    return vec3(0.0f, 0.0f, 0.0f);
+    return false;
+}
+
+// Two values in [-0.5, 0.5) from a texel (the lowbias32 integer hash).
+vec2 jitter(ivec2 texel) {
+    uint h = uint(texel.x) * 0x9e3779b9U ^ uint(texel.y) * 0x85ebca6bU;
+    h ^= h >> 16U;
+    h *= 0x7feb352dU;
+    h ^= h >> 15U;
+    h *= 0x846ca68bU;
+    h ^= h >> 16U;
+    return vec2(float(h & 0xffffU), float(h >> 16U)) / 65536.0f - 0.5f;
 }
 
 void main() {
-    vec2 normalized_xy = real_imag();
-    uint iterations = calc_iters(normalized_xy.x, normalized_xy.y);
-    FragColor = vec4(get_color(iterations), 1.0);
+    frag_xy = gl_FragCoord.xy;
+    if (sample_side > 1) {
+        ivec2 texel = ivec2(gl_FragCoord.xy);
+        ivec2 pixel = texel / sample_side;
+        if (!on_edge(pixel)) {
+            Iterations = texelFetch(full_iterations, pixel, 0).xy;
+            return;
+        }
+        frag_xy += jitter(texel);
+    }
+    uint iterations;
+    float norm;
+    if (KERNEL == KERNEL_PERTURBATION) {
+        iterations = calc_iters_perturbed(delta_c(), norm);
+    } else if (KERNEL == KERNEL_DOUBLE_FLOAT) {
+        vec2 real;
+        vec2 imag;
+        real_imag_df(real, imag);
+        iterations = calc_iters_df(real, imag, norm);
+    } else {
+        vec2 normalized_xy = real_imag();
+        iterations = calc_iters(normalized_xy.x, normalized_xy.y, norm);
+    }
+    Iterations = vec2(float(iterations), smooth_fraction(iterations, norm));
 }
@@ -0,0 +1,29 @@
+#version 330 core
+// Tile pass: fills the target of an iteration pass from the tiles of gl::TileAtlas instead of
+// iterating, each pixel taking the nearest sample of the tile it falls in. The host defines
+// TILE_SIZE (tiles::g_size) ahead of this source.
+out vec2 Iterations;
+in vec4 gl_FragCoord;
+
+// (count, smooth escape fraction) of TILE_SIZE x TILE_SIZE samples per slot.
+uniform sampler2D atlas;
+uniform int slots_per_row;
+// Slot of each tile of the layout, row-major from its bottom-left tile.
+uniform isamplerBuffer slots;
+// Columns and rows of tiles of the layout.
+uniform ivec2 layout_size;
+// Position of the center of pixel (0, 0) in tiles from the bottom-left one, and the spacing of
+// the pixels (tiles::Layout).
+uniform vec2 origin;
+uniform vec2 spacing;
+
+void main() {
+    vec2 position = origin + floor(gl_FragCoord.xy) * spacing;
+    ivec2 tile = clamp(ivec2(floor(position)), ivec2(0), layout_size - 1);
+    ivec2 sample = clamp(ivec2((position - vec2(tile)) * float(TILE_SIZE)),
+                         ivec2(0),
+                         ivec2(TILE_SIZE - 1));
+    int slot = texelFetch(slots, tile.y * layout_size.x + tile.x).r;
+    ivec2 corner = ivec2(slot % slots_per_row, slot / slots_per_row) * TILE_SIZE;
+    Iterations = texelFetch(atlas, corner + sample, 0).xy;
+}
@@ -0,0 +1,61 @@
+#include "antialias.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace aa {
+
+auto grid_side(int max_samples) -> int {
+    return std::max(1, static_cast<int>(std::sqrt(static_cast<double>(max_samples))));
+}
+
+auto find_edges(std::span<std::uint32_t const> counts,
+                int width,
+                int height,
+                std::uint32_t max_iters,
+                float threshold) -> std::vector<std::size_t> {
+    auto const w = static_cast<std::size_t>(width);
+    auto const limit = static_cast<double>(threshold) * static_cast<double>(max_iters);
+    auto const differs = [&](std::uint32_t a, std::uint32_t b) {
+        auto const diff = a > b ? a - b : b - a;
+        return static_cast<double>(diff) > limit || ((a == max_iters) != (b == max_iters));
+    };
+    auto edges = std::vector<std::size_t>{};
+    for (auto y = 0; y < height; ++y) {
+        auto const y_begin = std::max(y - 1, 0);
+        auto const y_end = std::min(y + 2, height);
+        for (auto x = 0; x < width; ++x) {
+            auto const x_begin = std::max(x - 1, 0);
+            auto const x_end = std::min(x + 2, width);
+            auto const index = static_cast<std::size_t>(y) * w + static_cast<std::size_t>(x);
+            auto const center = counts[index];
+            auto edge = false;
+            for (auto ny = y_begin; ny < y_end && !edge; ++ny) {
+                for (auto nx = x_begin; nx < x_end && !edge; ++nx) {
+                    auto const neighbor
+                        = counts[static_cast<std::size_t>(ny) * w + static_cast<std::size_t>(nx)];
+                    edge = differs(center, neighbor);
+                }
+            }
+            if (edge) {
+                edges.push_back(index);
+            }
+        }
+    }
+    return edges;
+}
+
+auto disagree(std::span<std::uint32_t const> counts, std::uint32_t max_iters, float threshold)
+    -> bool {
+    if (counts.empty()) {
+        return false;
+    }
+    auto const [low, high] = std::ranges::minmax(counts);
+    auto const limit = static_cast<double>(threshold) * static_cast<double>(max_iters);
+    return static_cast<double>(high - low) > limit || (high == max_iters && low != max_iters);
+}
+}  // namespace aa
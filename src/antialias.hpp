@@ -0,0 +1,52 @@
+#ifndef ANTIALIAS_HPP
+#define ANTIALIAS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Adaptive supersampling: a frame is computed with one sample per pixel, then only the pixels
+// on an edge, whose count differs strongly from a neighbor, get a grid of extra samples that
+// the color pass averages. Elsewhere the colors hardly change within a pixel. Edge pixels first
+// get the first and last rows of their grid, and the rows between only if those disagree.
+namespace aa {
+// Samples per pixel of an edge, at most. The viewer keeps a target of that many RG32F texels
+// per pixel: 4x4 would take about 470 MB at 2560x1440.
+inline constexpr auto g_default_max_samples = 4;
+// Count difference with a neighbor, relative to the iteration limit, that makes an edge: about
+// four entries of a color table, which spans the whole limit. Lower thresholds add samples
+// where they hardly change the colors.
+inline constexpr auto g_edge_threshold = 1.0F / 64.0F;
+
+// Side of the largest square grid of at most max_samples samples.
+[[nodiscard]] auto grid_side(int max_samples) -> int;
+
+// Indices of the pixels of width x height counts that differ from one of their 8 neighbors by
+// more than threshold * max_iters, or reach max_iters when the neighbor does not, ascending.
+[[nodiscard]] auto find_edges(std::span<std::uint32_t const> counts,
+                              int width,
+                              int height,
+                              std::uint32_t max_iters,
+                              float threshold = g_edge_threshold) -> std::vector<std::size_t>;
+
+// Whether the samples of a pixel differ by more than threshold * max_iters, or some reach
+// max_iters and others do not.
+[[nodiscard]] auto disagree(std::span<std::uint32_t const> counts,
+                            std::uint32_t max_iters,
+                            float threshold = g_edge_threshold) -> bool;
+
+// The extra samples of the edge pixels of a frame: for pixels[i], the counts at the side x side
+// cell centers of the pixel, bottom row first, from counts[i * side * side].
+struct Samples {
+    int side{1};
+    std::vector<std::size_t> pixels;
+    std::vector<std::uint32_t> counts;
+
+    [[nodiscard]] auto per_pixel() const -> std::size_t {
+        return static_cast<std::size_t>(side) * static_cast<std::size_t>(side);
+    }
+};
+}  // namespace aa
+
+#endif
@@ -7,21 +7,52 @@
 #include "fmt/base.h"
 #include "fmt/core.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <filesystem>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <span>
+#include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
+#include <vector>
 
+#include "antialias.hpp"
 #include "buffer.hpp"
+#include "colormap.hpp"
+#include "cpu_renderer.hpp"
+#include "fixed.hpp"
+#include "frame_stats.hpp"
+#include "framebuffer.hpp"
 #include "glfw_wrapper.hpp"
+#include "gpu_timer.hpp"
+#include "iteration_limit.hpp"
+#include "motion.hpp"
+#include "perturbation.hpp"
+#include "pixel_pack_ring.hpp"
 #include "program.hpp"
+#include "progressive_renderer.hpp"
+#include "resolution_scale.hpp"
+#include "shaders.hpp"
+#include "texture_array.hpp"
+#include "texture_buffer.hpp"
+#include "tile_atlas.hpp"
+#include "tile_cache.hpp"
+#include "trace.hpp"
+#include "uniform_buffer.hpp"
 #include "vao.hpp"
+#include "view.hpp"
+#include "zoom_video.hpp"
 
 using namespace std::string_view_literals;
 
@@ -30,9 +61,46 @@ namespace {
 constexpr auto g_width = 800;
 constexpr auto g_height = 600;
 
-constexpr auto g_x_offset_delta = 0.05F;
-constexpr auto g_y_offset_delta = 0.05F;
-constexpr auto g_zoom_delta = 1.025F;
+// Unit 0 holds the reference orbit, unit 1 the iterations of the progressive renderer.
+constexpr auto g_color_tables_unit = GLuint{2};
+
+// Pixel pack buffers of the video export: frames read back in flight.
+constexpr auto g_readback_depth = std::size_t{3};
+
+constexpr auto g_title = "Mandelbrot"sv;
+// Frame statistics are shown at most this often.
+constexpr auto g_stats_period = std::chrono::milliseconds{500};
+
+using Clock = std::chrono::steady_clock;
+
+auto to_ms(Clock::duration duration) -> double {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Fragment shader kernels, from the cheapest to the most precise (ViewBlock::kernel).
+enum class Kernel : GLuint {
+    FLOAT = 0,
+    DOUBLE_FLOAT = 1,
+    PERTURBATION = 2,
+};
+
+constexpr auto g_kernel_count = std::size_t{3};
+
+// Below this zoom the double-float kernel (about 48 bits) starts to glitch as well.
+constexpr auto g_double_float_zoom = 1e-11;
+
+auto select_kernel(double zoom) -> Kernel {
+    if (zoom >= deep::g_perturbation_zoom) {
+        return Kernel::FLOAT;
+    }
+    return zoom >= g_double_float_zoom ? Kernel::DOUBLE_FLOAT : Kernel::PERTURBATION;
+}
+
+// Splits a double into the hi + lo float pair of the double-float kernel.
+auto split(double value) -> std::pair<float, float> {
+    auto const hi = static_cast<float>(value);
+    return {hi, static_cast<float>(value - static_cast<double>(hi))};
+}
 
 auto draw() -> void {
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, static_cast<GLvoid *>(0));  // NOLINT
@@ -47,52 +115,15 @@ auto set_viewport(int w, int h) {
     glViewport(0, 0, w, h);
 }
 
-class OnFrameBuffferResize: public glfw::Window::OnFrameBufferResizeHandler {
-public:
-    explicit OnFrameBuffferResize(gl::Program const &prog)
-        : m_prog{prog} {
-    }
-
-    // NOLINTNEXTLINE
-    auto on_resize(int w, int h) -> void override {
-        set_viewport(w, h);
-        m_prog.get().set_uniform("view_port"sv,
-                                 std::pair{static_cast<float>(w), static_cast<float>(h)});
-    }
-
-private:
-    std::reference_wrapper<gl::Program const> m_prog;
-};
-
-}  // namespace
-
-auto App::scaling_factor() const -> float {
-    return m_zoom / s_default_zoom;
-}
-
-auto App::run(std::filesystem::path shaders_path) -> void {
-    auto const resource_cleaner = glfw::init();
-
-    auto window = glfw::Window::make(resource_cleaner, g_width, g_height, "Mandelbrot"sv);
-    window.make_context_current();
-
+auto load_gl() -> void {
     if (gladLoadGLLoader(glfw::loader_fn) == 0) {
         fmt::println(stderr, "Failed to initialize GLAD");
         std::abort();
     }
+}
 
-    set_viewport(g_width, g_height);
-
-
-    window.add_callback([](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-            w.set_should_close();
-            return true;
-        }
-        return false;
-    });
-
-
+// Full viewport quad, bound, for draw().
+auto make_quad() -> gl::Vao {
     static constexpr auto vertices = std::array{
         // clang-format off
          1.0F,  1.0F, 0.0F, // NOLINT top right
@@ -123,112 +154,634 @@ auto App::run(std::filesystem::path shaders_path) -> void {
     vao.enable(0);
     vao.bind();
 
-    // FIXME: We assume shaders are in the src directory (sibling of build)
-    // and we assume the working directory is in fact 'build'
-    auto const program = [=]() {
-        auto p = gl::Program::create_and_link(
-            {shaders_path / "shader.vert"sv, shaders_path / "shader.frag"sv});
-        if (!p.has_value()) {
-            fmt::println(stderr, "Cannot create program.");
+    return vao;
+}
+
+// FIXME: We assume shaders are in the src directory (sibling of build)
+// and we assume the working directory is in fact 'build'
+auto make_program(std::filesystem::path const &shaders_path,
+                  std::string_view fragment_shader,
+                  std::span<gl::Program::Define const> defines = {}) -> gl::Program {
+    auto p = gl::Program::create_and_link(
+        {shaders_path / "shader.vert"sv, shaders_path / fragment_shader},
+        defines,
+        gl::program_cache_dir());
+    if (!p.has_value()) {
+        fmt::println(stderr, "Cannot create program.");
+        std::abort();
+    }
+    return std::move(p).value();
+}
+
+// The iteration pass specialized for each kernel, with and without interior checks (KERNEL and
+// INTERIOR_CHECKS of shader.frag), each built on first use.
+class IterationPrograms {
+public:
+    explicit IterationPrograms(std::filesystem::path shaders_path)
+        : m_shaders_path{std::move(shaders_path)} {
+    }
+
+    [[nodiscard]] auto get(Kernel kernel, bool interior_checks) -> gl::Program const & {
+        auto &program
+            = m_programs.at((std::to_underlying(kernel) * 2U) + (interior_checks ? 1U : 0U));
+        if (!program.has_value()) {
+            auto const defines = std::array{
+                gl::Program::Define{.name = "KERNEL"sv,
+                                    .value = fmt::format("{}U", std::to_underlying(kernel))},
+                gl::Program::Define{.name = "INTERIOR_CHECKS"sv,
+                                    .value = interior_checks ? "true" : "false"},
+            };
+            program = make_program(m_shaders_path, "shader.frag"sv, defines);
+            // The other kernels have no reference orbit.
+            if (kernel == Kernel::PERTURBATION) {
+                program->set_uniform(shaders::IterationUniform{"reference_orbit"sv}, GLint{0});
+            }
+            shaders::bind_view_block(program.value());
+        }
+        return program.value();
+    }
+
+private:
+    std::filesystem::path m_shaders_path;
+    std::array<std::optional<gl::Program>, g_kernel_count * 2> m_programs;
+};
+
+// The builtin color maps, then the ones of color_map_files.
+auto load_color_tables(std::span<std::filesystem::path const> color_map_files)
+    -> std::vector<colormap::Table> {
+    auto tables = colormap::builtin_tables();
+    for (auto const &file : color_map_files) {
+        auto table = colormap::load(file);
+        if (!table.has_value()) {
             std::abort();
         }
-        return std::move(p).value();
-    }();
-    program.use();
+        tables.push_back(std::move(table).value());
+    }
+    return tables;
+}
 
-    program.set_uniform("x_offset"sv, m_x_offset);
-    program.set_uniform("y_offset"sv, m_y_offset);
-    program.set_uniform("zoom"sv, m_zoom);
-    program.set_uniform("color_map"sv, m_color_map);
+auto upload_color_tables(std::span<colormap::Table const> tables,
+                         gl::Program const &color_program) -> gl::Texture1DArray {
+    auto color_tables = gl::Texture1DArray::make();
+    color_tables.set_data(static_cast<int>(colormap::g_table_size),
+                          static_cast<int>(tables.size()),
+                          colormap::to_rgb32f(tables));
+    color_tables.bind(g_color_tables_unit);
+    color_program.set_uniform(shaders::ColorUniform{"color_tables"sv},
+                              static_cast<GLint>(g_color_tables_unit));
+    return color_tables;
+}
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_H) == GLFW_PRESS) {
-            m_x_offset -= g_x_offset_delta * scaling_factor();
-            program.set_uniform("x_offset"sv, m_x_offset);
-            return true;
+// The current view, if the float kernel draws it, and its iteration limit.
+using FloatView = std::function<std::optional<std::pair<View, std::uint32_t>>(int w, int h)>;
+
+class AtlasTiles: public gl::ProgressiveRenderer::TileSource {
+public:
+    AtlasTiles(gl::TileAtlas &atlas, FloatView view, gl::TileAtlas::DrawTile draw_tile)
+        : m_atlas{atlas}
+        , m_view{std::move(view)}
+        , m_draw_tile{std::move(draw_tile)} {
+    }
+
+    [[nodiscard]] auto coverage(int w, int h) const -> gl::TileAtlas::Coverage override {
+        auto const view = m_view(w, h);
+        if (!view.has_value()) {
+            return gl::TileAtlas::Coverage::NONE;
         }
-        return false;
-    });
+        return m_atlas.get().coverage(view->first, view->second);
+    }
+
+    auto compose(gl::Framebuffer &target, int w, int h) -> void override {
+        auto const view = m_view(w, h).value();
+        m_atlas.get().compose(target, view.first, view.second, m_draw_tile);
+    }
+
+private:
+    std::reference_wrapper<gl::TileAtlas> m_atlas;
+    FloatView m_view;
+    gl::TileAtlas::DrawTile m_draw_tile;
+};
+
+class HybridRows: public gl::ProgressiveRenderer::CpuRows {
+public:
+    // interior_checks is the setting of the GPU program, which the CPU kernels follow.
+    HybridRows(unsigned threads, FloatView view, bool const &interior_checks)
+        : m_renderer{cpu::Renderer::Options{.threads = threads}}
+        , m_view{std::move(view)}
+        , m_interior_checks{interior_checks} {
+    }
+
+    // The CPU kernels mirror the float kernel only.
+    [[nodiscard]] auto available(int w, int h) const -> bool override {
+        return m_view(w, h).has_value();
+    }
+
+    auto render(int w, int h, int first) -> std::span<float const> override {
+        auto const [view, max_iters] = m_view(w, h).value();
+        auto const area = cpu::Tile{.x = 0, .y = first, .width = w, .height = h - first};
+        m_counts.resize(static_cast<std::size_t>(area.width)
+                        * static_cast<std::size_t>(area.height));
+        m_renderer.set_interior_checks(m_interior_checks.get());
+        m_renderer.render_area(view, area, max_iters, m_counts);
+        m_texels.assign(m_counts.begin(), m_counts.end());
+        return m_texels;
+    }
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_L) == GLFW_PRESS) {
-            m_x_offset += g_x_offset_delta * scaling_factor();
-            program.set_uniform("x_offset"sv, m_x_offset);
-            return true;
+private:
+    cpu::Renderer m_renderer;
+    FloatView m_view;
+    std::reference_wrapper<bool const> m_interior_checks;
+    std::vector<std::uint32_t> m_counts;
+    std::vector<float> m_texels;
+};
+
+class OnFrameBuffferResize: public glfw::Window::OnFrameBufferResizeHandler {
+public:
+    explicit OnFrameBuffferResize(gl::ProgressiveRenderer &renderer)
+        : m_renderer{renderer} {
+    }
+
+    // NOLINTNEXTLINE
+    auto on_resize(int w, int h) -> void override {
+        set_viewport(w, h);
+        m_renderer.get().resize(w, h);
+    }
+
+private:
+    std::reference_wrapper<gl::ProgressiveRenderer> m_renderer;
+};
+
+}  // namespace
+
+auto App::scaling_factor() const -> double {
+    return m_zoom / s_default_zoom;
+}
+
+auto App::zoom_changed() -> void {
+    m_refine_iters = m_auto_iters;
+}
+
+auto App::view_block(std::pair<int, int> size, gl::TextureBuffer const &orbit_buffer) const
+    -> shaders::ViewBlock {
+    auto const kernel = select_kernel(m_zoom);
+    auto block = shaders::ViewBlock{
+        .kernel = static_cast<GLuint>(kernel),
+        .max_iters = m_max_iters,
+        .interior_checks = m_interior_checks ? 1U : 0U,
+    };
+    if (kernel != Kernel::PERTURBATION) {
+        std::tie(block.x_offset, block.x_offset_lo) = split(m_x_offset.to_double());
+        std::tie(block.y_offset, block.y_offset_lo) = split(m_y_offset.to_double());
+        std::tie(block.zoom, block.zoom_lo) = split(m_zoom);
+        return block;
+    }
+    auto const [w, h] = size;
+    auto const camera = deep::Camera{
+        .x_offset = m_x_offset,
+        .y_offset = m_y_offset,
+        .zoom = m_zoom,
+        .width = w,
+        .height = h,
+    };
+    auto const orbit = deep::ReferenceOrbit::compute(camera, m_max_iters);
+    auto const data = orbit.to_rg32f();
+    orbit_buffer.set_data(std::span{data});
+    auto exponent = 0;
+    block.zoom_mantissa = static_cast<float>(std::frexp(m_zoom, &exponent));
+    block.zoom_exponent = exponent;
+    block.orbit_length = static_cast<GLint>(orbit.points().size());
+    return block;
+}
+
+auto App::run(std::filesystem::path shaders_path,
+              std::span<std::filesystem::path const> color_map_files,
+              std::optional<std::filesystem::path> const &stats_csv,
+              std::size_t tile_cache_bytes,
+              int max_samples,
+              double frame_budget_ms,
+              unsigned cpu_threads) -> void {
+    auto const resource_cleaner = glfw::init();
+
+    auto window = glfw::Window::make(resource_cleaner, g_width, g_height, g_title);
+    window.make_context_current();
+
+    load_gl();
+
+    set_viewport(g_width, g_height);
+
+    window.on_press(GLFW_KEY_ESCAPE, [&] { window.set_should_close(); });
+
+    auto const vao = make_quad();
+
+    // Iteration pass, then color pass.
+    auto iteration_programs = IterationPrograms{shaders_path};
+    auto const color_program = make_program(shaders_path, "color.frag"sv);
+
+    auto const orbit_buffer = gl::TextureBuffer::make(GL_RG32F);
+    orbit_buffer.bind(0);
+
+    // Changes of the view only set view_changed: the block is uploaded, and the program of its
+    // kernel selected, once per frame.
+    auto const view_uniforms = gl::UniformBuffer<shaders::ViewBlock>::make();
+    view_uniforms.bind(shaders::ViewBlock::s_binding);
+    shaders::bind_view_block(color_program);
+    auto view_changed = true;
+
+    auto const tables = load_color_tables(color_map_files);
+    m_color_map_count = static_cast<GLuint>(tables.size());
+    auto const color_tables = upload_color_tables(tables, color_program);
+    color_program.set_uniform(shaders::ColorUniform{"color_map"sv}, m_color_map);
+
+    // Tiles are iterated into the atlas with their own view block, the one of the view staying
+    // in view_uniforms.
+    auto atlas = std::optional<gl::TileAtlas>{};
+    auto const tile_uniforms = gl::UniformBuffer<shaders::ViewBlock>::make();
+    auto const draw_tile = [&](View const &tile) {
+        auto const &program = iteration_programs.get(Kernel::FLOAT, m_interior_checks);
+        program.set_uniform(
+            shaders::IterationUniform{"view_port"sv},
+            std::pair{static_cast<float>(tile.width), static_cast<float>(tile.height)});
+        tile_uniforms.set(shaders::ViewBlock{
+            .x_offset = tile.x_offset,
+            .y_offset = tile.y_offset,
+            .zoom = tile.zoom,
+            .kernel = static_cast<GLuint>(Kernel::FLOAT),
+            .max_iters = m_max_iters,
+            .interior_checks = m_interior_checks ? 1U : 0U,
+        });
+        tile_uniforms.bind(shaders::ViewBlock::s_binding);
+        draw();
+        view_uniforms.bind(shaders::ViewBlock::s_binding);
+    };
+    auto const float_view = [&](int w, int h) -> std::optional<std::pair<View, std::uint32_t>> {
+        if (select_kernel(m_zoom) != Kernel::FLOAT) {
+            return std::nullopt;
         }
-        return false;
-    });
+        auto const view = View{
+            .x_offset = static_cast<float>(m_x_offset.to_double()),
+            .y_offset = static_cast<float>(m_y_offset.to_double()),
+            .zoom = static_cast<float>(m_zoom),
+            .width = w,
+            .height = h,
+        };
+        return std::pair{view, m_max_iters};
+    };
+    if (tile_cache_bytes > 0) {
+        auto const defines = std::array{
+            gl::Program::Define{.name = "TILE_SIZE"sv, .value = fmt::format("{}", tiles::g_size)},
+        };
+        atlas.emplace(make_program(shaders_path, "tiles.frag"sv, defines), draw, tile_cache_bytes);
+    }
+
+    auto const [fb_width, fb_height] = window.frame_buffer_size();
+    auto renderer
+        = gl::ProgressiveRenderer{iteration_programs.get(select_kernel(m_zoom), m_interior_checks),
+                                  color_program,
+                                  draw,
+                                  fb_width,
+                                  fb_height,
+                                  max_samples};
+    if (atlas.has_value()) {
+        renderer.set_tile_source(
+            std::make_unique<AtlasTiles>(atlas.value(), float_view, draw_tile));
+    }
+    if (cpu_threads > 0) {
+        renderer.set_cpu_rows(
+            std::make_unique<HybridRows>(cpu_threads, float_view, m_interior_checks));
+    }
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_J) == GLFW_PRESS) {
-            m_y_offset -= g_y_offset_delta * scaling_factor();
-            program.set_uniform("y_offset"sv, m_y_offset);
-            return true;
+    // Moves the view by whole pixels, so that the renderer can reuse the old image. The
+    // fractions of a pixel are kept for the next move.
+    auto pan_remainder = std::pair{0.0, 0.0};
+    auto const move = [&](motion::Delta const &delta) {
+        auto const [width, height] = window.frame_buffer_size();
+        pan_remainder.first += delta.x * width;
+        pan_remainder.second += delta.y * height;
+        auto const dx = static_cast<int>(std::trunc(pan_remainder.first));
+        auto const dy = static_cast<int>(std::trunc(pan_remainder.second));
+        pan_remainder.first -= dx;
+        pan_remainder.second -= dy;
+        if (dx != 0 || dy != 0) {
+            m_x_offset += mp::Fixed::from_double(dx * scaling_factor() / width);
+            m_y_offset += mp::Fixed::from_double(dy * scaling_factor() / height);
+            view_changed = true;
+            renderer.pan(-dx, -dy);
+        }
+        if (delta.zoom != 0.0) {
+            m_zoom = std::max(m_zoom * std::exp(-delta.zoom), s_min_zoom);
+            zoom_changed();
+            view_changed = true;
+            renderer.invalidate();
         }
-        return false;
+    };
+
+    // The reference orbit is as long as the limit: it is computed again with the block.
+    auto const set_max_iters = [&](std::uint32_t max_iters) {
+        m_max_iters = max_iters;
+        view_changed = true;
+        renderer.invalidate();
+    };
+
+    window.on_press(GLFW_KEY_SPACE, [&] {
+        m_color_map = (m_color_map + 1U) % m_color_map_count;
+        color_program.set_uniform(shaders::ColorUniform{"color_map"sv}, m_color_map);
+        renderer.recolor();
     });
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_K) == GLFW_PRESS) {
-            m_y_offset += g_y_offset_delta * scaling_factor();
-            program.set_uniform("y_offset"sv, m_y_offset);
-            return true;
-        }
-        return false;
+    window.on_press(GLFW_KEY_I, [&] {
+        m_interior_checks = !m_interior_checks;
+        fmt::println("Interior checks {}", m_interior_checks ? "on" : "off");
+        view_changed = true;
+        renderer.invalidate();
     });
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_M) == GLFW_PRESS) {
-            m_zoom /= g_zoom_delta;
-            program.set_uniform("zoom"sv, m_zoom);
-            return true;
+    window.on_press(GLFW_KEY_P, [&] {
+        m_show_stats = !m_show_stats;
+        fmt::println("Frame stats {}", m_show_stats ? "on" : "off");
+        if (!m_show_stats) {
+            window.set_title(std::string{g_title});
         }
-        return false;
     });
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_N) == GLFW_PRESS) {
-            m_zoom *= g_zoom_delta;
-            program.set_uniform("zoom"sv, m_zoom);
-            return true;
+    window.on_press(GLFW_KEY_A, [&] {
+        m_auto_iters = !m_auto_iters;
+        fmt::println("Automatic iteration limit {}", m_auto_iters ? "on" : "off");
+        if (m_auto_iters) {
+            m_refine_iters = true;
+            set_max_iters(iters::for_zoom(m_zoom));
         }
-        return false;
     });
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_SPACE) == GLFW_PRESS && !m_space_key_is_pressed) {
-            m_space_key_is_pressed = true;
-            return true;
-        }
-        if (w.get_key(GLFW_KEY_SPACE) == GLFW_RELEASE && m_space_key_is_pressed) {
-            m_space_key_is_pressed = false;
-            m_color_map = (m_color_map + 1U) % 3U;
-            program.set_uniform("color_map"sv, m_color_map);
-            return true;
-        }
-        return false;
+    // Manual limit: halve or double it.
+    window.on_press(GLFW_KEY_LEFT_BRACKET, [&] {
+        m_auto_iters = false;
+        set_max_iters(std::max(m_max_iters / 2U, iters::g_min));
+        fmt::println("Iteration limit {}", m_max_iters);
     });
 
-    window.add_callback([&](glfw::Window &w) {
-        if (w.get_key(GLFW_KEY_C) == GLFW_PRESS) {
-            m_x_offset = s_default_x_offset;
-            m_y_offset = s_default_y_offset;
-            m_zoom = s_default_zoom;
-            program.set_uniform("x_offset"sv, m_x_offset);
-            program.set_uniform("y_offset"sv, m_y_offset);
-            program.set_uniform("zoom"sv, m_zoom);
-            return true;
-        }
-        return false;
+    window.on_press(GLFW_KEY_RIGHT_BRACKET, [&] {
+        m_auto_iters = false;
+        set_max_iters(std::min(m_max_iters * 2U, iters::g_max));
+        fmt::println("Iteration limit {}", m_max_iters);
     });
 
-    window.set_on_frame_buffer_resize_handler(std::make_unique<OnFrameBuffferResize>(program));
+    window.on_press(GLFW_KEY_C, [&] {
+        m_x_offset = mp::Fixed::from_double(s_default_x_offset);
+        m_y_offset = mp::Fixed::from_double(s_default_y_offset);
+        m_zoom = s_default_zoom;
+        zoom_changed();
+        view_changed = true;
+        renderer.invalidate();
+    });
+
+    window.set_on_frame_buffer_resize_handler(std::make_unique<OnFrameBuffferResize>(renderer));
+
+    // The previews of the first moves are as coarse as the ones of a still camera.
+    auto scaler = resolution::Controller{
+        frame_budget_ms, 1.0 / gl::ProgressiveRenderer::s_coarse_divisor};
+    // Frames that rendered a preview while moving, until their GPU time comes.
+    auto scaled_frames = std::deque<std::uint64_t>{};
+
+    auto gpu_timer = gl::GpuTimer::make();
+    auto frame_stats = stats::FrameStats{};
+    if (stats_csv.has_value() && !frame_stats.open_csv(stats_csv.value())) {
+        std::abort();
+    }
+    auto const collect_gpu_times = [&] {
+        while (auto const sample = gpu_timer.poll()) {
+            frame_stats.add_gpu(sample->frame, sample->ms);
+            // Older frames lost their GPU time.
+            while (!scaled_frames.empty() && scaled_frames.front() < sample->frame) {
+                scaled_frames.pop_front();
+            }
+            if (!scaled_frames.empty() && scaled_frames.front() == sample->frame) {
+                scaler.add_frame(sample->ms);
+                scaled_frames.pop_front();
+            }
+        }
+        while (auto const preview = renderer.poll_preview_time()) {
+            scaler.add_preview(preview->ms, preview->scale);
+        }
+    };
+    auto frame = std::uint64_t{0};
+    auto last_report = Clock::now();
+
+    // Held keys: H/L pan along x, J/K along y, M/N zoom in and out.
+    auto integrator = motion::Integrator{};
+    auto const held = [&] {
+        auto const axis = [&](int negative, int positive) {
+            return (window.is_down(positive) ? 1 : 0) - (window.is_down(negative) ? 1 : 0);
+        };
+        return motion::Input{
+            .x = axis(GLFW_KEY_H, GLFW_KEY_L),
+            .y = axis(GLFW_KEY_J, GLFW_KEY_K),
+            .zoom = axis(GLFW_KEY_N, GLFW_KEY_M),
+        };
+    };
+    auto last_step = Clock::now();
 
     fill_bg();
     while (!window.should_close()) {
-        window.handle_input();
+        auto const frame_zone = trace::Zone{"frame"};
+        auto const frame_start = Clock::now();
+        {
+            // Key actions run from here, then held keys move the camera for the time elapsed.
+            auto const zone = trace::Zone{"input"};
+            glfw::poll_events();
+            move(integrator.advance(frame_start - last_step, held()));
+        }
+        last_step = frame_start;
+        if (m_refine_iters && integrator.at_rest() && renderer.preview_current()) {
+            // The camera stopped on a view whose preview was rendered: rerun it if it needs
+            // another limit. Reading the preview back stalls, so not while the camera moves. A
+            // view whose tiles were all cached has no preview and keeps its limit.
+            auto const zone = trace::Zone{"refine iterations"};
+            m_refine_iters = false;
+            auto const max_iters
+                = iters::refine(renderer.preview_counts(), m_max_iters, m_zoom);
+            if (max_iters != m_max_iters) {
+                set_max_iters(max_iters);
+            }
+        }
+        if (std::exchange(view_changed, false)) {
+            auto const zone = trace::Zone{"view block"};
+            view_uniforms.set(view_block(window.frame_buffer_size(), orbit_buffer));
+            renderer.set_iterations(
+                iteration_programs.get(select_kernel(m_zoom), m_interior_checks));
+        }
+        auto const input_end = Clock::now();
+        auto const moving = frame_budget_ms > 0.0 && !integrator.at_rest();
+        renderer.set_motion(moving ? std::optional{scaler.scale()} : std::nullopt);
+        if (renderer.done() && integrator.at_rest()) {
+            collect_gpu_times();
+            auto const zone = trace::Zone{"wait events"};
+            glfw::wait_events();
+            // Waiting is not motion time.
+            last_step = Clock::now();
+            continue;
+        }
+        if (moving && renderer.stage() == gl::ProgressiveRenderer::Stage::COARSE) {
+            scaled_frames.push_back(frame);
+        }
+        {
+            auto const zone = trace::Zone{"render"};
+            gpu_timer.begin(frame);
+            renderer.render_next();
+            gpu_timer.end();
+        }
+        auto const swap_start = Clock::now();
+        {
+            auto const zone = trace::Zone{"swap"};
+            window.swap_buffers();
+        }
+        auto const swap_end = Clock::now();
+        frame_stats.add_cpu(frame,
+                            stats::CpuTimes{
+                                .frame = to_ms(swap_start - frame_start),
+                                .input = to_ms(input_end - frame_start),
+                                .swap = to_ms(swap_end - swap_start),
+                            });
+        collect_gpu_times();
+        ++frame;
+        if (m_show_stats && swap_end - last_report >= g_stats_period) {
+            last_report = swap_end;
+            auto line = frame_stats.format();
+            if (auto const frame_ms = scaler.frame_ms(); frame_ms.has_value()) {
+                line += fmt::format("  scale {:.2f} at {:.1f} ms for {:.1f} ms",
+                                    scaler.scale(),
+                                    frame_ms.value(),
+                                    scaler.budget_ms());
+            }
+            if (auto const cpu_rate = renderer.split().cpu_rate(); cpu_rate.has_value()) {
+                line += fmt::format("  cpu rows {:.0f}% at {:.1f} Mpx/s, gpu {:.1f} Mpx/s",
+                                    renderer.split().cpu_share() * 100.0,  // NOLINT
+                                    cpu_rate.value(),
+                                    renderer.split().gpu_rate().value_or(0.0));
+            }
+            if (atlas.has_value()) {
+                auto const tile_stats = atlas->stats();
+                line += fmt::format("  tiles {} hits, {} misses, {} evictions",
+                                    tile_stats.hits,
+                                    tile_stats.misses,
+                                    tile_stats.evictions);
+            }
+            fmt::println("{}", line);
+            window.set_title(fmt::format("{} - {}", g_title, line));
+        }
+    }
+}
+
+auto App::export_video(std::filesystem::path shaders_path,
+                       std::span<std::filesystem::path const> color_map_files,
+                       video::Options const &options) -> void {
+    auto const resource_cleaner = glfw::init();
+    auto window = glfw::Window::make_hidden(resource_cleaner);
+    window.make_context_current();
+    load_gl();
+
+    auto const vao = make_quad();
+    auto iteration_programs = IterationPrograms{shaders_path};
+    auto const color_program = make_program(shaders_path, "color.frag"sv);
+
+    auto const orbit_buffer = gl::TextureBuffer::make(GL_RG32F);
+    orbit_buffer.bind(0);
+
+    auto const view_uniforms = gl::UniformBuffer<shaders::ViewBlock>::make();
+    view_uniforms.bind(shaders::ViewBlock::s_binding);
+    shaders::bind_view_block(color_program);
+
+    auto tables = load_color_tables(color_map_files);
+    auto const color_map = colormap::resolve(tables, options.color_map);
+    if (!color_map.has_value()) {
+        std::abort();
+    }
+    auto const color_tables = upload_color_tables(tables, color_program);
+    color_program.set_uniform(shaders::ColorUniform{"color_map"sv},
+                              static_cast<GLuint>(color_map.value()));
+
+    // Same quality as the last pass of the viewer: counts at full resolution, then supersampled
+    // where they have edges, averaged by the colors.
+    auto max_size = GLint{};
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    auto const side = aa::grid_side(options.max_samples);
+    auto const samples = std::max(options.width, options.height) * side <= max_size ? side : 1;
+    auto const size = std::pair{options.width, options.height};
+    auto full = gl::Framebuffer::make(GL_RG32F, GL_RG, GL_FLOAT);
+    full.resize(size.first, size.second);
+    auto iterations = gl::Framebuffer::make(GL_RG32F, GL_RG, GL_FLOAT);
+    iterations.resize(size.first * samples, size.second * samples);
+    auto colors = gl::Framebuffer::make(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    colors.resize(options.width, options.height);
+    full.bind_texture(gl::ProgressiveRenderer::s_full_iterations_unit);
+    iterations.bind_texture(gl::ProgressiveRenderer::s_iterations_unit);
+    color_program.set_uniform(shaders::ColorUniform{"iterations"sv},
+                              static_cast<GLint>(gl::ProgressiveRenderer::s_iterations_unit));
+    color_program.set_uniform(shaders::ColorUniform{"texel_scale"sv},
+                              std::pair{static_cast<float>(samples), static_cast<float>(samples)});
+    color_program.set_uniform(shaders::ColorUniform{"samples"sv}, static_cast<GLint>(samples));
+
+    // Frame n is drawn while frame n - g_readback_depth is read back and older ones are being
+    // written by the encoder.
+    auto readback = gl::PixelPackRing::make(g_readback_depth);
+    auto encoder = video::Encoder{options.width, options.height, options.output};
+    auto written = 0;
+    auto const pass_to_encoder = [&] {
+        auto const zone = trace::Zone{"readback"};
+        auto frame = encoder.acquire();
+        readback.finish(frame.rgba);
+        frame.index = written++;
+        encoder.submit(std::move(frame));
+    };
+
+    auto const start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < options.frames; ++i) {
+        auto const zone = trace::Zone{"frame"};
+        auto const camera = video::keyframe_at(options.from, options.to, i, options.frames);
+        m_x_offset = camera.x_offset;
+        m_y_offset = camera.y_offset;
+        m_zoom = camera.zoom;
+        m_max_iters = options.max_iters.value_or(iters::for_zoom(m_zoom));
+        view_uniforms.set(view_block(size, orbit_buffer));
+
+        auto const &program = iteration_programs.get(select_kernel(m_zoom), m_interior_checks);
+        auto const pass = [&](gl::Framebuffer const &target, int sample_side) {
+            program.set_uniform(shaders::IterationUniform{"view_port"sv},
+                                std::pair{static_cast<float>(size.first * sample_side),
+                                          static_cast<float>(size.second * sample_side)});
+            program.set_uniform(shaders::IterationUniform{"sample_side"sv}, sample_side);
+            target.bind();
+            draw();
+        };
+        if (samples > 1) {
+            constexpr auto full_unit = gl::ProgressiveRenderer::s_full_iterations_unit;
+            program.set_uniform(shaders::IterationUniform{"full_iterations"sv},
+                                static_cast<GLint>(full_unit));
+            program.set_uniform(shaders::IterationUniform{"edge_threshold"sv},
+                                aa::g_edge_threshold);
+            pass(full, 1);
+        }
+        pass(iterations, samples);
+        color_program.use();
+        colors.bind();
         draw();
-        glfwPollEvents();
-        window.swap_buffers();
+        if (readback.full()) {
+            pass_to_encoder();
+        }
+        readback.start(colors);
+    }
+    while (readback.pending() > 0) {
+        pass_to_encoder();
+    }
+    encoder.finish();
+
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    fmt::println(stderr,
+                 "{} frames in {:.2f} s, {:.1f} frames/s",
+                 options.frames,
+                 seconds.count(),
+                 options.frames / seconds.count());
+    if (encoder.failures() > 0) {
+        fmt::println(stderr, "{} frames could not be written.", encoder.failures());
+        std::abort();
     }
 }
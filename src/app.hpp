@@ -3,25 +3,72 @@
 
 #include "glad/glad.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "fixed.hpp"
+#include "glfw_wrapper.hpp"
+#include "iteration_limit.hpp"
+#include "shaders.hpp"
+#include "texture_buffer.hpp"
+#include "zoom_video.hpp"
 
 class App {
 public:
-    auto run(std::filesystem::path shaders_path) -> void;
+    // The color maps loaded from color_map_files follow the builtin ones. With stats_csv, the
+    // times of every frame are written there. Up to tile_cache_bytes of tiles are kept on the
+    // GPU for the views seen again, 0 disables them. The last pass takes up to max_samples
+    // samples in the pixels on edges. While the camera moves, the resolution of the previews
+    // follows the GPU time of the frames to keep it near frame_budget_ms; 0 keeps it fixed.
+    // With cpu_threads, a CPU thread pool iterates a share of the rows of the passes.
+    auto run(std::filesystem::path shaders_path,
+             std::span<std::filesystem::path const> color_map_files,
+             std::optional<std::filesystem::path> const &stats_csv,
+             std::size_t tile_cache_bytes,
+             int max_samples,
+             double frame_budget_ms,
+             unsigned cpu_threads) -> void;
+    // Renders a zoom video offscreen instead of opening the viewer.
+    auto export_video(std::filesystem::path shaders_path,
+                      std::span<std::filesystem::path const> color_map_files,
+                      video::Options const &options) -> void;
 
 private:
-    inline static constexpr auto s_default_x_offset = 0.0F;
-    inline static constexpr auto s_default_y_offset = 0.0F;
-    inline static constexpr auto s_default_zoom = 1.0F;
+    inline static constexpr auto s_default_x_offset = 0.0;
+    inline static constexpr auto s_default_y_offset = 0.0;
+    inline static constexpr auto s_default_zoom = 1.0;
+    // Limit of the fixed-point precision of the offsets.
+    inline static constexpr auto s_min_zoom = 1e-280;
 
-    float m_x_offset{s_default_x_offset};
-    float m_y_offset{s_default_y_offset};
-    float m_zoom{s_default_zoom};
+    mp::Fixed m_x_offset{mp::Fixed::from_double(s_default_x_offset)};
+    mp::Fixed m_y_offset{mp::Fixed::from_double(s_default_y_offset)};
+    double m_zoom{s_default_zoom};
     GLuint m_color_map{};
+    GLuint m_color_map_count{};
+
+    // Bulb test and cycle check of shader.frag, toggled to compare frame times.
+    bool m_interior_checks{true};
+    // Frame time statistics in the title and on the terminal.
+    bool m_show_stats{false};
+
+    std::uint32_t m_max_iters{iters::for_zoom(s_default_zoom)};
+    // Automatic mode: every zoom refines the limit from the preview of the new view.
+    bool m_auto_iters{true};
+    bool m_refine_iters{true};
 
-    bool m_space_key_is_pressed{false};
+    [[nodiscard]] auto scaling_factor() const -> double;
+    auto zoom_changed() -> void;
 
-    [[nodiscard]] auto scaling_factor() const -> float;
+    // The camera for the cheapest kernel that resolves the zoom: float, double-float (hi/lo
+    // values) or perturbation (reference orbit, uploaded here), for a framebuffer of the given
+    // size, and the iteration settings.
+    [[nodiscard]] auto view_block(std::pair<int, int> size,
+                                  gl::TextureBuffer const &orbit_buffer) const
+        -> shaders::ViewBlock;
 };
 
 #endif
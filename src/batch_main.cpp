@@ -0,0 +1,742 @@
+#include "antialias.hpp"
+#include "colormap.hpp"
+#include "cpu_kernel.hpp"
+#include "cpu_renderer.hpp"
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include "fixed.hpp"
+#include "image.hpp"
+#include "iteration_file.hpp"
+#include "perturbation.hpp"
+#include "render_server.hpp"
+#include "socket.hpp"
+#include "tile_cache.hpp"
+#include "tile_scheduler.hpp"
+#include "trace.hpp"
+#include "view.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr auto g_default_width = 800;
+constexpr auto g_default_height = 600;
+
+// Largest distance from a whole pixel at which a pan still reuses the previous image.
+constexpr auto g_pan_tolerance = 1e-6;
+
+constexpr auto g_usage = R"(Usage: mandelbrot_batch [options]
+
+Renders Mandelbrot images on the CPU, without a window, and writes them as binary PPM.
+
+View (single image):
+  --x <decimal>         x_offset, as in the viewer, at any precision (default 0)
+  --y <decimal>         y_offset (default 0)
+  --zoom <float>        zoom (default 1), perturbation is used below 1e-5
+  --width <int>         image width (default 800)
+  --height <int>        image height (default 600)
+  --iters <int>         iteration limit (default 1000)
+  --colormap <name>     rainbow, inferno, viridis or the path of a color map file
+                        (default rainbow)
+  --output <path>       output file (default mandelbrot.ppm)
+
+Batch:
+  --jobs <path>         job file, one image per line:
+                        x y zoom width height iters colormap output
+                        empty lines and lines starting with '#' are skipped
+
+Engine:
+  --threads <int>       worker threads, 0 for all hardware threads (default 0)
+  --tile <int>          tile size in pixels (default 64)
+  --isa <name>          scalar, avx2 or avx512 (default: best supported)
+  --no-interior-checks  iterate interior points up to the limit instead of detecting the
+                        main cardioid, the period-2 bulb and cycles (for comparisons)
+  --subdivide           iterate only the borders of rectangles and fill those with a
+                        uniform border (Mariani-Silver); features thinner than a pixel
+                        may be lost
+  --tile-cache <MiB>    keep the counts of the float range views in tiles of fixed
+                        levels, reused by later views over the same region; images are
+                        sampled from the tiles of the nearest level (default 0, off)
+  --aa <int>             adaptive anti-aliasing: pixels whose count differs strongly from a
+                        neighbor get up to this many samples, the others one (default 1,
+                        off; not with --servers)
+  --aa-threshold <float>
+                        count difference with a neighbor, relative to the iteration limit,
+                        that gets a pixel more samples (default 1/64)
+  --stats               print per-image scheduler and tile cache statistics
+  --trace <path>        write the zones of every thread while rendering the images as
+                        Chrome trace JSON, for chrome://tracing or ui.perfetto.dev (not
+                        with --serve)
+
+Large images:
+  --iterations <path>   render the view into a tiled iteration file instead of an image;
+                        only one tile is in memory at a time, whatever the image size
+  --convert <path>      write the image of an iteration file to --output with
+                        --colormap, a band of rows at a time, without rendering
+
+Distributed rendering (addresses are unix:<path> or <host>:<port>):
+  --serve <address>     render areas for clients on this address until killed, with the
+                        engine options; no image is written
+  --servers <list>      comma separated render servers: every image is split into bands
+                        rendered by them instead of locally
+)";
+
+struct Job {
+    deep::Camera camera{
+        .x_offset = mp::Fixed::from_double(0.0),
+        .y_offset = mp::Fixed::from_double(0.0),
+        .zoom = 1.0,
+        .width = g_default_width,
+        .height = g_default_height,
+    };
+    std::uint32_t max_iters{View::s_max_iters};
+    // Index into Options::color_maps.
+    std::size_t color_map{0};
+    std::filesystem::path output{"mandelbrot.ppm"};
+};
+
+struct Options {
+    cpu::Renderer::Options engine;
+    std::size_t tile_cache_mib{0};
+    int aa_samples{1};
+    float aa_threshold{aa::g_edge_threshold};
+    bool stats{false};
+    std::optional<std::filesystem::path> trace;
+    std::optional<std::filesystem::path> iterations;
+    std::optional<std::filesystem::path> convert;
+    std::optional<net::Address> serve;
+    std::vector<net::Address> servers;
+    std::vector<colormap::Table> color_maps{colormap::builtin_tables()};
+    std::vector<Job> jobs;
+};
+
+[[noreturn]] auto usage_error(std::string_view msg) -> void {
+    fmt::println(stderr, "{}\n\n{}", msg, g_usage);
+    std::abort();
+}
+
+template <typename T>
+[[nodiscard]] auto parse_number(std::string_view str) -> std::optional<T> {
+    auto value = T{};
+    auto const [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || end != str.data() + str.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+template <typename T>
+auto parse_into(std::string_view option, std::string_view str, T &value) -> void {
+    auto const parsed = parse_number<T>(str);
+    if (!parsed.has_value()) {
+        usage_error(fmt::format("Invalid value '{}' for {}.", str, option));
+    }
+    value = parsed.value();
+}
+
+auto parse_fixed(std::string_view option, std::string_view str) -> mp::Fixed {
+    auto const parsed = mp::Fixed::parse(str);
+    if (!parsed.has_value()) {
+        usage_error(fmt::format("Invalid value '{}' for {}.", str, option));
+    }
+    return parsed.value();
+}
+
+// A color map file, loaded into color_maps on first use, or a builtin name.
+auto parse_color_map(std::string_view str, std::vector<colormap::Table> &color_maps)
+    -> std::size_t {
+    auto const index = colormap::resolve(color_maps, str);
+    if (!index.has_value()) {
+        std::abort();
+    }
+    return index.value();
+}
+
+auto parse_isa(std::string_view str) -> cpu::Isa {
+    for (auto const isa : {cpu::Isa::SCALAR, cpu::Isa::AVX2, cpu::Isa::AVX512}) {
+        if (cpu::isa_name(isa) == str) {
+            if (!cpu::is_supported(isa)) {
+                usage_error(fmt::format("{} is not supported by this CPU.", str));
+            }
+            return isa;
+        }
+    }
+    usage_error(fmt::format("Unknown instruction set '{}'.", str));
+}
+
+auto parse_address(std::string_view option, std::string_view str) -> net::Address {
+    auto const parsed = net::Address::parse(str);
+    if (!parsed.has_value()) {
+        usage_error(fmt::format("Invalid address '{}' for {}.", str, option));
+    }
+    return parsed.value();
+}
+
+auto parse_addresses(std::string_view option, std::string_view str) -> std::vector<net::Address> {
+    auto addresses = std::vector<net::Address>{};
+    while (true) {
+        auto const comma = str.find(',');
+        addresses.push_back(parse_address(option, str.substr(0, comma)));
+        if (comma == std::string_view::npos) {
+            return addresses;
+        }
+        str.remove_prefix(comma + 1);
+    }
+}
+
+auto validate(Job const &job) -> bool {
+    return job.camera.width > 0 && job.camera.height > 0 && job.camera.zoom > 0.0
+           && job.max_iters > 0;
+}
+
+using Pan = std::pair<int, int>;
+
+// Moving an offset by d moves the content by -d * size / zoom pixels. Only whole pixel moves
+// smaller than the frame are worth reusing.
+[[nodiscard]] auto pan_pixels(mp::Fixed const &from, mp::Fixed const &to, int size, double zoom)
+    -> std::optional<int> {
+    auto const shift = (from - to).to_double() * size / zoom;
+    auto const rounded = std::round(shift);
+    if (std::abs(shift - rounded) > g_pan_tolerance || std::abs(rounded) >= size) {
+        return std::nullopt;
+    }
+    return static_cast<int>(rounded);
+}
+
+// The pan from the image of prev to the one of job, if the two views differ only by that.
+[[nodiscard]] auto pan_between(Job const &prev, Job const &job) -> std::optional<Pan> {
+    auto const &a = prev.camera;
+    auto const &b = job.camera;
+    if (a.width != b.width || a.height != b.height || a.zoom != b.zoom
+        || a.needs_perturbation() != b.needs_perturbation() || prev.max_iters != job.max_iters) {
+        return std::nullopt;
+    }
+    auto const dx = pan_pixels(a.x_offset, b.x_offset, b.width, b.zoom);
+    auto const dy = pan_pixels(a.y_offset, b.y_offset, b.height, b.zoom);
+    if (!dx.has_value() || !dy.has_value()) {
+        return std::nullopt;
+    }
+    return Pan{dx.value(), dy.value()};
+}
+
+// With a pan, out must hold the previous image. Views the tile cache can serve go through it.
+// With samples.side above 1, the edges of the image then get their extra samples.
+auto render(cpu::Renderer &renderer,
+            std::optional<tiles::Cache> &cache,
+            Job const &job,
+            std::optional<Pan> const &pan,
+            float aa_threshold,
+            std::span<std::uint32_t> out,
+            aa::Samples &samples) -> cpu::SchedulerStats {
+    auto const find_edges = [&] {
+        samples.pixels = aa::find_edges(
+            out, job.camera.width, job.camera.height, job.max_iters, aa_threshold);
+    };
+    auto const add_samples = [](cpu::SchedulerStats stats, cpu::SchedulerStats const &extra) {
+        stats.wall += extra.wall;
+        return stats;
+    };
+    if (!job.camera.needs_perturbation()) {
+        auto const view = job.camera.to_view();
+        auto const stats = [&] {
+            if (cache.has_value()) {
+                auto const start = std::chrono::steady_clock::now();
+                auto const compute = [&](View const &tile, std::span<std::uint32_t> counts) {
+                    renderer.render(tile, job.max_iters, counts);
+                };
+                if (cache->render(view, job.max_iters, compute, out)) {
+                    auto cached = cpu::SchedulerStats{};
+                    cached.wall = std::chrono::steady_clock::now() - start;
+                    return cached;
+                }
+            }
+            if (pan.has_value()) {
+                return renderer.render_panned(view, pan->first, pan->second, job.max_iters, out);
+            }
+            return renderer.render(view, job.max_iters, out);
+        }();
+        if (samples.side == 1) {
+            return stats;
+        }
+        find_edges();
+        return add_samples(stats,
+                           renderer.render_samples(view, job.max_iters, samples, aa_threshold));
+    }
+    auto const orbit = deep::ReferenceOrbit::compute(job.camera, job.max_iters);
+    auto const stats = pan.has_value() ? renderer.render_panned(job.camera,
+                                                                orbit,
+                                                                pan->first,
+                                                                pan->second,
+                                                                job.max_iters,
+                                                                out)
+                                       : renderer.render(job.camera, orbit, job.max_iters, out);
+    if (samples.side == 1) {
+        return stats;
+    }
+    find_edges();
+    return add_samples(
+        stats, renderer.render_samples(job.camera, orbit, job.max_iters, samples, aa_threshold));
+}
+
+// Only the wall time is known of a render spread over servers. Exits if they all failed.
+auto render_remote(remote::Client &client, Job const &job, std::span<std::uint32_t> out)
+    -> cpu::SchedulerStats {
+    auto const start = std::chrono::steady_clock::now();
+    if (!client.render(job.camera, job.max_iters, out)) {
+        fmt::println(stderr, "{}: every render server failed.", job.output.c_str());
+        std::exit(EXIT_FAILURE);  // NOLINT
+    }
+    auto stats = cpu::SchedulerStats{};
+    stats.wall = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+[[nodiscard]] auto read_jobs(std::filesystem::path const &path,
+                             std::vector<colormap::Table> &color_maps) -> std::vector<Job> {
+    auto file = std::ifstream{path};
+    if (!file.is_open()) {
+        usage_error(fmt::format("Cannot open job file {}.", path.c_str()));
+    }
+    auto jobs = std::vector<Job>{};
+    auto line = std::string{};
+    auto line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        auto fields = std::istringstream{line};
+        auto x = std::string{};
+        auto y = std::string{};
+        auto zoom = std::string{};
+        auto width = std::string{};
+        auto height = std::string{};
+        auto iters = std::string{};
+        auto color_map = std::string{};
+        auto output = std::string{};
+        if (!(fields >> x >> y >> zoom >> width >> height >> iters >> color_map >> output)) {
+            usage_error(fmt::format("{}:{}: expected 8 fields.", path.c_str(), line_no));
+        }
+        auto job = Job{};
+        job.camera.x_offset = parse_fixed("x"sv, x);
+        job.camera.y_offset = parse_fixed("y"sv, y);
+        parse_into("zoom"sv, zoom, job.camera.zoom);
+        parse_into("width"sv, width, job.camera.width);
+        parse_into("height"sv, height, job.camera.height);
+        parse_into("iters"sv, iters, job.max_iters);
+        job.color_map = parse_color_map(color_map, color_maps);
+        job.output = output;
+        if (!validate(job)) {
+            usage_error(
+                fmt::format("{}:{}: invalid size or iteration limit.", path.c_str(), line_no));
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+[[nodiscard]] auto parse_args(std::span<char *> args) -> Options {
+    auto options = Options{};
+    auto single = Job{};
+    auto job_file = std::optional<std::filesystem::path>{};
+    for (auto i = std::size_t{1}; i < args.size(); ++i) {
+        auto const arg = std::string_view{args[i]};
+        if (arg == "--help"sv || arg == "-h"sv) {
+            fmt::println("{}", g_usage);
+            std::exit(EXIT_SUCCESS);  // NOLINT
+        }
+        if (arg == "--stats"sv) {
+            options.stats = true;
+            continue;
+        }
+        if (arg == "--no-interior-checks"sv) {
+            options.engine.interior_checks = false;
+            continue;
+        }
+        if (arg == "--subdivide"sv) {
+            options.engine.subdivide = true;
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            usage_error(fmt::format("Missing value for {}.", arg));
+        }
+        auto const value = std::string_view{args[++i]};
+        if (arg == "--x"sv) {
+            single.camera.x_offset = parse_fixed(arg, value);
+        } else if (arg == "--y"sv) {
+            single.camera.y_offset = parse_fixed(arg, value);
+        } else if (arg == "--zoom"sv) {
+            parse_into(arg, value, single.camera.zoom);
+        } else if (arg == "--width"sv) {
+            parse_into(arg, value, single.camera.width);
+        } else if (arg == "--height"sv) {
+            parse_into(arg, value, single.camera.height);
+        } else if (arg == "--iters"sv) {
+            parse_into(arg, value, single.max_iters);
+        } else if (arg == "--colormap"sv) {
+            single.color_map = parse_color_map(value, options.color_maps);
+        } else if (arg == "--output"sv) {
+            single.output = value;
+        } else if (arg == "--jobs"sv) {
+            job_file = value;
+        } else if (arg == "--threads"sv) {
+            parse_into(arg, value, options.engine.threads);
+        } else if (arg == "--tile"sv) {
+            parse_into(arg, value, options.engine.tile_size);
+        } else if (arg == "--isa"sv) {
+            options.engine.isa = parse_isa(value);
+        } else if (arg == "--tile-cache"sv) {
+            parse_into(arg, value, options.tile_cache_mib);
+        } else if (arg == "--aa"sv) {
+            parse_into(arg, value, options.aa_samples);
+        } else if (arg == "--aa-threshold"sv) {
+            parse_into(arg, value, options.aa_threshold);
+        } else if (arg == "--trace"sv) {
+            options.trace = value;
+        } else if (arg == "--iterations"sv) {
+            options.iterations = value;
+        } else if (arg == "--convert"sv) {
+            options.convert = value;
+        } else if (arg == "--serve"sv) {
+            options.serve = parse_address(arg, value);
+        } else if (arg == "--servers"sv) {
+            options.servers = parse_addresses(arg, value);
+        } else {
+            usage_error(fmt::format("Unknown option {}.", arg));
+        }
+    }
+    if (options.engine.tile_size <= 0) {
+        usage_error("Tile size must be positive."sv);
+    }
+    if (options.aa_samples <= 0 || options.aa_threshold < 0.0F) {
+        usage_error("Invalid anti-aliasing samples or threshold."sv);
+    }
+    if (options.serve.has_value() && !options.servers.empty()) {
+        usage_error("--serve and --servers cannot be combined."sv);
+    }
+    if (options.serve.has_value() && options.trace.has_value()) {
+        usage_error("--serve runs until killed: trace the clients instead."sv);
+    }
+    if ((options.iterations.has_value() || options.convert.has_value())
+        && (job_file.has_value() || options.serve.has_value() || !options.servers.empty())) {
+        usage_error("--iterations and --convert take a single view, rendered locally."sv);
+    }
+    if (job_file.has_value()) {
+        options.jobs = read_jobs(job_file.value(), options.color_maps);
+    } else {
+        if (!validate(single)) {
+            usage_error("Invalid size or iteration limit."sv);
+        }
+        options.jobs.push_back(std::move(single));
+    }
+    return options;
+}
+
+struct Frame {
+    Job const *job{nullptr};
+    std::vector<std::uint32_t> iterations;
+    aa::Samples samples;
+};
+
+// Colorizes and writes frames on its own thread, so that the renderer can move on to the next
+// job while the previous image is being encoded and written. At most s_depth frames are in
+// flight; their buffers are recycled.
+class Writer {
+public:
+    inline static constexpr auto s_depth = 2U;
+
+    explicit Writer(std::span<colormap::Table const> color_maps)
+        : m_color_maps{color_maps}
+        , m_thread{[this](std::stop_token const &stop) { loop(stop); }} {
+    }
+
+    Writer(Writer const &) = delete;
+    auto operator=(Writer const &) -> Writer & = delete;
+    Writer(Writer &&) = delete;
+    auto operator=(Writer &&) -> Writer & = delete;
+
+    ~Writer() {
+        finish();
+    }
+
+    [[nodiscard]] auto acquire() -> Frame {
+        auto lock = std::unique_lock{m_mutex};
+        m_cv.wait(lock, [this] { return m_in_flight < s_depth; });
+        ++m_in_flight;
+        if (m_free.empty()) {
+            return Frame{};
+        }
+        auto frame = std::move(m_free.back());
+        m_free.pop_back();
+        return frame;
+    }
+
+    auto submit(Frame frame) -> void {
+        auto const lock = std::scoped_lock{m_mutex};
+        m_queue.push_back(std::move(frame));
+        m_cv.notify_all();
+    }
+
+    // Waits for all the submitted frames to be written.
+    auto finish() -> void {
+        auto lock = std::unique_lock{m_mutex};
+        m_cv.wait(lock, [this] { return m_in_flight == 0; });
+    }
+
+    [[nodiscard]] auto failures() const -> std::size_t {
+        return m_failures;
+    }
+
+private:
+    auto loop(std::stop_token const &stop) -> void {
+        trace::set_thread_name("writer");
+        auto img = image::Image{};
+        while (true) {
+            auto frame = Frame{};
+            {
+                auto lock = std::unique_lock{m_mutex};
+                if (!m_cv.wait(lock, stop, [this] { return !m_queue.empty(); })) {
+                    return;
+                }
+                frame = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            auto const &job = *frame.job;
+            auto const ok = [&] {
+                auto const zone = trace::Zone{"colorize and write"};
+                image::colorize(frame.iterations,
+                                job.camera.width,
+                                job.camera.height,
+                                m_color_maps[job.color_map],
+                                job.max_iters,
+                                frame.samples,
+                                img);
+                return image::write_ppm(job.output, img);
+            }();
+            auto const lock = std::scoped_lock{m_mutex};
+            if (!ok) {
+                ++m_failures;
+            }
+            m_free.push_back(std::move(frame));
+            --m_in_flight;
+            m_cv.notify_all();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    std::deque<Frame> m_queue;
+    std::vector<Frame> m_free;
+    std::size_t m_in_flight{0};
+    std::size_t m_failures{0};
+    std::span<colormap::Table const> m_color_maps;
+    std::jthread m_thread;
+};
+
+// The single view of options into a new iteration file.
+auto render_iterations(Options const &options, std::filesystem::path const &path) -> int {
+    auto const &job = options.jobs.front();
+    auto const file = itfile::File::create(
+        path, itfile::Header{.camera = job.camera, .max_iters = job.max_iters});
+    if (!file.has_value()) {
+        return EXIT_FAILURE;
+    }
+    auto renderer = cpu::Renderer{options.engine};
+    fmt::println(stderr,
+                 "{}x{} tiles of {}x{} pixels, {} threads, {} kernel",
+                 file->header().columns(),
+                 file->header().rows(),
+                 itfile::g_tile_size,
+                 itfile::g_tile_size,
+                 renderer.thread_count(),
+                 cpu::isa_name(renderer.isa()));
+    auto const start = std::chrono::steady_clock::now();
+    itfile::render(renderer, file.value());
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    fmt::println(stderr,
+                 "{} in {:.2f} s, {:.1f} Mpixels/s",
+                 path.c_str(),
+                 seconds.count(),
+                 static_cast<double>(job.camera.to_view().pixel_count()) / seconds.count()
+                     * 1e-6);  // NOLINT
+    return EXIT_SUCCESS;
+}
+
+// Runs the mode of options and returns the exit status.
+auto run(Options const &options) -> int {
+    if (options.convert.has_value()) {
+        auto const file = itfile::File::open(options.convert.value());
+        auto const &job = options.jobs.front();
+        return file.has_value()
+                       && itfile::write_ppm(
+                           file.value(), options.color_maps[job.color_map], job.output)
+                   ? EXIT_SUCCESS
+                   : EXIT_FAILURE;
+    }
+    if (options.iterations.has_value()) {
+        return render_iterations(options, options.iterations.value());
+    }
+    if (options.serve.has_value()) {
+        auto listener = net::Listener::listen(options.serve.value());
+        if (!listener.has_value()) {
+            return EXIT_FAILURE;
+        }
+        fmt::println(stderr, "Serving on {}", options.serve->to_string());
+        remote::serve(listener.value(), options.engine);
+        return EXIT_FAILURE;
+    }
+
+    // Either the images are rendered here, or by the servers.
+    auto renderer = std::optional<cpu::Renderer>{};
+    auto client = std::optional<remote::Client>{};
+    if (options.servers.empty()) {
+        renderer.emplace(options.engine);
+        fmt::println(stderr,
+                     "{} jobs, {} threads, {}x{} tiles, {} kernel",
+                     options.jobs.size(),
+                     renderer->thread_count(),
+                     renderer->tile_size(),
+                     renderer->tile_size(),
+                     cpu::isa_name(renderer->isa()));
+    } else {
+        client = remote::Client::connect(options.servers);
+        if (!client.has_value()) {
+            fmt::println(stderr, "No render server could be reached.");
+            return EXIT_FAILURE;
+        }
+        fmt::println(
+            stderr, "{} jobs, {} render servers", options.jobs.size(), client->server_count());
+    }
+
+    auto cache = std::optional<tiles::Cache>{};
+    if (options.tile_cache_mib > 0 && renderer.has_value()) {
+        cache.emplace(options.tile_cache_mib << 20U);  // NOLINT
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    auto pixels = std::size_t{0};
+    auto writer = Writer{options.color_maps};
+    // Consecutive jobs that only pan (e.g. the frames of a camera move) reuse the pixels they
+    // share with the previous image, which is only kept for them.
+    auto const pan_to = [&](std::size_t index) -> std::optional<Pan> {
+        if (index == 0 || index >= options.jobs.size() || !renderer.has_value()) {
+            return std::nullopt;
+        }
+        return pan_between(options.jobs[index - 1], options.jobs[index]);
+    };
+    auto previous = std::vector<std::uint32_t>{};
+    for (auto index = std::size_t{0}; index < options.jobs.size(); ++index) {
+        auto const &job = options.jobs[index];
+        auto const zone = trace::Zone{"job"};
+        auto frame = [&] {
+            auto const wait_zone = trace::Zone{"wait for writer"};
+            return writer.acquire();
+        }();
+        frame.job = &job;
+        auto const pan = pan_to(index);
+        if (pan.has_value()) {
+            frame.iterations.swap(previous);
+        } else {
+            frame.iterations.resize(job.camera.to_view().pixel_count());
+        }
+        auto const before = cache.has_value() ? cache->stats() : tiles::Stats{};
+        frame.samples.side = renderer.has_value() ? aa::grid_side(options.aa_samples) : 1;
+        frame.samples.pixels.clear();
+        frame.samples.counts.clear();
+        auto const stats = [&] {
+            auto const zone = trace::Zone{"render"};
+            return renderer.has_value()
+                       ? render(renderer.value(),
+                                cache,
+                                job,
+                                pan,
+                                options.aa_threshold,
+                                frame.iterations,
+                                frame.samples)
+                       : render_remote(client.value(), job, frame.iterations);
+        }();
+        if (pan_to(index + 1).has_value()) {
+            previous.assign(frame.iterations.begin(), frame.iterations.end());
+        } else {
+            previous = {};
+        }
+        pixels += frame.iterations.size();
+        if (options.stats && cache.has_value()) {
+            auto const after = cache->stats();
+            fmt::println(stderr,
+                         "{}: {:.1f} ms, tiles {} hits, {} misses, {} evictions",
+                         job.output.c_str(),
+                         std::chrono::duration<double, std::milli>(stats.wall).count(),
+                         after.hits - before.hits,
+                         after.misses - before.misses,
+                         after.evictions - before.evictions);
+        } else if (options.stats && client.has_value()) {
+            fmt::println(stderr,
+                         "{}: {:.1f} ms",
+                         job.output.c_str(),
+                         std::chrono::duration<double, std::milli>(stats.wall).count());
+        } else if (options.stats) {
+            fmt::println(stderr,
+                         "{}: {:.1f} ms, mean utilization {:.1f}%, skipped {:.1f}%",
+                         job.output.c_str(),
+                         std::chrono::duration<double, std::milli>(stats.wall).count(),
+                         stats.mean_utilization() * 100.0,  // NOLINT
+                         static_cast<double>(stats.skipped_pixels) * 100.0  // NOLINT
+                             / static_cast<double>(frame.iterations.size()));
+        }
+        writer.submit(std::move(frame));
+    }
+    writer.finish();
+
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    fmt::println(stderr,
+                 "{} images in {:.2f} s, {:.1f} Mpixels/s",
+                 options.jobs.size(),
+                 seconds.count(),
+                 static_cast<double>(pixels) / seconds.count() * 1e-6);  // NOLINT
+    if (cache.has_value()) {
+        auto const totals = cache->stats();
+        fmt::println(stderr,
+                     "tile cache: {} hits, {} misses, {} evictions, {} MiB",
+                     totals.hits,
+                     totals.misses,
+                     totals.evictions,
+                     cache->size_bytes() >> 20U);  // NOLINT
+    }
+    return writer.failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    auto const options = parse_args(std::span{argv, static_cast<std::size_t>(argc)});
+    if (options.trace.has_value()) {
+        trace::enable();
+        trace::set_thread_name("main");
+    }
+    auto const status = run(options);
+    if (options.trace.has_value() && !trace::write_json(options.trace.value())) {
+        return EXIT_FAILURE;
+    }
+    return status;
+}
@@ -0,0 +1,584 @@
+#include "glad/glad.h"
+
+#include "cpu_kernel.hpp"
+#include "cpu_renderer.hpp"
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include "framebuffer.hpp"
+#include "glfw_wrapper.hpp"
+#include "program.hpp"
+#include "shaders.hpp"
+#include "uniform_buffer.hpp"
+#include "vao.hpp"
+#include "view.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr auto g_usage = R"(Usage: mandelbrot_bench [options]
+
+Times the escape-time kernels over fixed views, resolutions and iteration limits and reports
+Mpixels/s and Giters/s (iterations summed over the pixels, interior ones counting the limit).
+
+Cases:
+  --views <list>        comma separated: full, seahorse, interior, boundary (default: all)
+  --sizes <list>        comma separated WxH (default: 640x360,1280x720,1920x1080)
+  --iters <list>        comma separated iteration limits (default: 256,2048)
+  --engines <list>      comma separated: scalar, avx2, avx512, gl (default: the instruction
+                        sets this CPU supports, and gl with --shaders)
+  --shaders <dir>       shaders directory, enables the gl engine (offscreen, hidden window)
+  --threads <int>       CPU worker threads, 0 for all hardware threads (default 0)
+  --no-interior-checks  iterate interior points up to the limit
+  --repetitions <int>   timed runs per case, after a warm-up run; the median is kept
+                        (default 3)
+
+Baseline:
+  --json <file>         write the results there
+  --baseline <file>     compare with results written by --json and fail when a case is more
+                        than the threshold slower (in Mpixels/s)
+  --threshold <num>     allowed slowdown, as a fraction (default 0.1))";
+
+struct Preset {
+    std::string_view name;
+    float x_offset;
+    float y_offset;
+    float zoom;
+};
+
+// All within the float kernels, so that every engine computes the same counts.
+constexpr auto g_presets = std::array{
+    // The whole set, mostly fast escaping pixels.
+    Preset{.name = "full"sv, .x_offset = 0.0F, .y_offset = 0.0F, .zoom = 1.0F},
+    // Spirals between the main cardioid and the period-2 bulb.
+    Preset{.name = "seahorse"sv, .x_offset = -0.29744F, .y_offset = 0.05272F, .zoom = 0.01F},
+    // Inside the main cardioid: every pixel reaches the limit without interior checks.
+    Preset{.name = "interior"sv, .x_offset = -0.1F, .y_offset = 0.0F, .zoom = 0.05F},
+    // Filaments and minibrots along the boundary, where neighbouring counts differ most.
+    Preset{.name = "boundary"sv, .x_offset = -0.3F, .y_offset = 0.05F, .zoom = 0.0625F},
+};
+
+struct Size {
+    int width;
+    int height;
+};
+
+constexpr auto g_default_sizes = std::array{
+    Size{.width = 640, .height = 360},
+    Size{.width = 1280, .height = 720},
+    Size{.width = 1920, .height = 1080},
+};
+
+constexpr auto g_default_iters = std::array{std::uint32_t{256}, std::uint32_t{2048}};
+
+constexpr auto g_default_repetitions = 3;
+constexpr auto g_default_threshold = 0.1;
+
+struct Options {
+    std::vector<Preset> views{g_presets.begin(), g_presets.end()};
+    std::vector<Size> sizes{g_default_sizes.begin(), g_default_sizes.end()};
+    std::vector<std::uint32_t> iters{g_default_iters.begin(), g_default_iters.end()};
+    std::vector<std::string> engines;
+    std::optional<std::filesystem::path> shaders;
+    unsigned threads{0};
+    bool interior_checks{true};
+    int repetitions{g_default_repetitions};
+    std::optional<std::filesystem::path> json;
+    std::optional<std::filesystem::path> baseline;
+    double threshold{g_default_threshold};
+};
+
+[[noreturn]] auto usage_error(std::string_view msg) -> void {
+    fmt::println(stderr, "{}\n\n{}", msg, g_usage);
+    std::abort();
+}
+
+template <typename T>
+[[nodiscard]] auto parse_number(std::string_view str) -> std::optional<T> {
+    auto value = T{};
+    auto const [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || end != str.data() + str.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+template <typename T>
+auto parse_into(std::string_view option, std::string_view str, T &value) -> void {
+    auto const parsed = parse_number<T>(str);
+    if (!parsed.has_value()) {
+        usage_error(fmt::format("Invalid value '{}' for {}.", str, option));
+    }
+    value = parsed.value();
+}
+
+// Calls parse_item on every element of a comma separated list.
+template <typename ParseFn>
+auto parse_list(std::string_view str, ParseFn const &parse_item) -> void {
+    while (true) {
+        auto const comma = str.find(',');
+        parse_item(str.substr(0, comma));
+        if (comma == std::string_view::npos) {
+            return;
+        }
+        str.remove_prefix(comma + 1);
+    }
+}
+
+auto parse_preset(std::string_view str) -> Preset {
+    auto const it = std::ranges::find(g_presets, str, &Preset::name);
+    if (it == g_presets.end()) {
+        usage_error(fmt::format("Unknown view '{}'.", str));
+    }
+    return *it;
+}
+
+auto parse_size(std::string_view str) -> Size {
+    auto const x = str.find('x');
+    auto const width = parse_number<int>(str.substr(0, x));
+    auto const height
+        = x == std::string_view::npos ? std::nullopt : parse_number<int>(str.substr(x + 1));
+    if (!width.has_value() || !height.has_value() || width.value() <= 0 || height.value() <= 0) {
+        usage_error(fmt::format("Invalid size '{}'.", str));
+    }
+    return Size{.width = width.value(), .height = height.value()};
+}
+
+auto cpu_isa(std::string_view name) -> std::optional<cpu::Isa> {
+    for (auto const isa : {cpu::Isa::SCALAR, cpu::Isa::AVX2, cpu::Isa::AVX512}) {
+        if (cpu::isa_name(isa) == name) {
+            return isa;
+        }
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] auto parse_args(std::span<char *> args) -> Options {
+    auto options = Options{};
+    auto engines_given = false;
+    for (auto i = std::size_t{1}; i < args.size(); ++i) {
+        auto const arg = std::string_view{args[i]};
+        if (arg == "--help"sv || arg == "-h"sv) {
+            fmt::println("{}", g_usage);
+            std::exit(EXIT_SUCCESS);  // NOLINT
+        }
+        if (arg == "--no-interior-checks"sv) {
+            options.interior_checks = false;
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            usage_error(fmt::format("Missing value for {}.", arg));
+        }
+        auto const value = std::string_view{args[++i]};
+        if (arg == "--views"sv) {
+            options.views.clear();
+            parse_list(value, [&](std::string_view item) {
+                options.views.push_back(parse_preset(item));
+            });
+        } else if (arg == "--sizes"sv) {
+            options.sizes.clear();
+            parse_list(value, [&](std::string_view item) {
+                options.sizes.push_back(parse_size(item));
+            });
+        } else if (arg == "--iters"sv) {
+            options.iters.clear();
+            parse_list(value, [&](std::string_view item) {
+                parse_into(arg, item, options.iters.emplace_back());
+            });
+        } else if (arg == "--engines"sv) {
+            engines_given = true;
+            parse_list(value, [&](std::string_view item) { options.engines.emplace_back(item); });
+        } else if (arg == "--shaders"sv) {
+            options.shaders = value;
+        } else if (arg == "--threads"sv) {
+            parse_into(arg, value, options.threads);
+        } else if (arg == "--repetitions"sv) {
+            parse_into(arg, value, options.repetitions);
+        } else if (arg == "--json"sv) {
+            options.json = value;
+        } else if (arg == "--baseline"sv) {
+            options.baseline = value;
+        } else if (arg == "--threshold"sv) {
+            parse_into(arg, value, options.threshold);
+        } else {
+            usage_error(fmt::format("Unknown option {}.", arg));
+        }
+    }
+    if (!engines_given) {
+        for (auto const isa : {cpu::Isa::SCALAR, cpu::Isa::AVX2, cpu::Isa::AVX512}) {
+            if (cpu::is_supported(isa)) {
+                options.engines.emplace_back(cpu::isa_name(isa));
+            }
+        }
+        if (options.shaders.has_value()) {
+            options.engines.emplace_back("gl"sv);
+        }
+    }
+    for (auto const &engine : options.engines) {
+        if (engine == "gl"sv) {
+            if (!options.shaders.has_value()) {
+                usage_error("The gl engine needs --shaders."sv);
+            }
+            continue;
+        }
+        auto const isa = cpu_isa(engine);
+        if (!isa.has_value()) {
+            usage_error(fmt::format("Unknown engine '{}'.", engine));
+        }
+        if (!cpu::is_supported(isa.value())) {
+            usage_error(fmt::format("{} is not supported by this CPU.", engine));
+        }
+    }
+    if (options.repetitions <= 0 || options.threshold < 0.0
+        || std::ranges::find(options.iters, std::uint32_t{0}) != options.iters.end()) {
+        usage_error("Invalid repetitions, threshold or iteration limit."sv);
+    }
+    return options;
+}
+
+// Computes the counts of a view; run() is timed, counts() only reads back the last result.
+struct Engine {
+    std::function<void(View const &, std::uint32_t)> run;
+    std::function<void(std::span<std::uint32_t>)> counts;
+};
+
+auto make_cpu_engine(cpu::Isa isa, Options const &options) -> Engine {
+    auto renderer = std::make_shared<cpu::Renderer>(cpu::Renderer::Options{
+        .threads = options.threads,
+        .isa = isa,
+        .interior_checks = options.interior_checks,
+    });
+    auto out = std::make_shared<std::vector<std::uint32_t>>();
+    return Engine{
+        .run =
+            [renderer, out](View const &view, std::uint32_t max_iters) {
+                out->resize(view.pixel_count());
+                (void)renderer->render(view, max_iters, *out);
+            },
+        .counts =
+            [out](std::span<std::uint32_t> counts) { std::ranges::copy(*out, counts.begin()); },
+    };
+}
+
+// The iteration pass of the viewer into an offscreen target, specialized like the viewer does
+// for the float kernel: the presets are all within its range.
+class GlEngine {
+public:
+    GlEngine(std::filesystem::path const &shaders_path, bool interior_checks)
+        : m_window{glfw::Window::make_hidden(m_terminate)} {
+        m_window.make_context_current();
+        if (gladLoadGLLoader(glfw::loader_fn) == 0) {
+            fmt::println(stderr, "Failed to initialize GLAD");
+            std::abort();
+        }
+        static constexpr auto vertices = std::array{
+            // clang-format off
+             1.0F,  1.0F, 0.0F, // NOLINT top right
+             1.0F, -1.0F, 0.0F, // NOLINT bottom right
+            -1.0F, -1.0F, 0.0F, // NOLINT bottom left
+            -1.0F,  1.0F, 0.0F  // NOLINT top left
+            // clang-format on
+        };
+        static constexpr auto indices = std::array<GLuint, 6U>{0, 1, 3, 1, 2, 3};
+        m_vao.add_buffer(gl::BufferType::ARRAY, std::span{vertices});
+        m_vao.add_buffer(gl::BufferType::ELEMENT_ARRAY, std::span{indices});
+        m_vao.vertex_attrib_ptr(
+            0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), static_cast<GLvoid *>(0));  // NOLINT
+        m_vao.enable(0);
+        m_vao.bind();
+
+        auto const defines = std::array{
+            gl::Program::Define{.name = "KERNEL"sv, .value = "0U"},
+            gl::Program::Define{.name = "INTERIOR_CHECKS"sv,
+                                .value = interior_checks ? "true" : "false"},
+        };
+        auto program = gl::Program::create_and_link(
+            {shaders_path / "shader.vert"sv, shaders_path / "shader.frag"sv},
+            defines,
+            gl::program_cache_dir());
+        if (!program.has_value()) {
+            fmt::println(stderr, "Cannot create program.");
+            std::abort();
+        }
+        m_program = std::move(program);
+        m_view_uniforms.bind(shaders::ViewBlock::s_binding);
+        shaders::bind_view_block(m_program.value());
+        m_interior_checks = interior_checks;
+    }
+
+    // Includes waiting for the GPU to finish.
+    auto run(View const &view, std::uint32_t max_iters) -> void {
+        m_target.resize(view.width, view.height);
+        m_target.bind();
+        m_view_uniforms.set(shaders::ViewBlock{
+            .x_offset = view.x_offset,
+            .y_offset = view.y_offset,
+            .zoom = view.zoom,
+            .max_iters = max_iters,
+            .interior_checks = m_interior_checks ? 1U : 0U,
+        });
+        m_program->set_uniform(
+            shaders::IterationUniform{"view_port"sv},
+            std::pair{static_cast<float>(view.width), static_cast<float>(view.height)});
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, static_cast<GLvoid *>(0));  // NOLINT
+        glFinish();
+    }
+
+    auto counts(std::span<std::uint32_t> out) const -> void {
+        auto texels = std::vector<float>(out.size());
+        m_target.read(GL_RED, GL_FLOAT, texels.data());
+        std::ranges::transform(
+            texels, out.begin(), [](float texel) { return static_cast<std::uint32_t>(texel); });
+    }
+
+private:
+    glfw::Terminate m_terminate{glfw::init()};
+    glfw::Window m_window;
+    gl::Vao m_vao;
+    std::optional<gl::Program> m_program;
+    gl::UniformBuffer<shaders::ViewBlock> m_view_uniforms{
+        gl::UniformBuffer<shaders::ViewBlock>::make()};
+    bool m_interior_checks{true};
+    gl::Framebuffer m_target{gl::Framebuffer::make(GL_RG32F, GL_RG, GL_FLOAT)};
+};
+
+struct Result {
+    std::string name;
+    double mpixels_per_s;
+    double giters_per_s;
+};
+
+// Median of repetitions timed runs, after a warm-up one.
+auto run_case(std::string name,
+              Engine const &engine,
+              View const &view,
+              std::uint32_t max_iters,
+              int repetitions) -> Result {
+    engine.run(view, max_iters);
+    auto seconds = std::vector<double>{};
+    for (auto i = 0; i < repetitions; ++i) {
+        auto const start = std::chrono::steady_clock::now();
+        engine.run(view, max_iters);
+        seconds.push_back(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    auto const median = seconds.begin() + static_cast<std::ptrdiff_t>(seconds.size() / 2);
+    std::ranges::nth_element(seconds, median);
+    auto counts = std::vector<std::uint32_t>(view.pixel_count());
+    engine.counts(counts);
+    auto const iterations = std::accumulate(counts.begin(), counts.end(), std::uint64_t{0});
+    auto const result = Result{
+        .name = std::move(name),
+        .mpixels_per_s = static_cast<double>(view.pixel_count()) / *median * 1e-6,  // NOLINT
+        .giters_per_s = static_cast<double>(iterations) / *median * 1e-9,           // NOLINT
+    };
+    fmt::println("{:<40} {:>10.2f} {:>12.1f} {:>10.3f}",
+                 result.name,
+                 *median * 1e3,  // NOLINT
+                 result.mpixels_per_s,
+                 result.giters_per_s);
+    return result;
+}
+
+auto write_json(std::filesystem::path const &path, std::span<Result const> results) -> bool {
+    auto file = std::ofstream{path};
+    if (!file.is_open()) {
+        fmt::println(stderr, "Cannot open {} for writing.", path.c_str());
+        return false;
+    }
+    file << "{\n  \"results\": [\n";
+    for (auto i = std::size_t{0}; i < results.size(); ++i) {
+        auto const &result = results[i];
+        file << fmt::format(
+            R"(    {{"case": "{}", "mpixels_per_s": {:.3f}, "giters_per_s": {:.4f}}}{})",
+            result.name,
+            result.mpixels_per_s,
+            result.giters_per_s,
+            i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+    return file.good();
+}
+
+// Reads back what write_json() wrote: the case names and their Mpixels/s.
+auto read_json(std::filesystem::path const &path) -> std::optional<std::vector<Result>> {
+    auto file = std::ifstream{path};
+    if (!file.is_open()) {
+        fmt::println(stderr, "Cannot open baseline {}.", path.c_str());
+        return std::nullopt;
+    }
+    auto const text = (std::ostringstream{} << file.rdbuf()).str();
+    auto const malformed = [&] {
+        fmt::println(stderr, "{}: not a baseline written by --json.", path.c_str());
+        return std::nullopt;
+    };
+    // The quoted value of the key at pos.
+    auto const string_at = [&](std::size_t pos) -> std::optional<std::string> {
+        auto const colon = text.find(':', pos);
+        auto const open = colon == std::string::npos ? colon : text.find('"', colon);
+        auto const close = open == std::string::npos ? open : text.find('"', open + 1);
+        if (close == std::string::npos) {
+            return std::nullopt;
+        }
+        return text.substr(open + 1, close - open - 1);
+    };
+    auto results = std::vector<Result>{};
+    constexpr auto case_key = R"("case")"sv;
+    constexpr auto mpixels_key = R"("mpixels_per_s")"sv;
+    for (auto pos = text.find(case_key); pos != std::string::npos;
+         pos = text.find(case_key, pos + 1)) {
+        auto const name = string_at(pos);
+        auto const value_pos = text.find(mpixels_key, pos);
+        if (!name.has_value() || value_pos == std::string::npos) {
+            return malformed();
+        }
+        auto const begin = text.find_first_not_of(" :", value_pos + mpixels_key.size());
+        auto const end = begin == std::string::npos ? begin : text.find_first_of(",}", begin);
+        if (end == std::string::npos) {
+            return malformed();
+        }
+        auto const value = parse_number<double>(std::string_view{text}.substr(begin, end - begin));
+        if (!value.has_value()) {
+            fmt::println(stderr, "{}: invalid value for {}.", path.c_str(), name.value());
+            return std::nullopt;
+        }
+        results.push_back(
+            Result{.name = name.value(), .mpixels_per_s = value.value(), .giters_per_s = 0.0});
+    }
+    // A truncated file still ends with some complete cases: its list must be closed too.
+    auto const last = text.rfind(case_key);
+    if (results.empty() || text.find(']', last) == std::string::npos) {
+        return malformed();
+    }
+    return results;
+}
+
+struct Comparison {
+    // Cases of the run found in the baseline.
+    std::size_t matched{0};
+    // Of those, the ones more than the threshold slower.
+    std::size_t regressions{0};
+};
+
+auto compare(std::span<Result const> results, std::span<Result const> baseline, double threshold)
+    -> Comparison {
+    auto comparison = Comparison{};
+    for (auto const &result : results) {
+        auto const base = std::ranges::find(baseline, result.name, &Result::name);
+        if (base == baseline.end()) {
+            fmt::println("{:<40} new", result.name);
+            continue;
+        }
+        ++comparison.matched;
+        auto const ratio = result.mpixels_per_s / base->mpixels_per_s;
+        auto const regressed = ratio < 1.0 - threshold;
+        comparison.regressions += regressed ? 1U : 0U;
+        fmt::println("{:<40} {:>9.1f} vs {:>9.1f} Mpixels/s  {:+6.1f}%{}",
+                     result.name,
+                     result.mpixels_per_s,
+                     base->mpixels_per_s,
+                     (ratio - 1.0) * 100.0,  // NOLINT
+                     regressed ? "  REGRESSION" : "");
+    }
+    return comparison;
+}
+
+}  // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    auto const options = parse_args(std::span{argv, static_cast<std::size_t>(argc)});
+
+    auto gl_engine = std::optional<GlEngine>{};
+    auto engines = std::vector<std::pair<std::string, Engine>>{};
+    for (auto const &name : options.engines) {
+        if (name != "gl"sv) {
+            engines.emplace_back(name, make_cpu_engine(cpu_isa(name).value(), options));
+            continue;
+        }
+        gl_engine.emplace(options.shaders.value(), options.interior_checks);
+        engines.emplace_back(
+            name,
+            Engine{
+                .run = [&](View const &view,
+                           std::uint32_t max_iters) { gl_engine->run(view, max_iters); },
+                .counts = [&](std::span<std::uint32_t> counts) { gl_engine->counts(counts); },
+            });
+    }
+
+    auto results = std::vector<Result>{};
+    fmt::println("{:<40} {:>10} {:>12} {:>10}", "case", "ms", "Mpixels/s", "Giters/s");
+    for (auto const &preset : options.views) {
+        for (auto const &[engine_name, engine] : engines) {
+            for (auto const size : options.sizes) {
+                for (auto const max_iters : options.iters) {
+                    auto const view = View{
+                        .x_offset = preset.x_offset,
+                        .y_offset = preset.y_offset,
+                        .zoom = preset.zoom,
+                        .width = size.width,
+                        .height = size.height,
+                    };
+                    results.push_back(run_case(fmt::format("{}/{}/{}x{}/{}",
+                                                           preset.name,
+                                                           engine_name,
+                                                           size.width,
+                                                           size.height,
+                                                           max_iters),
+                                               engine,
+                                               view,
+                                               max_iters,
+                                               options.repetitions));
+                }
+            }
+        }
+    }
+
+    if (options.json.has_value() && !write_json(options.json.value(), results)) {
+        return EXIT_FAILURE;
+    }
+    if (options.baseline.has_value()) {
+        auto const baseline = read_json(options.baseline.value());
+        if (!baseline.has_value()) {
+            return EXIT_FAILURE;
+        }
+        fmt::println("");
+        auto const comparison = compare(results, baseline.value(), options.threshold);
+        if (comparison.matched == 0) {
+            fmt::println(stderr,
+                         "None of the {} cases is in the baseline: nothing was compared.",
+                         results.size());
+            return EXIT_FAILURE;
+        }
+        if (comparison.regressions > 0) {
+            fmt::println(stderr,
+                         "{} of {} cases more than {:.0f}% slower than the baseline.",
+                         comparison.regressions,
+                         comparison.matched,
+                         options.threshold * 100.0);  // NOLINT
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,684 @@
+#include "colormap.hpp"
+
+#include "fmt/base.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using colormap::Rgb;
+
+// https://github.com/BIDS/colormap/blob/master/colormaps.py
+constexpr auto g_viridis_data = std::array{
+    Rgb{0.267004F, 0.004874F, 0.329415F},
+    Rgb{0.268510F, 0.009605F, 0.335427F},
+    Rgb{0.269944F, 0.014625F, 0.341379F},
+    Rgb{0.271305F, 0.019942F, 0.347269F},
+    Rgb{0.272594F, 0.025563F, 0.353093F},
+    Rgb{0.273809F, 0.031497F, 0.358853F},
+    Rgb{0.274952F, 0.037752F, 0.364543F},
+    Rgb{0.276022F, 0.044167F, 0.370164F},
+    Rgb{0.277018F, 0.050344F, 0.375715F},
+    Rgb{0.277941F, 0.056324F, 0.381191F},
+    Rgb{0.278791F, 0.062145F, 0.386592F},
+    Rgb{0.279566F, 0.067836F, 0.391917F},
+    Rgb{0.280267F, 0.073417F, 0.397163F},
+    Rgb{0.280894F, 0.078907F, 0.402329F},
+    Rgb{0.281446F, 0.084320F, 0.407414F},
+    Rgb{0.281924F, 0.089666F, 0.412415F},
+    Rgb{0.282327F, 0.094955F, 0.417331F},
+    Rgb{0.282656F, 0.100196F, 0.422160F},
+    Rgb{0.282910F, 0.105393F, 0.426902F},
+    Rgb{0.283091F, 0.110553F, 0.431554F},
+    Rgb{0.283197F, 0.115680F, 0.436115F},
+    Rgb{0.283229F, 0.120777F, 0.440584F},
+    Rgb{0.283187F, 0.125848F, 0.444960F},
+    Rgb{0.283072F, 0.130895F, 0.449241F},
+    Rgb{0.282884F, 0.135920F, 0.453427F},
+    Rgb{0.282623F, 0.140926F, 0.457517F},
+    Rgb{0.282290F, 0.145912F, 0.461510F},
+    Rgb{0.281887F, 0.150881F, 0.465405F},
+    Rgb{0.281412F, 0.155834F, 0.469201F},
+    Rgb{0.280868F, 0.160771F, 0.472899F},
+    Rgb{0.280255F, 0.165693F, 0.476498F},
+    Rgb{0.279574F, 0.170599F, 0.479997F},
+    Rgb{0.278826F, 0.175490F, 0.483397F},
+    Rgb{0.278012F, 0.180367F, 0.486697F},
+    Rgb{0.277134F, 0.185228F, 0.489898F},
+    Rgb{0.276194F, 0.190074F, 0.493001F},
+    Rgb{0.275191F, 0.194905F, 0.496005F},
+    Rgb{0.274128F, 0.199721F, 0.498911F},
+    Rgb{0.273006F, 0.204520F, 0.501721F},
+    Rgb{0.271828F, 0.209303F, 0.504434F},
+    Rgb{0.270595F, 0.214069F, 0.507052F},
+    Rgb{0.269308F, 0.218818F, 0.509577F},
+    Rgb{0.267968F, 0.223549F, 0.512008F},
+    Rgb{0.266580F, 0.228262F, 0.514349F},
+    Rgb{0.265145F, 0.232956F, 0.516599F},
+    Rgb{0.263663F, 0.237631F, 0.518762F},
+    Rgb{0.262138F, 0.242286F, 0.520837F},
+    Rgb{0.260571F, 0.246922F, 0.522828F},
+    Rgb{0.258965F, 0.251537F, 0.524736F},
+    Rgb{0.257322F, 0.256130F, 0.526563F},
+    Rgb{0.255645F, 0.260703F, 0.528312F},
+    Rgb{0.253935F, 0.265254F, 0.529983F},
+    Rgb{0.252194F, 0.269783F, 0.531579F},
+    Rgb{0.250425F, 0.274290F, 0.533103F},
+    Rgb{0.248629F, 0.278775F, 0.534556F},
+    Rgb{0.246811F, 0.283237F, 0.535941F},
+    Rgb{0.244972F, 0.287675F, 0.537260F},
+    Rgb{0.243113F, 0.292092F, 0.538516F},
+    Rgb{0.241237F, 0.296485F, 0.539709F},
+    Rgb{0.239346F, 0.300855F, 0.540844F},
+    Rgb{0.237441F, 0.305202F, 0.541921F},
+    Rgb{0.235526F, 0.309527F, 0.542944F},
+    Rgb{0.233603F, 0.313828F, 0.543914F},
+    Rgb{0.231674F, 0.318106F, 0.544834F},
+    Rgb{0.229739F, 0.322361F, 0.545706F},
+    Rgb{0.227802F, 0.326594F, 0.546532F},
+    Rgb{0.225863F, 0.330805F, 0.547314F},
+    Rgb{0.223925F, 0.334994F, 0.548053F},
+    Rgb{0.221989F, 0.339161F, 0.548752F},
+    Rgb{0.220057F, 0.343307F, 0.549413F},
+    Rgb{0.218130F, 0.347432F, 0.550038F},
+    Rgb{0.216210F, 0.351535F, 0.550627F},
+    Rgb{0.214298F, 0.355619F, 0.551184F},
+    Rgb{0.212395F, 0.359683F, 0.551710F},
+    Rgb{0.210503F, 0.363727F, 0.552206F},
+    Rgb{0.208623F, 0.367752F, 0.552675F},
+    Rgb{0.206756F, 0.371758F, 0.553117F},
+    Rgb{0.204903F, 0.375746F, 0.553533F},
+    Rgb{0.203063F, 0.379716F, 0.553925F},
+    Rgb{0.201239F, 0.383670F, 0.554294F},
+    Rgb{0.199430F, 0.387607F, 0.554642F},
+    Rgb{0.197636F, 0.391528F, 0.554969F},
+    Rgb{0.195860F, 0.395433F, 0.555276F},
+    Rgb{0.194100F, 0.399323F, 0.555565F},
+    Rgb{0.192357F, 0.403199F, 0.555836F},
+    Rgb{0.190631F, 0.407061F, 0.556089F},
+    Rgb{0.188923F, 0.410910F, 0.556326F},
+    Rgb{0.187231F, 0.414746F, 0.556547F},
+    Rgb{0.185556F, 0.418570F, 0.556753F},
+    Rgb{0.183898F, 0.422383F, 0.556944F},
+    Rgb{0.182256F, 0.426184F, 0.557120F},
+    Rgb{0.180629F, 0.429975F, 0.557282F},
+    Rgb{0.179019F, 0.433756F, 0.557430F},
+    Rgb{0.177423F, 0.437527F, 0.557565F},
+    Rgb{0.175841F, 0.441290F, 0.557685F},
+    Rgb{0.174274F, 0.445044F, 0.557792F},
+    Rgb{0.172719F, 0.448791F, 0.557885F},
+    Rgb{0.171176F, 0.452530F, 0.557965F},
+    Rgb{0.169646F, 0.456262F, 0.558030F},
+    Rgb{0.168126F, 0.459988F, 0.558082F},
+    Rgb{0.166617F, 0.463708F, 0.558119F},
+    Rgb{0.165117F, 0.467423F, 0.558141F},
+    Rgb{0.163625F, 0.471133F, 0.558148F},
+    Rgb{0.162142F, 0.474838F, 0.558140F},
+    Rgb{0.160665F, 0.478540F, 0.558115F},
+    Rgb{0.159194F, 0.482237F, 0.558073F},
+    Rgb{0.157729F, 0.485932F, 0.558013F},
+    Rgb{0.156270F, 0.489624F, 0.557936F},
+    Rgb{0.154815F, 0.493313F, 0.557840F},
+    Rgb{0.153364F, 0.497000F, 0.557724F},
+    Rgb{0.151918F, 0.500685F, 0.557587F},
+    Rgb{0.150476F, 0.504369F, 0.557430F},
+    Rgb{0.149039F, 0.508051F, 0.557250F},
+    Rgb{0.147607F, 0.511733F, 0.557049F},
+    Rgb{0.146180F, 0.515413F, 0.556823F},
+    Rgb{0.144759F, 0.519093F, 0.556572F},
+    Rgb{0.143343F, 0.522773F, 0.556295F},
+    Rgb{0.141935F, 0.526453F, 0.555991F},
+    Rgb{0.140536F, 0.530132F, 0.555659F},
+    Rgb{0.139147F, 0.533812F, 0.555298F},
+    Rgb{0.137770F, 0.537492F, 0.554906F},
+    Rgb{0.136408F, 0.541173F, 0.554483F},
+    Rgb{0.135066F, 0.544853F, 0.554029F},
+    Rgb{0.133743F, 0.548535F, 0.553541F},
+    Rgb{0.132444F, 0.552216F, 0.553018F},
+    Rgb{0.131172F, 0.555899F, 0.552459F},
+    Rgb{0.129933F, 0.559582F, 0.551864F},
+    Rgb{0.128729F, 0.563265F, 0.551229F},
+    Rgb{0.127568F, 0.566949F, 0.550556F},
+    Rgb{0.126453F, 0.570633F, 0.549841F},
+    Rgb{0.125394F, 0.574318F, 0.549086F},
+    Rgb{0.124395F, 0.578002F, 0.548287F},
+    Rgb{0.123463F, 0.581687F, 0.547445F},
+    Rgb{0.122606F, 0.585371F, 0.546557F},
+    Rgb{0.121831F, 0.589055F, 0.545623F},
+    Rgb{0.121148F, 0.592739F, 0.544641F},
+    Rgb{0.120565F, 0.596422F, 0.543611F},
+    Rgb{0.120092F, 0.600104F, 0.542530F},
+    Rgb{0.119738F, 0.603785F, 0.541400F},
+    Rgb{0.119512F, 0.607464F, 0.540218F},
+    Rgb{0.119423F, 0.611141F, 0.538982F},
+    Rgb{0.119483F, 0.614817F, 0.537692F},
+    Rgb{0.119699F, 0.618490F, 0.536347F},
+    Rgb{0.120081F, 0.622161F, 0.534946F},
+    Rgb{0.120638F, 0.625828F, 0.533488F},
+    Rgb{0.121380F, 0.629492F, 0.531973F},
+    Rgb{0.122312F, 0.633153F, 0.530398F},
+    Rgb{0.123444F, 0.636809F, 0.528763F},
+    Rgb{0.124780F, 0.640461F, 0.527068F},
+    Rgb{0.126326F, 0.644107F, 0.525311F},
+    Rgb{0.128087F, 0.647749F, 0.523491F},
+    Rgb{0.130067F, 0.651384F, 0.521608F},
+    Rgb{0.132268F, 0.655014F, 0.519661F},
+    Rgb{0.134692F, 0.658636F, 0.517649F},
+    Rgb{0.137339F, 0.662252F, 0.515571F},
+    Rgb{0.140210F, 0.665859F, 0.513427F},
+    Rgb{0.143303F, 0.669459F, 0.511215F},
+    Rgb{0.146616F, 0.673050F, 0.508936F},
+    Rgb{0.150148F, 0.676631F, 0.506589F},
+    Rgb{0.153894F, 0.680203F, 0.504172F},
+    Rgb{0.157851F, 0.683765F, 0.501686F},
+    Rgb{0.162016F, 0.687316F, 0.499129F},
+    Rgb{0.166383F, 0.690856F, 0.496502F},
+    Rgb{0.170948F, 0.694384F, 0.493803F},
+    Rgb{0.175707F, 0.697900F, 0.491033F},
+    Rgb{0.180653F, 0.701402F, 0.488189F},
+    Rgb{0.185783F, 0.704891F, 0.485273F},
+    Rgb{0.191090F, 0.708366F, 0.482284F},
+    Rgb{0.196571F, 0.711827F, 0.479221F},
+    Rgb{0.202219F, 0.715272F, 0.476084F},
+    Rgb{0.208030F, 0.718701F, 0.472873F},
+    Rgb{0.214000F, 0.722114F, 0.469588F},
+    Rgb{0.220124F, 0.725509F, 0.466226F},
+    Rgb{0.226397F, 0.728888F, 0.462789F},
+    Rgb{0.232815F, 0.732247F, 0.459277F},
+    Rgb{0.239374F, 0.735588F, 0.455688F},
+    Rgb{0.246070F, 0.738910F, 0.452024F},
+    Rgb{0.252899F, 0.742211F, 0.448284F},
+    Rgb{0.259857F, 0.745492F, 0.444467F},
+    Rgb{0.266941F, 0.748751F, 0.440573F},
+    Rgb{0.274149F, 0.751988F, 0.436601F},
+    Rgb{0.281477F, 0.755203F, 0.432552F},
+    Rgb{0.288921F, 0.758394F, 0.428426F},
+    Rgb{0.296479F, 0.761561F, 0.424223F},
+    Rgb{0.304148F, 0.764704F, 0.419943F},
+    Rgb{0.311925F, 0.767822F, 0.415586F},
+    Rgb{0.319809F, 0.770914F, 0.411152F},
+    Rgb{0.327796F, 0.773980F, 0.406640F},
+    Rgb{0.335885F, 0.777018F, 0.402049F},
+    Rgb{0.344074F, 0.780029F, 0.397381F},
+    Rgb{0.352360F, 0.783011F, 0.392636F},
+    Rgb{0.360741F, 0.785964F, 0.387814F},
+    Rgb{0.369214F, 0.788888F, 0.382914F},
+    Rgb{0.377779F, 0.791781F, 0.377939F},
+    Rgb{0.386433F, 0.794644F, 0.372886F},
+    Rgb{0.395174F, 0.797475F, 0.367757F},
+    Rgb{0.404001F, 0.800275F, 0.362552F},
+    Rgb{0.412913F, 0.803041F, 0.357269F},
+    Rgb{0.421908F, 0.805774F, 0.351910F},
+    Rgb{0.430983F, 0.808473F, 0.346476F},
+    Rgb{0.440137F, 0.811138F, 0.340967F},
+    Rgb{0.449368F, 0.813768F, 0.335384F},
+    Rgb{0.458674F, 0.816363F, 0.329727F},
+    Rgb{0.468053F, 0.818921F, 0.323998F},
+    Rgb{0.477504F, 0.821444F, 0.318195F},
+    Rgb{0.487026F, 0.823929F, 0.312321F},
+    Rgb{0.496615F, 0.826376F, 0.306377F},
+    Rgb{0.506271F, 0.828786F, 0.300362F},
+    Rgb{0.515992F, 0.831158F, 0.294279F},
+    Rgb{0.525776F, 0.833491F, 0.288127F},
+    Rgb{0.535621F, 0.835785F, 0.281908F},
+    Rgb{0.545524F, 0.838039F, 0.275626F},
+    Rgb{0.555484F, 0.840254F, 0.269281F},
+    Rgb{0.565498F, 0.842430F, 0.262877F},
+    Rgb{0.575563F, 0.844566F, 0.256415F},
+    Rgb{0.585678F, 0.846661F, 0.249897F},
+    Rgb{0.595839F, 0.848717F, 0.243329F},
+    Rgb{0.606045F, 0.850733F, 0.236712F},
+    Rgb{0.616293F, 0.852709F, 0.230052F},
+    Rgb{0.626579F, 0.854645F, 0.223353F},
+    Rgb{0.636902F, 0.856542F, 0.216620F},
+    Rgb{0.647257F, 0.858400F, 0.209861F},
+    Rgb{0.657642F, 0.860219F, 0.203082F},
+    Rgb{0.668054F, 0.861999F, 0.196293F},
+    Rgb{0.678489F, 0.863742F, 0.189503F},
+    Rgb{0.688944F, 0.865448F, 0.182725F},
+    Rgb{0.699415F, 0.867117F, 0.175971F},
+    Rgb{0.709898F, 0.868751F, 0.169257F},
+    Rgb{0.720391F, 0.870350F, 0.162603F},
+    Rgb{0.730889F, 0.871916F, 0.156029F},
+    Rgb{0.741388F, 0.873449F, 0.149561F},
+    Rgb{0.751884F, 0.874951F, 0.143228F},
+    Rgb{0.762373F, 0.876424F, 0.137064F},
+    Rgb{0.772852F, 0.877868F, 0.131109F},
+    Rgb{0.783315F, 0.879285F, 0.125405F},
+    Rgb{0.793760F, 0.880678F, 0.120005F},
+    Rgb{0.804182F, 0.882046F, 0.114965F},
+    Rgb{0.814576F, 0.883393F, 0.110347F},
+    Rgb{0.824940F, 0.884720F, 0.106217F},
+    Rgb{0.835270F, 0.886029F, 0.102646F},
+    Rgb{0.845561F, 0.887322F, 0.099702F},
+    Rgb{0.855810F, 0.888601F, 0.097452F},
+    Rgb{0.866013F, 0.889868F, 0.095953F},
+    Rgb{0.876168F, 0.891125F, 0.095250F},
+    Rgb{0.886271F, 0.892374F, 0.095374F},
+    Rgb{0.896320F, 0.893616F, 0.096335F},
+    Rgb{0.906311F, 0.894855F, 0.098125F},
+    Rgb{0.916242F, 0.896091F, 0.100717F},
+    Rgb{0.926106F, 0.897330F, 0.104071F},
+    Rgb{0.935904F, 0.898570F, 0.108131F},
+    Rgb{0.945636F, 0.899815F, 0.112838F},
+    Rgb{0.955300F, 0.901065F, 0.118128F},
+    Rgb{0.964894F, 0.902323F, 0.123941F},
+    Rgb{0.974417F, 0.903590F, 0.130215F},
+    Rgb{0.983868F, 0.904867F, 0.136897F},
+    Rgb{0.993248F, 0.906157F, 0.143936F},
+};
+
+constexpr auto g_inferno_data = std::array{
+    Rgb{0.001462F, 0.000466F, 0.003866F},
+    Rgb{0.002267F, 0.000270F, 0.018570F},
+    Rgb{0.003299F, 0.002249F, 0.024239F},
+    Rgb{0.004547F, 0.003392F, 0.030909F},
+    Rgb{0.006006F, 0.004692F, 0.038558F},
+    Rgb{0.007676F, 0.006136F, 0.046836F},
+    Rgb{0.009561F, 0.007713F, 0.055143F},
+    Rgb{0.011663F, 0.009417F, 0.063460F},
+    Rgb{0.013995F, 0.011225F, 0.071862F},
+    Rgb{0.016561F, 0.013136F, 0.080282F},
+    Rgb{0.019373F, 0.015133F, 0.088767F},
+    Rgb{0.022447F, 0.017199F, 0.097327F},
+    Rgb{0.025793F, 0.019331F, 0.105930F},
+    Rgb{0.029432F, 0.021503F, 0.114621F},
+    Rgb{0.033385F, 0.023702F, 0.123397F},
+    Rgb{0.037668F, 0.025921F, 0.132232F},
+    Rgb{0.042253F, 0.028139F, 0.141141F},
+    Rgb{0.046915F, 0.030324F, 0.150164F},
+    Rgb{0.051644F, 0.032474F, 0.159254F},
+    Rgb{0.056449F, 0.034569F, 0.168414F},
+    Rgb{0.061340F, 0.036590F, 0.177642F},
+    Rgb{0.066331F, 0.038504F, 0.186962F},
+    Rgb{0.071429F, 0.040294F, 0.196354F},
+    Rgb{0.076637F, 0.041905F, 0.205799F},
+    Rgb{0.081962F, 0.043328F, 0.215289F},
+    Rgb{0.087411F, 0.044556F, 0.224813F},
+    Rgb{0.092990F, 0.045583F, 0.234358F},
+    Rgb{0.098702F, 0.046402F, 0.243904F},
+    Rgb{0.104551F, 0.047008F, 0.253430F},
+    Rgb{0.110536F, 0.047399F, 0.262912F},
+    Rgb{0.116656F, 0.047574F, 0.272321F},
+    Rgb{0.122908F, 0.047536F, 0.281624F},
+    Rgb{0.129285F, 0.047293F, 0.290788F},
+    Rgb{0.135778F, 0.046856F, 0.299776F},
+    Rgb{0.142378F, 0.046242F, 0.308553F},
+    Rgb{0.149073F, 0.045468F, 0.317085F},
+    Rgb{0.155850F, 0.044559F, 0.325338F},
+    Rgb{0.162689F, 0.043554F, 0.333277F},
+    Rgb{0.169575F, 0.042489F, 0.340874F},
+    Rgb{0.176493F, 0.041402F, 0.348111F},
+    Rgb{0.183429F, 0.040329F, 0.354971F},
+    Rgb{0.190367F, 0.039309F, 0.361447F},
+    Rgb{0.197297F, 0.038400F, 0.367535F},
+    Rgb{0.204209F, 0.037632F, 0.373238F},
+    Rgb{0.211095F, 0.037030F, 0.378563F},
+    Rgb{0.217949F, 0.036615F, 0.383522F},
+    Rgb{0.224763F, 0.036405F, 0.388129F},
+    Rgb{0.231538F, 0.036405F, 0.392400F},
+    Rgb{0.238273F, 0.036621F, 0.396353F},
+    Rgb{0.244967F, 0.037055F, 0.400007F},
+    Rgb{0.251620F, 0.037705F, 0.403378F},
+    Rgb{0.258234F, 0.038571F, 0.406485F},
+    Rgb{0.264810F, 0.039647F, 0.409345F},
+    Rgb{0.271347F, 0.040922F, 0.411976F},
+    Rgb{0.277850F, 0.042353F, 0.414392F},
+    Rgb{0.284321F, 0.043933F, 0.416608F},
+    Rgb{0.290763F, 0.045644F, 0.418637F},
+    Rgb{0.297178F, 0.047470F, 0.420491F},
+    Rgb{0.303568F, 0.049396F, 0.422182F},
+    Rgb{0.309935F, 0.051407F, 0.423721F},
+    Rgb{0.316282F, 0.053490F, 0.425116F},
+    Rgb{0.322610F, 0.055634F, 0.426377F},
+    Rgb{0.328921F, 0.057827F, 0.427511F},
+    Rgb{0.335217F, 0.060060F, 0.428524F},
+    Rgb{0.341500F, 0.062325F, 0.429425F},
+    Rgb{0.347771F, 0.064616F, 0.430217F},
+    Rgb{0.354032F, 0.066925F, 0.430906F},
+    Rgb{0.360284F, 0.069247F, 0.431497F},
+    Rgb{0.366529F, 0.071579F, 0.431994F},
+    Rgb{0.372768F, 0.073915F, 0.432400F},
+    Rgb{0.379001F, 0.076253F, 0.432719F},
+    Rgb{0.385228F, 0.078591F, 0.432955F},
+    Rgb{0.391453F, 0.080927F, 0.433109F},
+    Rgb{0.397674F, 0.083257F, 0.433183F},
+    Rgb{0.403894F, 0.085580F, 0.433179F},
+    Rgb{0.410113F, 0.087896F, 0.433098F},
+    Rgb{0.416331F, 0.090203F, 0.432943F},
+    Rgb{0.422549F, 0.092501F, 0.432714F},
+    Rgb{0.428768F, 0.094790F, 0.432412F},
+    Rgb{0.434987F, 0.097069F, 0.432039F},
+    Rgb{0.441207F, 0.099338F, 0.431594F},
+    Rgb{0.447428F, 0.101597F, 0.431080F},
+    Rgb{0.453651F, 0.103848F, 0.430498F},
+    Rgb{0.459875F, 0.106089F, 0.429846F},
+    Rgb{0.466100F, 0.108322F, 0.429125F},
+    Rgb{0.472328F, 0.110547F, 0.428334F},
+    Rgb{0.478558F, 0.112764F, 0.427475F},
+    Rgb{0.484789F, 0.114974F, 0.426548F},
+    Rgb{0.491022F, 0.117179F, 0.425552F},
+    Rgb{0.497257F, 0.119379F, 0.424488F},
+    Rgb{0.503493F, 0.121575F, 0.423356F},
+    Rgb{0.509730F, 0.123769F, 0.422156F},
+    Rgb{0.515967F, 0.125960F, 0.420887F},
+    Rgb{0.522206F, 0.128150F, 0.419549F},
+    Rgb{0.528444F, 0.130341F, 0.418142F},
+    Rgb{0.534683F, 0.132534F, 0.416667F},
+    Rgb{0.540920F, 0.134729F, 0.415123F},
+    Rgb{0.547157F, 0.136929F, 0.413511F},
+    Rgb{0.553392F, 0.139134F, 0.411829F},
+    Rgb{0.559624F, 0.141346F, 0.410078F},
+    Rgb{0.565854F, 0.143567F, 0.408258F},
+    Rgb{0.572081F, 0.145797F, 0.406369F},
+    Rgb{0.578304F, 0.148039F, 0.404411F},
+    Rgb{0.584521F, 0.150294F, 0.402385F},
+    Rgb{0.590734F, 0.152563F, 0.400290F},
+    Rgb{0.596940F, 0.154848F, 0.398125F},
+    Rgb{0.603139F, 0.157151F, 0.395891F},
+    Rgb{0.609330F, 0.159474F, 0.393589F},
+    Rgb{0.615513F, 0.161817F, 0.391219F},
+    Rgb{0.621685F, 0.164184F, 0.388781F},
+    Rgb{0.627847F, 0.166575F, 0.386276F},
+    Rgb{0.633998F, 0.168992F, 0.383704F},
+    Rgb{0.640135F, 0.171438F, 0.381065F},
+    Rgb{0.646260F, 0.173914F, 0.378359F},
+    Rgb{0.652369F, 0.176421F, 0.375586F},
+    Rgb{0.658463F, 0.178962F, 0.372748F},
+    Rgb{0.664540F, 0.181539F, 0.369846F},
+    Rgb{0.670599F, 0.184153F, 0.366879F},
+    Rgb{0.676638F, 0.186807F, 0.363849F},
+    Rgb{0.682656F, 0.189501F, 0.360757F},
+    Rgb{0.688653F, 0.192239F, 0.357603F},
+    Rgb{0.694627F, 0.195021F, 0.354388F},
+    Rgb{0.700576F, 0.197851F, 0.351113F},
+    Rgb{0.706500F, 0.200728F, 0.347777F},
+    Rgb{0.712396F, 0.203656F, 0.344383F},
+    Rgb{0.718264F, 0.206636F, 0.340931F},
+    Rgb{0.724103F, 0.209670F, 0.337424F},
+    Rgb{0.729909F, 0.212759F, 0.333861F},
+    Rgb{0.735683F, 0.215906F, 0.330245F},
+    Rgb{0.741423F, 0.219112F, 0.326576F},
+    Rgb{0.747127F, 0.222378F, 0.322856F},
+    Rgb{0.752794F, 0.225706F, 0.319085F},
+    Rgb{0.758422F, 0.229097F, 0.315266F},
+    Rgb{0.764010F, 0.232554F, 0.311399F},
+    Rgb{0.769556F, 0.236077F, 0.307485F},
+    Rgb{0.775059F, 0.239667F, 0.303526F},
+    Rgb{0.780517F, 0.243327F, 0.299523F},
+    Rgb{0.785929F, 0.247056F, 0.295477F},
+    Rgb{0.791293F, 0.250856F, 0.291390F},
+    Rgb{0.796607F, 0.254728F, 0.287264F},
+    Rgb{0.801871F, 0.258674F, 0.283099F},
+    Rgb{0.807082F, 0.262692F, 0.278898F},
+    Rgb{0.812239F, 0.266786F, 0.274661F},
+    Rgb{0.817341F, 0.270954F, 0.270390F},
+    Rgb{0.822386F, 0.275197F, 0.266085F},
+    Rgb{0.827372F, 0.279517F, 0.261750F},
+    Rgb{0.832299F, 0.283913F, 0.257383F},
+    Rgb{0.837165F, 0.288385F, 0.252988F},
+    Rgb{0.841969F, 0.292933F, 0.248564F},
+    Rgb{0.846709F, 0.297559F, 0.244113F},
+    Rgb{0.851384F, 0.302260F, 0.239636F},
+    Rgb{0.855992F, 0.307038F, 0.235133F},
+    Rgb{0.860533F, 0.311892F, 0.230606F},
+    Rgb{0.865006F, 0.316822F, 0.226055F},
+    Rgb{0.869409F, 0.321827F, 0.221482F},
+    Rgb{0.873741F, 0.326906F, 0.216886F},
+    Rgb{0.878001F, 0.332060F, 0.212268F},
+    Rgb{0.882188F, 0.337287F, 0.207628F},
+    Rgb{0.886302F, 0.342586F, 0.202968F},
+    Rgb{0.890341F, 0.347957F, 0.198286F},
+    Rgb{0.894305F, 0.353399F, 0.193584F},
+    Rgb{0.898192F, 0.358911F, 0.188860F},
+    Rgb{0.902003F, 0.364492F, 0.184116F},
+    Rgb{0.905735F, 0.370140F, 0.179350F},
+    Rgb{0.909390F, 0.375856F, 0.174563F},
+    Rgb{0.912966F, 0.381636F, 0.169755F},
+    Rgb{0.916462F, 0.387481F, 0.164924F},
+    Rgb{0.919879F, 0.393389F, 0.160070F},
+    Rgb{0.923215F, 0.399359F, 0.155193F},
+    Rgb{0.926470F, 0.405389F, 0.150292F},
+    Rgb{0.929644F, 0.411479F, 0.145367F},
+    Rgb{0.932737F, 0.417627F, 0.140417F},
+    Rgb{0.935747F, 0.423831F, 0.135440F},
+    Rgb{0.938675F, 0.430091F, 0.130438F},
+    Rgb{0.941521F, 0.436405F, 0.125409F},
+    Rgb{0.944285F, 0.442772F, 0.120354F},
+    Rgb{0.946965F, 0.449191F, 0.115272F},
+    Rgb{0.949562F, 0.455660F, 0.110164F},
+    Rgb{0.952075F, 0.462178F, 0.105031F},
+    Rgb{0.954506F, 0.468744F, 0.099874F},
+    Rgb{0.956852F, 0.475356F, 0.094695F},
+    Rgb{0.959114F, 0.482014F, 0.089499F},
+    Rgb{0.961293F, 0.488716F, 0.084289F},
+    Rgb{0.963387F, 0.495462F, 0.079073F},
+    Rgb{0.965397F, 0.502249F, 0.073859F},
+    Rgb{0.967322F, 0.509078F, 0.068659F},
+    Rgb{0.969163F, 0.515946F, 0.063488F},
+    Rgb{0.970919F, 0.522853F, 0.058367F},
+    Rgb{0.972590F, 0.529798F, 0.053324F},
+    Rgb{0.974176F, 0.536780F, 0.048392F},
+    Rgb{0.975677F, 0.543798F, 0.043618F},
+    Rgb{0.977092F, 0.550850F, 0.039050F},
+    Rgb{0.978422F, 0.557937F, 0.034931F},
+    Rgb{0.979666F, 0.565057F, 0.031409F},
+    Rgb{0.980824F, 0.572209F, 0.028508F},
+    Rgb{0.981895F, 0.579392F, 0.026250F},
+    Rgb{0.982881F, 0.586606F, 0.024661F},
+    Rgb{0.983779F, 0.593849F, 0.023770F},
+    Rgb{0.984591F, 0.601122F, 0.023606F},
+    Rgb{0.985315F, 0.608422F, 0.024202F},
+    Rgb{0.985952F, 0.615750F, 0.025592F},
+    Rgb{0.986502F, 0.623105F, 0.027814F},
+    Rgb{0.986964F, 0.630485F, 0.030908F},
+    Rgb{0.987337F, 0.637890F, 0.034916F},
+    Rgb{0.987622F, 0.645320F, 0.039886F},
+    Rgb{0.987819F, 0.652773F, 0.045581F},
+    Rgb{0.987926F, 0.660250F, 0.051750F},
+    Rgb{0.987945F, 0.667748F, 0.058329F},
+    Rgb{0.987874F, 0.675267F, 0.065257F},
+    Rgb{0.987714F, 0.682807F, 0.072489F},
+    Rgb{0.987464F, 0.690366F, 0.079990F},
+    Rgb{0.987124F, 0.697944F, 0.087731F},
+    Rgb{0.986694F, 0.705540F, 0.095694F},
+    Rgb{0.986175F, 0.713153F, 0.103863F},
+    Rgb{0.985566F, 0.720782F, 0.112229F},
+    Rgb{0.984865F, 0.728427F, 0.120785F},
+    Rgb{0.984075F, 0.736087F, 0.129527F},
+    Rgb{0.983196F, 0.743758F, 0.138453F},
+    Rgb{0.982228F, 0.751442F, 0.147565F},
+    Rgb{0.981173F, 0.759135F, 0.156863F},
+    Rgb{0.980032F, 0.766837F, 0.166353F},
+    Rgb{0.978806F, 0.774545F, 0.176037F},
+    Rgb{0.977497F, 0.782258F, 0.185923F},
+    Rgb{0.976108F, 0.789974F, 0.196018F},
+    Rgb{0.974638F, 0.797692F, 0.206332F},
+    Rgb{0.973088F, 0.805409F, 0.216877F},
+    Rgb{0.971468F, 0.813122F, 0.227658F},
+    Rgb{0.969783F, 0.820825F, 0.238686F},
+    Rgb{0.968041F, 0.828515F, 0.249972F},
+    Rgb{0.966243F, 0.836191F, 0.261534F},
+    Rgb{0.964394F, 0.843848F, 0.273391F},
+    Rgb{0.962517F, 0.851476F, 0.285546F},
+    Rgb{0.960626F, 0.859069F, 0.298010F},
+    Rgb{0.958720F, 0.866624F, 0.310820F},
+    Rgb{0.956834F, 0.874129F, 0.323974F},
+    Rgb{0.954997F, 0.881569F, 0.337475F},
+    Rgb{0.953215F, 0.888942F, 0.351369F},
+    Rgb{0.951546F, 0.896226F, 0.365627F},
+    Rgb{0.950018F, 0.903409F, 0.380271F},
+    Rgb{0.948683F, 0.910473F, 0.395289F},
+    Rgb{0.947594F, 0.917399F, 0.410665F},
+    Rgb{0.946809F, 0.924168F, 0.426373F},
+    Rgb{0.946392F, 0.930761F, 0.442367F},
+    Rgb{0.946403F, 0.937159F, 0.458592F},
+    Rgb{0.946903F, 0.943348F, 0.474970F},
+    Rgb{0.947937F, 0.949318F, 0.491426F},
+    Rgb{0.949545F, 0.955063F, 0.507860F},
+    Rgb{0.951740F, 0.960587F, 0.524203F},
+    Rgb{0.954529F, 0.965896F, 0.540361F},
+    Rgb{0.957896F, 0.971003F, 0.556275F},
+    Rgb{0.961812F, 0.975924F, 0.571925F},
+    Rgb{0.966249F, 0.980678F, 0.587206F},
+    Rgb{0.971162F, 0.985282F, 0.602154F},
+    Rgb{0.976511F, 0.989753F, 0.616760F},
+    Rgb{0.982257F, 0.994109F, 0.631017F},
+    Rgb{0.988362F, 0.998364F, 0.644924F},
+};
+
+// Corners of the piecewise linear rainbow: blue, cyan, green, yellow, red.
+constexpr auto g_rainbow_data = std::array{
+    Rgb{0.0F, 0.0F, 1.0F},
+    Rgb{0.0F, 1.0F, 1.0F},
+    Rgb{0.0F, 1.0F, 0.0F},
+    Rgb{1.0F, 1.0F, 0.0F},
+    Rgb{1.0F, 0.0F, 0.0F},
+};
+
+auto lerp(Rgb const &a, Rgb const &b, float t) -> Rgb {
+    return Rgb{
+        .r = a.r + (b.r - a.r) * t,
+        .g = a.g + (b.g - a.g) * t,
+        .b = a.b + (b.b - a.b) * t,
+    };
+}
+
+// Linear interpolation at val in [0, 1], 0 and 1 being the centers of the first and last entry.
+auto sample(std::span<Rgb const> colors, float val) -> Rgb {
+    auto const pos = std::clamp(val, 0.0F, 1.0F) * static_cast<float>(colors.size() - 1);
+    auto const index = std::min(static_cast<std::size_t>(pos), colors.size() - 1);
+    auto const next = std::min(index + 1, colors.size() - 1);
+    return lerp(colors[index], colors[next], pos - static_cast<float>(index));
+}
+
+auto resample(std::string name, std::span<Rgb const> colors) -> colormap::Table {
+    auto table = colormap::Table{.name = std::move(name), .colors = {}, .file = {}};
+    table.colors.reserve(colormap::g_table_size);
+    for (auto i = std::size_t{0}; i < colormap::g_table_size; ++i) {
+        auto const val
+            = static_cast<float>(i) / static_cast<float>(colormap::g_table_size - 1);
+        table.colors.push_back(sample(colors, val));
+    }
+    return table;
+}
+
+}  // namespace
+
+namespace colormap {
+
+auto builtin_tables() -> std::vector<Table> {
+    return {
+        resample("rainbow", g_rainbow_data),
+        resample("inferno", g_inferno_data),
+        resample("viridis", g_viridis_data),
+    };
+}
+
+auto load(std::filesystem::path const &path) -> std::optional<Table> {
+    auto file = std::ifstream{path};
+    if (!file.is_open()) {
+        fmt::println(stderr, "Cannot open color map {}.", path.c_str());
+        return std::nullopt;
+    }
+    auto colors = std::vector<Rgb>{};
+    auto line = std::string{};
+    auto line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        auto fields = std::istringstream{line};
+        auto color = Rgb{};
+        if (!(fields >> color.r >> color.g >> color.b)) {
+            fmt::println(stderr, "{}:{}: expected 'r g b'.", path.c_str(), line_number);
+            return std::nullopt;
+        }
+        colors.push_back(color);
+    }
+    if (colors.size() < 2) {
+        fmt::println(stderr, "{}: a color map needs at least two colors.", path.c_str());
+        return std::nullopt;
+    }
+    auto table = resample(path.stem().string(), colors);
+    auto error = std::error_code{};
+    table.file = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+        table.file = std::filesystem::absolute(path);
+    }
+    return table;
+}
+
+auto find(std::span<Table const> tables, std::string_view name) -> std::optional<std::size_t> {
+    for (auto i = std::size_t{0}; i < tables.size(); ++i) {
+        if (tables[i].file.empty() && tables[i].name == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+auto resolve(std::vector<Table> &tables, std::string_view path_or_name)
+    -> std::optional<std::size_t> {
+    auto const path = std::filesystem::path{path_or_name};
+    auto error = std::error_code{};
+    if (!std::filesystem::exists(path, error)) {
+        auto const index = find(tables, path_or_name);
+        if (!index.has_value()) {
+            fmt::println(stderr, "Unknown color map '{}'.", path_or_name);
+        }
+        return index;
+    }
+    auto const file = std::filesystem::weakly_canonical(path, error);
+    for (auto i = std::size_t{0}; i < tables.size(); ++i) {
+        if (!error && tables[i].file == file) {
+            return i;
+        }
+    }
+    auto table = load(path);
+    if (!table.has_value()) {
+        return std::nullopt;
+    }
+    tables.push_back(std::move(table).value());
+    return tables.size() - 1;
+}
+
+auto get_color(Table const &table, std::uint32_t iterations, std::uint32_t max_iters) -> Rgb {
+    if (iterations == max_iters) {
+        return Rgb{0.0F, 0.0F, 0.0F};
+    }
+    auto const val = static_cast<float>(iterations) / static_cast<float>(max_iters);
+    return sample(table.colors, val);
+}
+
+auto to_rgb32f(std::span<Table const> tables) -> std::vector<float> {
+    auto data = std::vector<float>{};
+    data.reserve(tables.size() * g_table_size * 3U);
+    for (auto const &table : tables) {
+        for (auto const &color : table.colors) {
+            data.insert(data.end(), {color.r, color.g, color.b});
+        }
+    }
+    return data;
+}
+
+auto to_unorm8(float channel) -> std::uint8_t {
+    constexpr auto max = 255.0F;
+    return static_cast<std::uint8_t>(std::lround(std::clamp(channel, 0.0F, 1.0F) * max));
+}
+}  // namespace colormap
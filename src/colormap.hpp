@@ -0,0 +1,60 @@
+#ifndef COLORMAP_HPP
+#define COLORMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace colormap {
+// Entries of every table, the width of the color_tables texture of color.frag.
+inline constexpr auto g_table_size = std::size_t{256};
+
+struct Rgb {
+    float r;
+    float g;
+    float b;
+};
+
+// Lookup table of g_table_size colors, interpolated linearly between evenly spaced entries as
+// a linearly filtered texture is.
+struct Table {
+    std::string name;
+    std::vector<Rgb> colors;
+    // Canonical path of the file the table was loaded from, empty for the builtin tables.
+    std::filesystem::path file;
+};
+
+// rainbow, inferno and viridis, in the order of the color_map uniform of color.frag.
+[[nodiscard]] auto builtin_tables() -> std::vector<Table>;
+
+// Text file with one "r g b" line per entry, channels between 0 and 1; empty lines and lines
+// starting with '#' are skipped. The entries are resampled to g_table_size and the table is
+// named after the file stem.
+[[nodiscard]] auto load(std::filesystem::path const &path) -> std::optional<Table>;
+
+// The builtin table of that name.
+[[nodiscard]] auto find(std::span<Table const> tables, std::string_view name)
+    -> std::optional<std::size_t>;
+
+// The table of the file at path_or_name if one exists there, loaded into tables unless it
+// already is, else the builtin table of that name. Prints why on failure.
+[[nodiscard]] auto resolve(std::vector<Table> &tables, std::string_view path_or_name)
+    -> std::optional<std::size_t>;
+
+// Host version of get_color() in color.frag.
+[[nodiscard]] auto get_color(Table const &table, std::uint32_t iterations, std::uint32_t max_iters)
+    -> Rgb;
+
+// Channels of all the tables one after the other, the layout of the color_tables texture.
+[[nodiscard]] auto to_rgb32f(std::span<Table const> tables) -> std::vector<float>;
+
+// Float channel to 8 bit, rounding like the conversion to a unorm framebuffer.
+[[nodiscard]] auto to_unorm8(float channel) -> std::uint8_t;
+}  // namespace colormap
+
+#endif
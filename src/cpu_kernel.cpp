@@ -0,0 +1,519 @@
+#include "cpu_kernel.hpp"
+
+#include "view.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define CPU_KERNEL_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace {
+
+// Orbits are compared with the value saved at iteration g_first_period_check, then at every
+// power of two: the gap doubles until it is a multiple of the period of the cycle.
+constexpr auto g_first_period_check = std::uint32_t{2};
+
+// Pixels per call of the SIMD pair functions: two vectors of lanes.
+constexpr auto g_avx2_group = std::size_t{16};
+constexpr auto g_avx512_group = std::size_t{32};
+
+template <bool interior_checks>
+auto scalar_row(View const &view,
+                int y,
+                int x_begin,
+                std::uint32_t max_iters,
+                std::span<std::uint32_t> out) -> void {
+    auto const imag = view.imag(y);
+    auto x = x_begin;
+    for (auto &iters : out) {
+        iters = cpu::calc_iters(view.real(x), imag, max_iters, interior_checks);
+        ++x;
+    }
+}
+
+template <bool interior_checks>
+auto scalar_column(View const &view,
+                   int x,
+                   int y_begin,
+                   std::uint32_t max_iters,
+                   std::span<std::uint32_t> out) -> void {
+    auto const real = view.real(x);
+    auto y = y_begin;
+    for (auto &iters : out) {
+        iters = cpu::calc_iters(real, view.imag(y), max_iters, interior_checks);
+        ++y;
+    }
+}
+
+#ifdef CPU_KERNEL_X86
+
+// Both SIMD kernels iterate two registers at once so that the latency of one dependency chain
+// hides behind the other. Lanes that escaped keep iterating (their values may become inf or
+// NaN) but their counters are frozen by the active mask, exactly like the scalar loop exiting.
+// Interior lanes, found by the bulb test or by the cycle check, leave the mask with their
+// counter set to max_iters. Rows share the imaginary part of all lanes, columns the real one.
+
+// Imaginary parts of pixels (x, y_begin + i) for a column group of the SIMD kernels; the ones
+// past the end of the column are computed as well and their counts discarded.
+template <std::size_t group>
+auto column_imag(View const &view, int y_begin) -> std::array<float, group> {
+    auto imag = std::array<float, group>{};
+    for (auto i = std::size_t{0}; i < group; ++i) {
+        imag.at(i) = view.imag(y_begin + static_cast<int>(i));
+    }
+    return imag;
+}
+
+// Lanes of cpu::in_main_bulbs(), same operations in the same order.
+__attribute__((target("avx2"))) auto avx2_in_main_bulbs(__m256 real, __m256 imag) -> __m256 {
+    auto const quarter = _mm256_set1_ps(0.25F);  // NOLINT
+    auto const x = _mm256_sub_ps(real, quarter);
+    auto const imag_sq = _mm256_mul_ps(imag, imag);
+    auto const q = _mm256_add_ps(_mm256_mul_ps(x, x), imag_sq);
+    auto const cardioid = _mm256_cmp_ps(_mm256_mul_ps(q, _mm256_add_ps(q, x)),
+                                        _mm256_mul_ps(quarter, imag_sq),
+                                        _CMP_LE_OQ);
+    auto const x1 = _mm256_add_ps(real, _mm256_set1_ps(1.0F));
+    auto const bulb = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(x1, x1), imag_sq),
+                                    _mm256_set1_ps(0.0625F),  // NOLINT
+                                    _CMP_LE_OQ);
+    return _mm256_or_ps(cardioid, bulb);
+}
+
+__attribute__((target("avx2"))) auto avx2_real(View const &view, int x) -> __m256 {
+    auto const lanes = _mm256_setr_ps(0.0F, 1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F, 7.0F);  // NOLINT
+    auto const frag_x = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lanes),
+                                      _mm256_set1_ps(0.5F));  // NOLINT
+    auto const norm = _mm256_sub_ps(
+        _mm256_div_ps(frag_x, _mm256_set1_ps(static_cast<float>(view.width))),
+        _mm256_set1_ps(View::s_anchor_x));
+    return _mm256_mul_ps(
+        _mm256_add_ps(_mm256_mul_ps(norm, _mm256_set1_ps(view.zoom)),
+                      _mm256_set1_ps(view.x_offset)),
+        _mm256_set1_ps(View::s_scale));
+}
+
+template <bool interior_checks>
+__attribute__((target("avx2"))) auto avx2_pair(__m256 cr0,
+                                               __m256 ci0,
+                                               __m256 cr1,
+                                               __m256 ci1,
+                                               std::uint32_t max_iters,
+                                               std::uint32_t *out) -> void {
+    constexpr auto lanes = 8;
+    auto const threshold = _mm256_set1_ps(View::s_threshold);
+    auto zr0 = cr0;
+    auto zi0 = ci0;
+    auto zr1 = cr1;
+    auto zi1 = ci1;
+    auto active0 = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    auto active1 = active0;
+    auto count0 = _mm256_setzero_si256();
+    auto count1 = _mm256_setzero_si256();
+    auto const max_count = _mm256_set1_epi32(static_cast<int>(max_iters));
+    auto saved_r0 = zr0;
+    auto saved_i0 = zi0;
+    auto saved_r1 = zr1;
+    auto saved_i1 = zi1;
+    auto next_save = g_first_period_check;
+    if constexpr (interior_checks) {
+        auto const inside0 = avx2_in_main_bulbs(cr0, ci0);
+        auto const inside1 = avx2_in_main_bulbs(cr1, ci1);
+        count0 = _mm256_blendv_epi8(count0, max_count, _mm256_castps_si256(inside0));
+        count1 = _mm256_blendv_epi8(count1, max_count, _mm256_castps_si256(inside1));
+        active0 = _mm256_andnot_ps(inside0, active0);
+        active1 = _mm256_andnot_ps(inside1, active1);
+    }
+    for (auto it = std::uint32_t{0}; it < max_iters; ++it) {
+        auto const zr0_sq = _mm256_mul_ps(zr0, zr0);
+        auto const zi0_sq = _mm256_mul_ps(zi0, zi0);
+        auto const zr1_sq = _mm256_mul_ps(zr1, zr1);
+        auto const zi1_sq = _mm256_mul_ps(zi1, zi1);
+        active0 = _mm256_and_ps(
+            active0, _mm256_cmp_ps(_mm256_add_ps(zr0_sq, zi0_sq), threshold, _CMP_LE_OQ));
+        active1 = _mm256_and_ps(
+            active1, _mm256_cmp_ps(_mm256_add_ps(zr1_sq, zi1_sq), threshold, _CMP_LE_OQ));
+        if (_mm256_movemask_ps(_mm256_or_ps(active0, active1)) == 0) {
+            break;
+        }
+        // Active lanes are all ones, i.e. -1: subtracting the mask increments their counters.
+        count0 = _mm256_sub_epi32(count0, _mm256_castps_si256(active0));
+        count1 = _mm256_sub_epi32(count1, _mm256_castps_si256(active1));
+        auto const zri0 = _mm256_mul_ps(zr0, zi0);
+        auto const zri1 = _mm256_mul_ps(zr1, zi1);
+        zr0 = _mm256_add_ps(_mm256_sub_ps(zr0_sq, zi0_sq), cr0);
+        zi0 = _mm256_add_ps(_mm256_add_ps(zri0, zri0), ci0);
+        zr1 = _mm256_add_ps(_mm256_sub_ps(zr1_sq, zi1_sq), cr1);
+        zi1 = _mm256_add_ps(_mm256_add_ps(zri1, zri1), ci1);
+        if constexpr (interior_checks) {
+            auto const cycle0 = _mm256_and_ps(
+                active0,
+                _mm256_and_ps(_mm256_cmp_ps(zr0, saved_r0, _CMP_EQ_OQ),
+                              _mm256_cmp_ps(zi0, saved_i0, _CMP_EQ_OQ)));
+            auto const cycle1 = _mm256_and_ps(
+                active1,
+                _mm256_and_ps(_mm256_cmp_ps(zr1, saved_r1, _CMP_EQ_OQ),
+                              _mm256_cmp_ps(zi1, saved_i1, _CMP_EQ_OQ)));
+            count0 = _mm256_blendv_epi8(count0, max_count, _mm256_castps_si256(cycle0));
+            count1 = _mm256_blendv_epi8(count1, max_count, _mm256_castps_si256(cycle1));
+            active0 = _mm256_andnot_ps(cycle0, active0);
+            active1 = _mm256_andnot_ps(cycle1, active1);
+            if (it + 1 == next_save) {
+                saved_r0 = zr0;
+                saved_i0 = zi0;
+                saved_r1 = zr1;
+                saved_i1 = zi1;
+                next_save *= 2;
+            }
+        }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), count0);          // NOLINT
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + lanes), count1);  // NOLINT
+}
+
+template <bool interior_checks>
+__attribute__((target("avx2"))) auto avx2_row(View const &view,
+                                              int y,
+                                              int x_begin,
+                                              std::uint32_t max_iters,
+                                              std::span<std::uint32_t> out) -> void {
+    constexpr auto group = g_avx2_group;
+    constexpr auto lanes = static_cast<int>(group / 2);
+    auto const ci = _mm256_set1_ps(view.imag(y));
+    auto tail = std::array<std::uint32_t, group>{};
+    for (auto i = std::size_t{0}; i < out.size(); i += group) {
+        auto const x = x_begin + static_cast<int>(i);
+        // The extra lanes of a partial group compute pixels past the end of the span and
+        // are discarded.
+        auto const whole = i + group <= out.size();
+        auto *counts = whole ? &out[i] : tail.data();
+        avx2_pair<interior_checks>(
+            avx2_real(view, x), ci, avx2_real(view, x + lanes), ci, max_iters, counts);
+        if (!whole) {
+            std::copy_n(tail.begin(), out.size() - i, out.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+    }
+}
+
+template <bool interior_checks>
+__attribute__((target("avx2"))) auto avx2_column(View const &view,
+                                                 int x,
+                                                 int y_begin,
+                                                 std::uint32_t max_iters,
+                                                 std::span<std::uint32_t> out) -> void {
+    constexpr auto group = g_avx2_group;
+    auto const cr = _mm256_set1_ps(view.real(x));
+    auto counts = std::array<std::uint32_t, group>{};
+    for (auto i = std::size_t{0}; i < out.size(); i += group) {
+        auto const imag = column_imag<group>(view, y_begin + static_cast<int>(i));
+        avx2_pair<interior_checks>(cr,
+                                   _mm256_loadu_ps(imag.data()),
+                                   cr,
+                                   _mm256_loadu_ps(&imag[group / 2]),
+                                   max_iters,
+                                   counts.data());
+        std::copy_n(counts.begin(),
+                    std::min(group, out.size() - i),
+                    out.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+__attribute__((target("avx512f"))) auto avx512_real(View const &view, int x) -> __m512 {
+    auto const lanes = _mm512_setr_ps(0.0F,  // NOLINT
+                                      1.0F,
+                                      2.0F,
+                                      3.0F,
+                                      4.0F,
+                                      5.0F,
+                                      6.0F,
+                                      7.0F,
+                                      8.0F,
+                                      9.0F,
+                                      10.0F,
+                                      11.0F,
+                                      12.0F,
+                                      13.0F,
+                                      14.0F,
+                                      15.0F);
+    auto const frag_x = _mm512_add_ps(_mm512_add_ps(_mm512_set1_ps(static_cast<float>(x)), lanes),
+                                      _mm512_set1_ps(0.5F));  // NOLINT
+    auto const norm = _mm512_sub_ps(
+        _mm512_div_ps(frag_x, _mm512_set1_ps(static_cast<float>(view.width))),
+        _mm512_set1_ps(View::s_anchor_x));
+    return _mm512_mul_ps(
+        _mm512_add_ps(_mm512_mul_ps(norm, _mm512_set1_ps(view.zoom)),
+                      _mm512_set1_ps(view.x_offset)),
+        _mm512_set1_ps(View::s_scale));
+}
+
+__attribute__((target("avx512f"))) auto avx512_in_main_bulbs(__m512 real, __m512 imag)
+    -> __mmask16 {
+    auto const quarter = _mm512_set1_ps(0.25F);  // NOLINT
+    auto const x = _mm512_sub_ps(real, quarter);
+    auto const imag_sq = _mm512_mul_ps(imag, imag);
+    auto const q = _mm512_add_ps(_mm512_mul_ps(x, x), imag_sq);
+    auto const cardioid = _mm512_cmp_ps_mask(_mm512_mul_ps(q, _mm512_add_ps(q, x)),
+                                             _mm512_mul_ps(quarter, imag_sq),
+                                             _CMP_LE_OQ);
+    auto const x1 = _mm512_add_ps(real, _mm512_set1_ps(1.0F));
+    auto const bulb = _mm512_cmp_ps_mask(_mm512_add_ps(_mm512_mul_ps(x1, x1), imag_sq),
+                                         _mm512_set1_ps(0.0625F),  // NOLINT
+                                         _CMP_LE_OQ);
+    return static_cast<__mmask16>(cardioid | bulb);
+}
+
+template <bool interior_checks>
+__attribute__((target("avx512f"))) auto avx512_pair(__m512 cr0,
+                                                    __m512 ci0,
+                                                    __m512 cr1,
+                                                    __m512 ci1,
+                                                    std::uint32_t max_iters,
+                                                    std::uint32_t *out) -> void {
+    constexpr auto lanes = 16;
+    auto const threshold = _mm512_set1_ps(View::s_threshold);
+    auto const one = _mm512_set1_epi32(1);
+    auto zr0 = cr0;
+    auto zi0 = ci0;
+    auto zr1 = cr1;
+    auto zi1 = ci1;
+    auto active0 = static_cast<__mmask16>(0xFFFFU);  // NOLINT
+    auto active1 = active0;
+    auto count0 = _mm512_setzero_si512();
+    auto count1 = _mm512_setzero_si512();
+    auto const max_count = _mm512_set1_epi32(static_cast<int>(max_iters));
+    auto saved_r0 = zr0;
+    auto saved_i0 = zi0;
+    auto saved_r1 = zr1;
+    auto saved_i1 = zi1;
+    auto next_save = g_first_period_check;
+    if constexpr (interior_checks) {
+        auto const inside0 = avx512_in_main_bulbs(cr0, ci0);
+        auto const inside1 = avx512_in_main_bulbs(cr1, ci1);
+        count0 = _mm512_mask_mov_epi32(count0, inside0, max_count);
+        count1 = _mm512_mask_mov_epi32(count1, inside1, max_count);
+        active0 = static_cast<__mmask16>(active0 & ~inside0);
+        active1 = static_cast<__mmask16>(active1 & ~inside1);
+    }
+    for (auto it = std::uint32_t{0}; it < max_iters; ++it) {
+        auto const zr0_sq = _mm512_mul_ps(zr0, zr0);
+        auto const zi0_sq = _mm512_mul_ps(zi0, zi0);
+        auto const zr1_sq = _mm512_mul_ps(zr1, zr1);
+        auto const zi1_sq = _mm512_mul_ps(zi1, zi1);
+        active0 = _mm512_mask_cmp_ps_mask(
+            active0, _mm512_add_ps(zr0_sq, zi0_sq), threshold, _CMP_LE_OQ);
+        active1 = _mm512_mask_cmp_ps_mask(
+            active1, _mm512_add_ps(zr1_sq, zi1_sq), threshold, _CMP_LE_OQ);
+        if ((active0 | active1) == 0) {
+            break;
+        }
+        count0 = _mm512_mask_add_epi32(count0, active0, count0, one);
+        count1 = _mm512_mask_add_epi32(count1, active1, count1, one);
+        auto const zri0 = _mm512_mul_ps(zr0, zi0);
+        auto const zri1 = _mm512_mul_ps(zr1, zi1);
+        zr0 = _mm512_add_ps(_mm512_sub_ps(zr0_sq, zi0_sq), cr0);
+        zi0 = _mm512_add_ps(_mm512_add_ps(zri0, zri0), ci0);
+        zr1 = _mm512_add_ps(_mm512_sub_ps(zr1_sq, zi1_sq), cr1);
+        zi1 = _mm512_add_ps(_mm512_add_ps(zri1, zri1), ci1);
+        if constexpr (interior_checks) {
+            auto const cycle0 = _mm512_mask_cmp_ps_mask(
+                _mm512_mask_cmp_ps_mask(active0, zr0, saved_r0, _CMP_EQ_OQ),
+                zi0,
+                saved_i0,
+                _CMP_EQ_OQ);
+            auto const cycle1 = _mm512_mask_cmp_ps_mask(
+                _mm512_mask_cmp_ps_mask(active1, zr1, saved_r1, _CMP_EQ_OQ),
+                zi1,
+                saved_i1,
+                _CMP_EQ_OQ);
+            count0 = _mm512_mask_mov_epi32(count0, cycle0, max_count);
+            count1 = _mm512_mask_mov_epi32(count1, cycle1, max_count);
+            active0 = static_cast<__mmask16>(active0 & ~cycle0);
+            active1 = static_cast<__mmask16>(active1 & ~cycle1);
+            if (it + 1 == next_save) {
+                saved_r0 = zr0;
+                saved_i0 = zi0;
+                saved_r1 = zr1;
+                saved_i1 = zi1;
+                next_save *= 2;
+            }
+        }
+    }
+    _mm512_storeu_si512(out, count0);
+    _mm512_storeu_si512(out + lanes, count1);  // NOLINT
+}
+
+template <bool interior_checks>
+__attribute__((target("avx512f"))) auto avx512_row(View const &view,
+                                                   int y,
+                                                   int x_begin,
+                                                   std::uint32_t max_iters,
+                                                   std::span<std::uint32_t> out) -> void {
+    constexpr auto group = g_avx512_group;
+    constexpr auto lanes = static_cast<int>(group / 2);
+    auto const ci = _mm512_set1_ps(view.imag(y));
+    auto tail = std::array<std::uint32_t, group>{};
+    for (auto i = std::size_t{0}; i < out.size(); i += group) {
+        auto const x = x_begin + static_cast<int>(i);
+        auto const whole = i + group <= out.size();
+        auto *counts = whole ? &out[i] : tail.data();
+        avx512_pair<interior_checks>(
+            avx512_real(view, x), ci, avx512_real(view, x + lanes), ci, max_iters, counts);
+        if (!whole) {
+            std::copy_n(tail.begin(), out.size() - i, out.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+    }
+}
+
+template <bool interior_checks>
+__attribute__((target("avx512f"))) auto avx512_column(View const &view,
+                                                      int x,
+                                                      int y_begin,
+                                                      std::uint32_t max_iters,
+                                                      std::span<std::uint32_t> out) -> void {
+    constexpr auto group = g_avx512_group;
+    auto const cr = _mm512_set1_ps(view.real(x));
+    auto counts = std::array<std::uint32_t, group>{};
+    for (auto i = std::size_t{0}; i < out.size(); i += group) {
+        auto const imag = column_imag<group>(view, y_begin + static_cast<int>(i));
+        avx512_pair<interior_checks>(cr,
+                                     _mm512_loadu_ps(imag.data()),
+                                     cr,
+                                     _mm512_loadu_ps(&imag[group / 2]),
+                                     max_iters,
+                                     counts.data());
+        std::copy_n(counts.begin(),
+                    std::min(group, out.size() - i),
+                    out.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+#endif
+
+}  // namespace
+
+namespace cpu {
+
+auto detect_isa() -> Isa {
+#ifdef CPU_KERNEL_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+#endif
+    return Isa::SCALAR;
+}
+
+auto is_supported(Isa isa) -> bool {
+    switch (isa) {
+    case Isa::SCALAR:
+        return true;
+    case Isa::AVX2:
+        return detect_isa() != Isa::SCALAR;
+    case Isa::AVX512:
+        return detect_isa() == Isa::AVX512;
+    }
+    return false;
+}
+
+auto isa_name(Isa isa) -> std::string_view {
+    switch (isa) {
+    case Isa::SCALAR:
+        return "scalar";
+    case Isa::AVX2:
+        return "avx2";
+    case Isa::AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+auto group_width(Isa isa) -> int {
+    switch (isa) {
+    case Isa::SCALAR:
+        return 1;
+    case Isa::AVX2:
+        return static_cast<int>(g_avx2_group);
+    case Isa::AVX512:
+        return static_cast<int>(g_avx512_group);
+    }
+    return 1;
+}
+
+auto row_kernel(Isa isa, bool interior_checks) -> RowKernel {
+    assert(is_supported(isa));
+#ifdef CPU_KERNEL_X86
+    switch (isa) {
+    case Isa::SCALAR:
+        return interior_checks ? scalar_row<true> : scalar_row<false>;
+    case Isa::AVX2:
+        return interior_checks ? avx2_row<true> : avx2_row<false>;
+    case Isa::AVX512:
+        return interior_checks ? avx512_row<true> : avx512_row<false>;
+    }
+#endif
+    return interior_checks ? scalar_row<true> : scalar_row<false>;
+}
+
+auto column_kernel(Isa isa, bool interior_checks) -> ColumnKernel {
+    assert(is_supported(isa));
+#ifdef CPU_KERNEL_X86
+    switch (isa) {
+    case Isa::SCALAR:
+        return interior_checks ? scalar_column<true> : scalar_column<false>;
+    case Isa::AVX2:
+        return interior_checks ? avx2_column<true> : avx2_column<false>;
+    case Isa::AVX512:
+        return interior_checks ? avx512_column<true> : avx512_column<false>;
+    }
+#endif
+    return interior_checks ? scalar_column<true> : scalar_column<false>;
+}
+
+auto in_main_bulbs(float real, float imag) -> bool {
+    // Cardioid: q (q + x - 1/4) <= y^2 / 4 with q = (x - 1/4)^2 + y^2; bulb: |c + 1| <= 1/4.
+    auto const x = real - 0.25F;  // NOLINT
+    auto const imag_sq = imag * imag;
+    auto const q = x * x + imag_sq;
+    auto const x1 = real + 1.0F;
+    return q * (q + x) <= 0.25F * imag_sq || x1 * x1 + imag_sq <= 0.0625F;  // NOLINT
+}
+
+auto calc_iters(float real, float imag, std::uint32_t max_iters, bool interior_checks)
+    -> std::uint32_t {
+    if (interior_checks && in_main_bulbs(real, imag)) {
+        return max_iters;
+    }
+    auto const ref_real = real;
+    auto const ref_imag = imag;
+    auto saved_real = real;
+    auto saved_imag = imag;
+    auto next_save = g_first_period_check;
+    auto iterations = std::uint32_t{0};
+    while (iterations < max_iters && real * real + imag * imag <= View::s_threshold) {
+        auto const temp = real * real - imag * imag + ref_real;
+        imag = 2.0F * real * imag + ref_imag;
+        real = temp;
+        ++iterations;
+        if (interior_checks) {
+            if (real == saved_real && imag == saved_imag) {
+                return max_iters;
+            }
+            if (iterations == next_save) {
+                saved_real = real;
+                saved_imag = imag;
+                next_save *= 2;
+            }
+        }
+    }
+    return iterations;
+}
+}  // namespace cpu
@@ -0,0 +1,51 @@
+#ifndef CPU_KERNEL_HPP
+#define CPU_KERNEL_HPP
+
+#include "view.hpp"
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace cpu {
+enum class Isa {
+    SCALAR,
+    AVX2,
+    AVX512,
+};
+
+// Writes the calc_iters() result of pixels [x_begin, x_begin + out.size()) of row y into out.
+using RowKernel = void (*)(View const &view,
+                           int y,
+                           int x_begin,
+                           std::uint32_t max_iters,
+                           std::span<std::uint32_t> out);
+
+// Same for pixels (x, y_begin + i) of column x, written to out[i].
+using ColumnKernel = void (*)(View const &view,
+                              int x,
+                              int y_begin,
+                              std::uint32_t max_iters,
+                              std::span<std::uint32_t> out);
+
+// Widest instruction set the running CPU supports.
+[[nodiscard]] auto detect_isa() -> Isa;
+[[nodiscard]] auto is_supported(Isa isa) -> bool;
+[[nodiscard]] auto isa_name(Isa isa) -> std::string_view;
+// Pixels a kernel computes together: a shorter span costs as much as a whole group.
+[[nodiscard]] auto group_width(Isa isa) -> int;
+
+// All kernels return identical counts; only their speed differs. With interior_checks, points
+// of the main cardioid and of the period-2 bulb return max_iters without iterating, and so do
+// orbits that come back exactly to a previous value (Brent's cycle detection): iterating is
+// deterministic, so such an orbit never escapes and the counts stay identical.
+[[nodiscard]] auto row_kernel(Isa isa, bool interior_checks) -> RowKernel;
+[[nodiscard]] auto column_kernel(Isa isa, bool interior_checks) -> ColumnKernel;
+
+// Closed-form membership test of the main cardioid and of the period-2 bulb.
+[[nodiscard]] auto in_main_bulbs(float real, float imag) -> bool;
+
+[[nodiscard]] auto calc_iters(float real, float imag, std::uint32_t max_iters, bool interior_checks)
+    -> std::uint32_t;
+}  // namespace cpu
+
+#endif
@@ -0,0 +1,571 @@
+#include "cpu_renderer.hpp"
+
+#include "antialias.hpp"
+#include "cpu_kernel.hpp"
+#include "perturbation.hpp"
+#include "tile_scheduler.hpp"
+#include "view.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// new[x, y] = old[x - dx, y - dy], leaving the exposed pixels untouched.
+auto shift_frame(std::span<std::uint32_t> frame, int width, int height, int dx, int dy) -> void {
+    auto const stride = static_cast<std::size_t>(width);
+    auto const x_begin = static_cast<std::size_t>(std::max(dx, 0));
+    auto const count = static_cast<std::size_t>(width - std::abs(dx));
+    auto const move_row = [&](int y) {
+        auto *dst = frame.data() + static_cast<std::size_t>(y) * stride + x_begin;
+        auto const *src = frame.data() + static_cast<std::size_t>(y - dy) * stride
+                        + static_cast<std::size_t>(std::max(-dx, 0));
+        std::memmove(dst, src, count * sizeof(std::uint32_t));
+    };
+    // Rows are moved away from the direction of the shift, so no source is overwritten before
+    // it is read.
+    if (dy > 0) {
+        for (auto y = height - 1; y >= dy; --y) {
+            move_row(y);
+        }
+    } else {
+        for (auto y = 0; y < height + dy; ++y) {
+            move_row(y);
+        }
+    }
+}
+
+// Rectangles up to this size per side are iterated whole rather than split again, or up to a
+// kernel group wide inside: a narrower span costs as much to iterate.
+constexpr auto g_min_subdivision = 6;
+
+using cpu::Tile;
+
+// A frame, or the area of one in out, being filled in subdivide mode.
+struct Canvas {
+    std::span<std::uint32_t> out;
+    Tile area;
+    std::size_t stride;
+    std::uint32_t max_iters;
+    std::optional<std::pair<double, double>> origin;
+    int leaf_side;
+
+    [[nodiscard]] auto index(int x, int y) const -> std::size_t {
+        return (static_cast<std::size_t>(y - area.y) * stride)
+             + static_cast<std::size_t>(x - area.x);
+    }
+
+    [[nodiscard]] auto at(int x, int y) const -> std::uint32_t & {
+        return out[index(x, y)];
+    }
+
+    [[nodiscard]] auto span(int x, int y, int w) const -> std::span<std::uint32_t> {
+        return out.subspan(index(x, y), static_cast<std::size_t>(w));
+    }
+
+    // The count shared by the whole border of r, if any.
+    [[nodiscard]] auto uniform_border(Tile const &r) const -> std::optional<std::uint32_t> {
+        auto const value = at(r.x, r.y);
+        auto const top = r.y + r.height - 1;
+        auto const right = r.x + r.width - 1;
+        for (auto x = r.x; x <= right; ++x) {
+            if (at(x, r.y) != value || at(x, top) != value) {
+                return std::nullopt;
+            }
+        }
+        for (auto y = r.y + 1; y < top; ++y) {
+            if (at(r.x, y) != value || at(right, y) != value) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    // A uniform escaping border around c = 0 surrounds the whole set rather than a flat band.
+    [[nodiscard]] auto may_fill(Tile const &r, std::uint32_t value) const -> bool {
+        if (value == max_iters || !origin.has_value()) {
+            return true;
+        }
+        auto const [x, y] = origin.value();
+        return x < r.x || x > r.x + r.width - 1 || y < r.y || y > r.y + r.height - 1;
+    }
+};
+
+// Column pixels go through a contiguous buffer, one chunk at a time.
+template <typename ColumnFn>
+auto compute_column(Canvas const &canvas, ColumnFn const &column, int x, int y_begin, int y_end)
+    -> void {
+    constexpr auto chunk = 64;
+    auto counts = std::array<std::uint32_t, chunk>{};
+    for (auto y = y_begin; y < y_end; y += chunk) {
+        auto const n = std::min(chunk, y_end - y);
+        column(x, y, std::span{counts}.first(static_cast<std::size_t>(n)));
+        for (auto i = 0; i < n; ++i) {
+            canvas.at(x, y + i) = counts.at(static_cast<std::size_t>(i));
+        }
+    }
+}
+
+// Fills the inside of r, whose border is already computed. Returns the pixels filled without
+// iterating.
+template <typename RowFn, typename ColumnFn>
+auto subdivide(Canvas const &canvas, RowFn const &row, ColumnFn const &column, Tile const &r)
+    -> std::size_t {
+    auto const inner_width = r.width - 2;
+    auto const inner_height = r.height - 2;
+    if (inner_width <= 0 || inner_height <= 0) {
+        return 0;
+    }
+    auto const value = canvas.uniform_border(r);
+    if (value.has_value() && canvas.may_fill(r, value.value())) {
+        for (auto y = r.y + 1; y < r.y + r.height - 1; ++y) {
+            std::ranges::fill(canvas.span(r.x + 1, y, inner_width), value.value());
+        }
+        return static_cast<std::size_t>(inner_width) * static_cast<std::size_t>(inner_height);
+    }
+    if (std::max(r.width, r.height) <= canvas.leaf_side) {
+        for (auto y = r.y + 1; y < r.y + r.height - 1; ++y) {
+            row(y, r.x + 1, canvas.span(r.x + 1, y, inner_width));
+        }
+        return 0;
+    }
+    // Split the longer side; the dividing line becomes a border of both halves.
+    if (r.width >= r.height) {
+        auto const mid = r.x + r.width / 2;
+        compute_column(canvas, column, mid, r.y + 1, r.y + r.height - 1);
+        return subdivide(canvas, row, column, Tile{r.x, r.y, mid - r.x + 1, r.height})
+             + subdivide(canvas, row, column, Tile{mid, r.y, r.x + r.width - mid, r.height});
+    }
+    auto const mid = r.y + r.height / 2;
+    row(mid, r.x + 1, canvas.span(r.x + 1, mid, inner_width));
+    return subdivide(canvas, row, column, Tile{r.x, r.y, r.width, mid - r.y + 1})
+         + subdivide(canvas, row, column, Tile{r.x, mid, r.width, r.y + r.height - mid});
+}
+
+template <typename RowFn, typename ColumnFn>
+auto subdivide_tile(Canvas const &canvas,
+                    RowFn const &row,
+                    ColumnFn const &column,
+                    Tile const &tile) -> std::size_t {
+    auto const top = tile.y + tile.height - 1;
+    row(tile.y, tile.x, canvas.span(tile.x, tile.y, tile.width));
+    if (top > tile.y) {
+        row(top, tile.x, canvas.span(tile.x, top, tile.width));
+    }
+    compute_column(canvas, column, tile.x, tile.y + 1, top);
+    if (tile.width > 1) {
+        compute_column(canvas, column, tile.x + tile.width - 1, tile.y + 1, top);
+    }
+    return subdivide(canvas, row, column, tile);
+}
+
+// Pixel coordinates of c = 0, inverting View::real() and View::imag().
+auto origin_pixel(View const &view) -> std::pair<double, double> {
+    auto const x = (-static_cast<double>(view.x_offset) / view.zoom + View::s_anchor_x)
+                 * view.width;
+    auto const y = (-static_cast<double>(view.y_offset) / view.zoom + View::s_anchor_y)
+                 * view.height;
+    return {x - 0.5, y - 0.5};  // NOLINT
+}
+
+// Consecutive edge pixels of a row: samples.pixels[first, first + count).
+struct Run {
+    std::size_t first;
+    std::size_t count;
+};
+
+// Runs of at most g_max_run pixels, so that long edges are still shared by the threads.
+constexpr auto g_max_run = std::size_t{32};
+// Runs per scheduler job.
+constexpr auto g_runs_per_job = 16;
+
+auto find_runs(std::span<std::size_t const> pixels, int width) -> std::vector<Run> {
+    auto runs = std::vector<Run>{};
+    auto const w = static_cast<std::size_t>(width);
+    for (auto i = std::size_t{0}; i < pixels.size(); ++i) {
+        auto const pixel = pixels[i];
+        if (!runs.empty()) {
+            auto &last = runs.back();
+            auto const next = pixels[last.first] + last.count;
+            if (pixel == next && pixel % w != 0 && last.count < g_max_run) {
+                ++last.count;
+                continue;
+            }
+        }
+        runs.push_back(Run{.first = i, .count = 1});
+    }
+    return runs;
+}
+
+auto whole(int width, int height) -> Tile {
+    return Tile{.x = 0, .y = 0, .width = width, .height = height};
+}
+
+}  // namespace
+
+namespace cpu {
+
+Renderer::Renderer(Options const &options)
+    : m_tile_size{options.tile_size}
+    , m_isa{options.isa}
+    , m_interior_checks{options.interior_checks}
+    , m_subdivide{options.subdivide}
+    , m_kernel{row_kernel(options.isa, options.interior_checks)}
+    , m_column_kernel{column_kernel(options.isa, options.interior_checks)}
+    , m_scheduler{options.threads} {
+    assert(m_tile_size > 0);
+}
+
+auto Renderer::thread_count() const -> unsigned {
+    return m_scheduler.thread_count();
+}
+
+auto Renderer::tile_size() const -> int {
+    return m_tile_size;
+}
+
+auto Renderer::isa() const -> Isa {
+    return m_isa;
+}
+
+auto Renderer::set_interior_checks(bool interior_checks) -> void {
+    m_interior_checks = interior_checks;
+    m_kernel = row_kernel(m_isa, interior_checks);
+    m_column_kernel = column_kernel(m_isa, interior_checks);
+}
+
+auto Renderer::update_tiles(int width, int height) -> void {
+    if (width == m_tiles_width && height == m_tiles_height) {
+        return;
+    }
+    m_tiles = make_tiles(width, height, m_tile_size);
+    m_tiles_width = width;
+    m_tiles_height = height;
+}
+
+auto Renderer::pan_tiles(int width, int height, int dx, int dy, std::span<std::uint32_t> out)
+    -> std::span<Tile const> {
+    update_tiles(width, height);
+    if (std::abs(dx) >= width || std::abs(dy) >= height) {
+        return m_tiles;
+    }
+    shift_frame(out, width, height, dx, dy);
+    m_pan_tiles.clear();
+    // The exposed columns over the whole height, then the exposed rows next to them.
+    make_tiles(Tile{.x = dx > 0 ? 0 : width + dx, .y = 0, .width = std::abs(dx), .height = height},
+               m_tile_size,
+               m_pan_tiles);
+    make_tiles(Tile{
+                   .x = std::max(dx, 0),
+                   .y = dy > 0 ? 0 : height + dy,
+                   .width = width - std::abs(dx),
+                   .height = std::abs(dy),
+               },
+               m_tile_size,
+               m_pan_tiles);
+    return m_pan_tiles;
+}
+
+template <typename RowFn, typename ColumnFn>
+auto Renderer::run_rows(Tile const &area,
+                        std::span<Tile const> tiles,
+                        std::span<std::uint32_t> out,
+                        std::uint32_t max_iters,
+                        int group,
+                        std::optional<std::pair<double, double>> const &origin,
+                        RowFn const &row,
+                        ColumnFn const &column) -> SchedulerStats {
+    assert(out.size()
+           == static_cast<std::size_t>(area.width) * static_cast<std::size_t>(area.height));
+    auto const stride = static_cast<std::size_t>(area.width);
+    if (m_subdivide) {
+        auto const canvas = Canvas{
+            .out = out,
+            .area = area,
+            .stride = stride,
+            .max_iters = max_iters,
+            .origin = origin,
+            .leaf_side = std::max(g_min_subdivision, group + 2),
+        };
+        auto skipped = std::atomic<std::size_t>{0};
+        auto stats = m_scheduler.run(tiles, [&](Tile const &tile) {
+            skipped.fetch_add(subdivide_tile(canvas, row, column, tile), std::memory_order_relaxed);
+        });
+        stats.skipped_pixels = skipped.load();
+        return stats;
+    }
+    return m_scheduler.run(tiles, [&](Tile const &tile) {
+        for (auto y = tile.y; y < tile.y + tile.height; ++y) {
+            auto const first = (static_cast<std::size_t>(y - area.y) * stride)
+                             + static_cast<std::size_t>(tile.x - area.x);
+            row(y, tile.x, out.subspan(first, static_cast<std::size_t>(tile.width)));
+        }
+    });
+}
+
+auto Renderer::render(View const &view, std::uint32_t max_iters, std::span<std::uint32_t> out)
+    -> SchedulerStats {
+    update_tiles(view.width, view.height);
+    return run_rows(whole(view.width, view.height),
+                    m_tiles,
+                    out,
+                    max_iters,
+                    group_width(m_isa),
+                    origin_pixel(view),
+                    [&](int y, int x, std::span<std::uint32_t> span) {
+                        m_kernel(view, y, x, max_iters, span);
+                    },
+                    [&](int x, int y, std::span<std::uint32_t> span) {
+                        m_column_kernel(view, x, y, max_iters, span);
+                    });
+}
+
+auto Renderer::render(deep::Camera const &camera,
+                      deep::ReferenceOrbit const &orbit,
+                      std::uint32_t max_iters,
+                      std::span<std::uint32_t> out) -> SchedulerStats {
+    update_tiles(camera.width, camera.height);
+    return run_rows(whole(camera.width, camera.height),
+                    m_tiles,
+                    out,
+                    max_iters,
+                    1,
+                    std::nullopt,
+                    [&](int y, int x, std::span<std::uint32_t> span) {
+                        deep::render_row(
+                            camera, orbit, y, x, max_iters, m_interior_checks, span);
+                    },
+                    [&](int x, int y, std::span<std::uint32_t> span) {
+                        deep::render_column(
+                            camera, orbit, x, y, max_iters, m_interior_checks, span);
+                    });
+}
+
+auto Renderer::render_panned(View const &view,
+                             int dx,
+                             int dy,
+                             std::uint32_t max_iters,
+                             std::span<std::uint32_t> out) -> SchedulerStats {
+    auto const tiles = pan_tiles(view.width, view.height, dx, dy, out);
+    return run_rows(whole(view.width, view.height),
+                    tiles,
+                    out,
+                    max_iters,
+                    group_width(m_isa),
+                    origin_pixel(view),
+                    [&](int y, int x, std::span<std::uint32_t> span) {
+                        m_kernel(view, y, x, max_iters, span);
+                    },
+                    [&](int x, int y, std::span<std::uint32_t> span) {
+                        m_column_kernel(view, x, y, max_iters, span);
+                    });
+}
+
+auto Renderer::render_panned(deep::Camera const &camera,
+                             deep::ReferenceOrbit const &orbit,
+                             int dx,
+                             int dy,
+                             std::uint32_t max_iters,
+                             std::span<std::uint32_t> out) -> SchedulerStats {
+    auto const tiles = pan_tiles(camera.width, camera.height, dx, dy, out);
+    return run_rows(whole(camera.width, camera.height),
+                    tiles,
+                    out,
+                    max_iters,
+                    1,
+                    std::nullopt,
+                    [&](int y, int x, std::span<std::uint32_t> span) {
+                        deep::render_row(
+                            camera, orbit, y, x, max_iters, m_interior_checks, span);
+                    },
+                    [&](int x, int y, std::span<std::uint32_t> span) {
+                        deep::render_column(
+                            camera, orbit, x, y, max_iters, m_interior_checks, span);
+                    });
+}
+
+auto Renderer::render_area(View const &view,
+                           Tile const &area,
+                           std::uint32_t max_iters,
+                           std::span<std::uint32_t> out) -> SchedulerStats {
+    m_area_tiles.clear();
+    make_tiles(area, m_tile_size, m_area_tiles);
+    return run_rows(area,
+                    m_area_tiles,
+                    out,
+                    max_iters,
+                    group_width(m_isa),
+                    origin_pixel(view),
+                    [&](int y, int x, std::span<std::uint32_t> span) {
+                        m_kernel(view, y, x, max_iters, span);
+                    },
+                    [&](int x, int y, std::span<std::uint32_t> span) {
+                        m_column_kernel(view, x, y, max_iters, span);
+                    });
+}
+
+auto Renderer::render_area(deep::Camera const &camera,
+                           deep::ReferenceOrbit const &orbit,
+                           Tile const &area,
+                           std::uint32_t max_iters,
+                           std::span<std::uint32_t> out) -> SchedulerStats {
+    m_area_tiles.clear();
+    make_tiles(area, m_tile_size, m_area_tiles);
+    return run_rows(area,
+                    m_area_tiles,
+                    out,
+                    max_iters,
+                    1,
+                    std::nullopt,
+                    [&](int y, int x, std::span<std::uint32_t> span) {
+                        deep::render_row(
+                            camera, orbit, y, x, max_iters, m_interior_checks, span);
+                    },
+                    [&](int x, int y, std::span<std::uint32_t> span) {
+                        deep::render_column(
+                            camera, orbit, x, y, max_iters, m_interior_checks, span);
+                    });
+}
+
+template <typename RowFn>
+auto Renderer::run_samples(int width,
+                           aa::Samples &samples,
+                           std::span<int const> grid_rows,
+                           RowFn const &row) -> SchedulerStats {
+    auto const side = static_cast<std::size_t>(samples.side);
+    auto const per_pixel = samples.per_pixel();
+    auto const w = static_cast<std::size_t>(width);
+    samples.counts.resize(samples.pixels.size() * per_pixel);
+    auto const runs = find_runs(samples.pixels, width);
+    // The scheduler deals tiles: tile.x is the first run of a job, tile.width their number.
+    auto jobs = std::vector<Tile>{};
+    for (auto first = std::size_t{0}; first < runs.size(); first += g_runs_per_job) {
+        jobs.push_back(Tile{
+            .x = static_cast<int>(first),
+            .y = 0,
+            .width = static_cast<int>(std::min<std::size_t>(g_runs_per_job, runs.size() - first)),
+            .height = 1,
+        });
+    }
+    return m_scheduler.run(jobs, [&](Tile const &job) {
+        auto row_counts = std::vector<std::uint32_t>(g_max_run * side);
+        auto const end = static_cast<std::size_t>(job.x) + static_cast<std::size_t>(job.width);
+        for (auto r = static_cast<std::size_t>(job.x); r < end; ++r) {
+            auto const &run = runs[r];
+            auto const pixel = samples.pixels[run.first];
+            auto const x = static_cast<int>((pixel % w) * side);
+            auto const y = static_cast<int>((pixel / w) * side);
+            auto const counts = std::span{row_counts}.first(run.count * side);
+            for (auto const grid_row : grid_rows) {
+                auto const j = static_cast<std::size_t>(grid_row);
+                row(y + grid_row, x, counts);
+                for (auto i = std::size_t{0}; i < run.count; ++i) {
+                    std::ranges::copy(counts.subspan(i * side, side),
+                                      samples.counts.begin()
+                                          + static_cast<std::ptrdiff_t>(
+                                              (run.first + i) * per_pixel + j * side));
+                }
+            }
+        }
+    });
+}
+
+template <typename RowFn>
+auto Renderer::run_adaptive(int width,
+                            std::uint32_t max_iters,
+                            float threshold,
+                            aa::Samples &samples,
+                            RowFn const &row) -> SchedulerStats {
+    auto const side = samples.side;
+    auto outer_rows = std::vector<int>{0};
+    auto inner_rows = std::vector<int>{};
+    for (auto j = 1; j < side; ++j) {
+        (j == side - 1 ? outer_rows : inner_rows).push_back(j);
+    }
+    auto stats = run_samples(width, samples, outer_rows, row);
+    if (inner_rows.empty()) {
+        return stats;
+    }
+
+    auto const per_pixel = samples.per_pixel();
+    auto const cells = static_cast<std::size_t>(side);
+    auto const last_row = (cells - 1) * cells;
+    auto const outer_counts = [&](std::size_t i, std::vector<std::uint32_t> &out) {
+        auto const counts = std::span{samples.counts}.subspan(i * per_pixel, per_pixel);
+        out.assign(counts.begin(), counts.begin() + static_cast<std::ptrdiff_t>(cells));
+        out.insert(out.end(),
+                   counts.begin() + static_cast<std::ptrdiff_t>(last_row),
+                   counts.end());
+    };
+    auto inner = aa::Samples{.side = side, .pixels = {}, .counts = {}};
+    auto outer = std::vector<std::uint32_t>{};
+    for (auto i = std::size_t{0}; i < samples.pixels.size(); ++i) {
+        outer_counts(i, outer);
+        if (aa::disagree(outer, max_iters, threshold)) {
+            inner.pixels.push_back(samples.pixels[i]);
+        }
+    }
+    stats.wall += run_samples(width, inner, inner_rows, row).wall;
+
+    // Both lists are ascending. The pixels whose outer rows agree repeat the nearest of them.
+    auto next_inner = std::size_t{0};
+    for (auto i = std::size_t{0}; i < samples.pixels.size(); ++i) {
+        auto const out = std::span{samples.counts}.subspan(i * per_pixel, per_pixel);
+        auto const refined
+            = next_inner < inner.pixels.size() && inner.pixels[next_inner] == samples.pixels[i];
+        for (auto const grid_row : inner_rows) {
+            auto const j = static_cast<std::size_t>(grid_row);
+            auto const source
+                = refined ? std::span{inner.counts}.subspan(next_inner * per_pixel + j * cells,
+                                                            cells)
+                          : out.subspan(2 * j < cells ? 0 : last_row, cells);
+            std::ranges::copy(source, out.begin() + static_cast<std::ptrdiff_t>(j * cells));
+        }
+        next_inner += refined ? 1 : 0;
+    }
+    return stats;
+}
+
+auto Renderer::render_samples(View const &view,
+                              std::uint32_t max_iters,
+                              aa::Samples &samples,
+                              float threshold) -> SchedulerStats {
+    auto samples_view = view;
+    samples_view.width *= samples.side;
+    samples_view.height *= samples.side;
+    return run_adaptive(view.width,
+                        max_iters,
+                        threshold,
+                        samples,
+                        [&](int y, int x, std::span<std::uint32_t> span) {
+                            m_kernel(samples_view, y, x, max_iters, span);
+                        });
+}
+
+auto Renderer::render_samples(deep::Camera const &camera,
+                              deep::ReferenceOrbit const &orbit,
+                              std::uint32_t max_iters,
+                              aa::Samples &samples,
+                              float threshold) -> SchedulerStats {
+    auto samples_camera = camera;
+    samples_camera.width *= samples.side;
+    samples_camera.height *= samples.side;
+    return run_adaptive(
+        camera.width,
+        max_iters,
+        threshold,
+        samples,
+        [&](int y, int x, std::span<std::uint32_t> span) {
+            deep::render_row(samples_camera, orbit, y, x, max_iters, m_interior_checks, span);
+        });
+}
+}  // namespace cpu
@@ -0,0 +1,148 @@
+#ifndef CPU_RENDERER_HPP
+#define CPU_RENDERER_HPP
+
+#include "antialias.hpp"
+#include "cpu_kernel.hpp"
+#include "perturbation.hpp"
+#include "tile_scheduler.hpp"
+#include "view.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cpu {
+// Fills iteration buffers for any View, spreading tiles over a work-stealing TileScheduler.
+class Renderer {
+public:
+    inline static constexpr auto s_default_tile_size = 64;
+
+    struct Options {
+        // 0 means one thread per hardware thread.
+        unsigned threads{0};
+        // Multiples of 32 keep every SIMD lane group of a tile row busy.
+        int tile_size{s_default_tile_size};
+        Isa isa{detect_isa()};
+        // Bulb test and cycle check of row_kernel(); off only to measure what they save.
+        bool interior_checks{true};
+        // Mariani-Silver: within a tile, only the borders of rectangles are iterated. A
+        // rectangle whose border has a single count is filled with it (the set is connected, so
+        // nothing else can hide inside), any other is split in two.
+        bool subdivide{false};
+    };
+
+    explicit Renderer(Options const &options);
+
+    // out holds view.width * view.height counts, bottom row first like glReadPixels.
+    auto render(View const &view, std::uint32_t max_iters, std::span<std::uint32_t> out)
+        -> SchedulerStats;
+
+    // Deep zoom: the orbit must have been computed for this camera and iteration limit.
+    auto render(deep::Camera const &camera,
+                deep::ReferenceOrbit const &orbit,
+                std::uint32_t max_iters,
+                std::span<std::uint32_t> out) -> SchedulerStats;
+
+    // Panning: out holds the frame of a view whose content shows up dx, dy pixels further in
+    // this one (new[x, y] = old[x - dx, y - dy]). Shifts it in place and computes only the newly
+    // exposed strips, falling back to a full frame when nothing is left to reuse.
+    auto render_panned(View const &view,
+                       int dx,
+                       int dy,
+                       std::uint32_t max_iters,
+                       std::span<std::uint32_t> out) -> SchedulerStats;
+    auto render_panned(deep::Camera const &camera,
+                       deep::ReferenceOrbit const &orbit,
+                       int dx,
+                       int dy,
+                       std::uint32_t max_iters,
+                       std::span<std::uint32_t> out) -> SchedulerStats;
+
+    // A rectangle of the frame of a view (e.g. one share of a distributed image): out holds
+    // area.width * area.height counts, bottom row first. The counts are the ones of the same
+    // pixels in a whole frame.
+    auto render_area(View const &view,
+                     Tile const &area,
+                     std::uint32_t max_iters,
+                     std::span<std::uint32_t> out) -> SchedulerStats;
+    auto render_area(deep::Camera const &camera,
+                     deep::ReferenceOrbit const &orbit,
+                     Tile const &area,
+                     std::uint32_t max_iters,
+                     std::span<std::uint32_t> out) -> SchedulerStats;
+
+    [[nodiscard]] auto thread_count() const -> unsigned;
+    // Adaptive supersampling: fills samples.counts for the samples.pixels of the frame of view
+    // (aa::Samples), computing runs of neighboring pixels of a row together. The rows between
+    // the first and last of a grid are only computed where those disagree for threshold, and
+    // repeat the nearest of them elsewhere.
+    auto render_samples(View const &view,
+                        std::uint32_t max_iters,
+                        aa::Samples &samples,
+                        float threshold = aa::g_edge_threshold) -> SchedulerStats;
+    auto render_samples(deep::Camera const &camera,
+                        deep::ReferenceOrbit const &orbit,
+                        std::uint32_t max_iters,
+                        aa::Samples &samples,
+                        float threshold = aa::g_edge_threshold) -> SchedulerStats;
+
+    [[nodiscard]] auto tile_size() const -> int;
+    [[nodiscard]] auto isa() const -> Isa;
+    // Options::interior_checks of the next renders, keeping the threads.
+    auto set_interior_checks(bool interior_checks) -> void;
+
+private:
+    auto update_tiles(int width, int height) -> void;
+    // Shifts out and returns the tiles left to compute.
+    [[nodiscard]] auto pan_tiles(int width,
+                                 int height,
+                                 int dx,
+                                 int dy,
+                                 std::span<std::uint32_t> out) -> std::span<Tile const>;
+
+    // Calls row(y, x_begin, out_span) for every row of the tiles, which lie within area of the
+    // frame, out holding the area. In subdivide mode only the rectangle borders are computed,
+    // the vertical sides through column(x, y_begin, counts). group is the group_width() of the
+    // kernels, origin the position of c = 0 in pixels if the frame may enclose the whole set.
+    template <typename RowFn, typename ColumnFn>
+    auto run_rows(Tile const &area,
+                  std::span<Tile const> tiles,
+                  std::span<std::uint32_t> out,
+                  std::uint32_t max_iters,
+                  int group,
+                  std::optional<std::pair<double, double>> const &origin,
+                  RowFn const &row,
+                  ColumnFn const &column) -> SchedulerStats;
+
+    // Calls row(y, x_begin, out_span) for the grid_rows of the sample grids, in the frame
+    // samples.side times larger, and scatters the counts into samples.
+    template <typename RowFn>
+    auto run_samples(int width,
+                     aa::Samples &samples,
+                     std::span<int const> grid_rows,
+                     RowFn const &row) -> SchedulerStats;
+    // The first and last rows of every grid, then the rows between only where those disagree.
+    template <typename RowFn>
+    auto run_adaptive(int width,
+                      std::uint32_t max_iters,
+                      float threshold,
+                      aa::Samples &samples,
+                      RowFn const &row) -> SchedulerStats;
+
+    int m_tile_size;
+    Isa m_isa;
+    bool m_interior_checks;
+    bool m_subdivide;
+    RowKernel m_kernel;
+    ColumnKernel m_column_kernel;
+    int m_tiles_width{0};
+    int m_tiles_height{0};
+    std::vector<Tile> m_tiles;
+    std::vector<Tile> m_pan_tiles;
+    std::vector<Tile> m_area_tiles;
+    TileScheduler m_scheduler;
+};
+}  // namespace cpu
+
+#endif
@@ -0,0 +1,267 @@
+#include "fixed.hpp"
+
+#include "fmt/format.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+__extension__ using Wide = unsigned __int128;
+
+constexpr auto g_limb_bits = 64;
+
+// Limbs past a number's precision are always zero, so the magnitude helpers can work on
+// n = max(precisions) limbs of either operand.
+
+[[nodiscard]] auto compare_mag(auto const &a, auto const &b, std::size_t n) -> int {
+    for (auto i = std::size_t{0}; i < n; ++i) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+auto add_mag(auto &dst, auto const &a, auto const &b, std::size_t n) -> void {
+    auto carry = std::uint64_t{0};
+    for (auto i = n; i-- > 0;) {
+        auto const sum = Wide{a[i]} + b[i] + carry;
+        dst[i] = static_cast<std::uint64_t>(sum);
+        carry = static_cast<std::uint64_t>(sum >> g_limb_bits);
+    }
+}
+
+// Requires |a| >= |b|.
+auto sub_mag(auto &dst, auto const &a, auto const &b, std::size_t n) -> void {
+    auto borrow = std::uint64_t{0};
+    for (auto i = n; i-- > 0;) {
+        auto const rhs = Wide{b[i]} + borrow;
+        borrow = Wide{a[i]} < rhs ? 1U : 0U;
+        dst[i] = static_cast<std::uint64_t>(Wide{a[i]} - rhs);
+    }
+}
+
+}  // namespace
+
+namespace mp {
+
+auto Fixed::from_double(double value, std::size_t limbs) -> Fixed {
+    assert(std::isfinite(value) && limbs > 0 && limbs <= s_max_limbs);
+    auto result = Fixed{};
+    result.m_limbs = limbs;
+    result.m_negative = value < 0.0;
+    auto frac = std::abs(value);
+    auto const integer = std::floor(frac);
+    result.m_mag[0] = static_cast<std::uint64_t>(integer);
+    frac -= integer;
+    for (auto i = std::size_t{1}; i < limbs && frac != 0.0; ++i) {
+        frac = std::ldexp(frac, g_limb_bits);
+        auto const limb = std::floor(frac);
+        result.m_mag.at(i) = static_cast<std::uint64_t>(limb);
+        frac -= limb;
+    }
+    if (result.is_zero()) {
+        result.m_negative = false;
+    }
+    return result;
+}
+
+auto Fixed::parse(std::string_view str, std::size_t limbs) -> std::optional<Fixed> {
+    assert(limbs > 0 && limbs <= s_max_limbs);
+    auto result = Fixed{};
+    result.m_limbs = limbs;
+    if (!str.empty() && (str.front() == '-' || str.front() == '+')) {
+        result.m_negative = str.front() == '-';
+        str.remove_prefix(1);
+    }
+    auto const dot = str.find('.');
+    auto const int_digits = str.substr(0, dot);
+    auto const frac_digits = dot == std::string_view::npos ? std::string_view{}
+                                                           : str.substr(dot + 1);
+    if (int_digits.empty() && frac_digits.empty()) {
+        return std::nullopt;
+    }
+    if (!std::ranges::all_of(frac_digits, [](char c) { return c >= '0' && c <= '9'; })) {
+        return std::nullopt;
+    }
+    auto integer = std::uint64_t{0};
+    if (!int_digits.empty()) {
+        auto const [end, ec]
+            = std::from_chars(int_digits.data(), int_digits.data() + int_digits.size(), integer);
+        if (ec != std::errc{} || end != int_digits.data() + int_digits.size()) {
+            return std::nullopt;
+        }
+    }
+    // Horner scheme from the last digit: frac = (digit + frac) / 10.
+    constexpr auto base = std::uint64_t{10};
+    for (auto it = frac_digits.rbegin(); it != frac_digits.rend(); ++it) {
+        result.m_mag[0] = static_cast<std::uint64_t>(*it - '0');
+        auto rem = std::uint64_t{0};
+        for (auto i = std::size_t{0}; i < limbs; ++i) {
+            auto const cur = (Wide{rem} << g_limb_bits) | result.m_mag.at(i);
+            result.m_mag.at(i) = static_cast<std::uint64_t>(cur / base);
+            rem = static_cast<std::uint64_t>(cur % base);
+        }
+    }
+    result.m_mag[0] = integer;
+    if (result.is_zero()) {
+        result.m_negative = false;
+    }
+    return result;
+}
+
+auto Fixed::limbs_for_bits(int bits) -> std::size_t {
+    auto const frac_limbs = (std::max(bits, 1) + g_limb_bits - 1) / g_limb_bits;
+    return std::min(static_cast<std::size_t>(frac_limbs) + 1U, s_max_limbs);
+}
+
+auto Fixed::to_double() const -> double {
+    auto value = 0.0;
+    for (auto i = std::min(m_limbs, std::size_t{3}); i-- > 0;) {
+        auto const exponent = -g_limb_bits * static_cast<int>(i);
+        value += std::ldexp(static_cast<double>(m_mag.at(i)), exponent);
+    }
+    return m_negative ? -value : value;
+}
+
+auto Fixed::to_string(std::size_t digits) const -> std::string {
+    constexpr auto base = std::uint64_t{10};
+    auto frac = m_mag;
+    auto integer = frac[0];
+    frac[0] = 0;
+    // One digit more than requested, for rounding.
+    auto text = std::string{};
+    for (auto d = std::size_t{0}; d <= digits; ++d) {
+        auto carry = std::uint64_t{0};
+        for (auto i = m_limbs; i-- > 1;) {
+            auto const cur = Wide{frac.at(i)} * base + carry;
+            frac.at(i) = static_cast<std::uint64_t>(cur);
+            carry = static_cast<std::uint64_t>(cur >> g_limb_bits);
+        }
+        text.push_back(static_cast<char>('0' + carry));
+    }
+    auto round_up = text.back() >= '5';
+    text.pop_back();
+    for (auto it = text.rbegin(); round_up && it != text.rend(); ++it) {
+        round_up = *it == '9';
+        *it = round_up ? '0' : static_cast<char>(*it + 1);
+    }
+    if (round_up) {
+        ++integer;
+    }
+    while (!text.empty() && text.back() == '0') {
+        text.pop_back();
+    }
+    auto const negative = m_negative && (integer != 0 || !text.empty());
+    auto result = fmt::format("{}{}", negative ? "-" : "", integer);
+    if (!text.empty()) {
+        result += '.';
+        result += text;
+    }
+    return result;
+}
+
+auto Fixed::limbs() const -> std::size_t {
+    return m_limbs;
+}
+
+auto Fixed::with_limbs(std::size_t limbs) const -> Fixed {
+    assert(limbs > 0 && limbs <= s_max_limbs);
+    auto result = *this;
+    std::fill(result.m_mag.begin() + static_cast<std::ptrdiff_t>(std::min(limbs, m_limbs)),
+              result.m_mag.end(),
+              0U);
+    result.m_limbs = limbs;
+    if (result.is_zero()) {
+        result.m_negative = false;
+    }
+    return result;
+}
+
+auto Fixed::is_zero() const -> bool {
+    auto const end = m_mag.begin() + static_cast<std::ptrdiff_t>(m_limbs);
+    return std::all_of(m_mag.begin(), end, [](auto limb) { return limb == 0; });
+}
+
+auto Fixed::add_signed(Fixed const &a, Fixed const &b, bool negate_b) -> Fixed {
+    auto const n = std::max(a.m_limbs, b.m_limbs);
+    auto const b_negative = b.m_negative != negate_b;
+    auto result = Fixed{};
+    result.m_limbs = n;
+    if (a.m_negative == b_negative) {
+        add_mag(result.m_mag, a.m_mag, b.m_mag, n);
+        result.m_negative = a.m_negative;
+    } else if (compare_mag(a.m_mag, b.m_mag, n) >= 0) {
+        sub_mag(result.m_mag, a.m_mag, b.m_mag, n);
+        result.m_negative = a.m_negative;
+    } else {
+        sub_mag(result.m_mag, b.m_mag, a.m_mag, n);
+        result.m_negative = b_negative;
+    }
+    if (result.is_zero()) {
+        result.m_negative = false;
+    }
+    return result;
+}
+
+auto operator+(Fixed const &a, Fixed const &b) -> Fixed {
+    return Fixed::add_signed(a, b, false);
+}
+
+auto operator-(Fixed const &a, Fixed const &b) -> Fixed {
+    return Fixed::add_signed(a, b, true);
+}
+
+auto operator*(Fixed const &a, Fixed const &b) -> Fixed {
+    auto const n = std::max(a.m_limbs, b.m_limbs);
+    // Schoolbook product on little-endian copies: index 0 is the least significant limb.
+    auto lhs = Fixed::Limbs{};
+    auto rhs = Fixed::Limbs{};
+    for (auto i = std::size_t{0}; i < n; ++i) {
+        lhs.at(i) = a.m_mag.at(n - 1 - i);
+        rhs.at(i) = b.m_mag.at(n - 1 - i);
+    }
+    auto product = std::array<std::uint64_t, 2 * Fixed::s_max_limbs>{};
+    for (auto i = std::size_t{0}; i < n; ++i) {
+        auto carry = std::uint64_t{0};
+        for (auto j = std::size_t{0}; j < n; ++j) {
+            auto const cur = Wide{lhs.at(i)} * rhs.at(j) + product.at(i + j) + carry;
+            product.at(i + j) = static_cast<std::uint64_t>(cur);
+            carry = static_cast<std::uint64_t>(cur >> g_limb_bits);
+        }
+        product.at(i + n) = carry;
+    }
+    // Both factors carry n - 1 fractional limbs, the product 2n - 2: drop the lowest n - 1.
+    auto result = Fixed{};
+    result.m_limbs = n;
+    for (auto i = std::size_t{0}; i < n; ++i) {
+        result.m_mag.at(i) = product.at(2 * n - 2 - i);
+    }
+    result.m_negative = a.m_negative != b.m_negative && !result.is_zero();
+    return result;
+}
+
+auto Fixed::operator+=(Fixed const &other) -> Fixed & {
+    *this = *this + other;
+    return *this;
+}
+
+auto Fixed::operator-=(Fixed const &other) -> Fixed & {
+    *this = *this - other;
+    return *this;
+}
+
+auto Fixed::operator-() const -> Fixed {
+    auto result = *this;
+    result.m_negative = !m_negative && !is_zero();
+    return result;
+}
+}  // namespace mp
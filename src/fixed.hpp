@@ -0,0 +1,60 @@
+#ifndef FIXED_HPP
+#define FIXED_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace mp {
+// Signed fixed-point number: one 64 bit integer limb followed by up to s_max_limbs - 1
+// fractional limbs, most significant first. The precision (number of limbs) is chosen at
+// runtime; mixing precisions yields the larger one. Precision is enough for the camera of a
+// deep zoom and for the reference orbit, which only ever holds values of magnitude below 8.
+class Fixed {
+public:
+    inline static constexpr auto s_max_limbs = std::size_t{16};
+
+    // Zero at the maximum precision.
+    Fixed() = default;
+
+    [[nodiscard]] static auto from_double(double value, std::size_t limbs = s_max_limbs)
+        -> Fixed;
+
+    // Plain decimal notation, e.g. "-0.743643887037158704752191506114774".
+    [[nodiscard]] static auto parse(std::string_view str, std::size_t limbs = s_max_limbs)
+        -> std::optional<Fixed>;
+
+    // Smallest precision that resolves 2^-bits.
+    [[nodiscard]] static auto limbs_for_bits(int bits) -> std::size_t;
+
+    [[nodiscard]] auto to_double() const -> double;
+    // Decimal notation rounded to at most `digits` fractional digits.
+    [[nodiscard]] auto to_string(std::size_t digits) const -> std::string;
+
+    [[nodiscard]] auto limbs() const -> std::size_t;
+    [[nodiscard]] auto with_limbs(std::size_t limbs) const -> Fixed;
+
+    friend auto operator+(Fixed const &a, Fixed const &b) -> Fixed;
+    friend auto operator-(Fixed const &a, Fixed const &b) -> Fixed;
+    friend auto operator*(Fixed const &a, Fixed const &b) -> Fixed;
+
+    auto operator+=(Fixed const &other) -> Fixed &;
+    auto operator-=(Fixed const &other) -> Fixed &;
+    [[nodiscard]] auto operator-() const -> Fixed;
+
+private:
+    using Limbs = std::array<std::uint64_t, s_max_limbs>;
+
+    [[nodiscard]] auto is_zero() const -> bool;
+    [[nodiscard]] static auto add_signed(Fixed const &a, Fixed const &b, bool negate_b) -> Fixed;
+
+    bool m_negative{false};
+    std::size_t m_limbs{s_max_limbs};
+    Limbs m_mag{};
+};
+}  // namespace mp
+
+#endif
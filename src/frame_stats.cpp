@@ -0,0 +1,133 @@
+#include "frame_stats.hpp"
+
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Frames waiting for their GPU time beyond this have lost it.
+constexpr auto g_max_pending = std::size_t{8};
+
+constexpr auto g_percentile = 0.99;
+
+constexpr auto g_series_names = std::array<std::string_view, stats::g_series_count>{
+    "gpu",
+    "cpu",
+    "input",
+    "swap",
+};
+
+}  // namespace
+
+namespace stats {
+
+auto Rolling::push(double value) -> void {
+    if (m_values.size() < s_window) {
+        m_values.push_back(value);
+        return;
+    }
+    m_values.at(m_next) = value;
+    m_next = (m_next + 1) % s_window;
+}
+
+auto Rolling::summary() const -> std::optional<Summary> {
+    if (m_values.empty()) {
+        return std::nullopt;
+    }
+    auto sorted = m_values;
+    auto const rank = std::min(
+        static_cast<std::size_t>(g_percentile * static_cast<double>(sorted.size())),
+        sorted.size() - 1);
+    auto const p99 = sorted.begin() + static_cast<std::ptrdiff_t>(rank);
+    std::ranges::nth_element(sorted, p99);
+    return Summary{
+        .min = std::ranges::min(m_values),
+        .avg = std::accumulate(m_values.begin(), m_values.end(), 0.0)
+             / static_cast<double>(m_values.size()),
+        .p99 = *p99,
+    };
+}
+
+FrameStats::~FrameStats() {
+    for (auto const &pending : m_pending) {
+        record(pending, std::nullopt);
+    }
+}
+
+auto FrameStats::open_csv(std::filesystem::path const &path) -> bool {
+    m_csv.open(path);
+    if (!m_csv.is_open()) {
+        fmt::println(stderr, "Cannot open {} for writing.", path.c_str());
+        return false;
+    }
+    m_csv << "frame,gpu_ms,cpu_ms,input_ms,swap_ms\n";
+    return true;
+}
+
+auto FrameStats::add_cpu(std::uint64_t frame, CpuTimes const &times) -> void {
+    m_pending.push_back(Pending{.frame = frame, .times = times});
+    if (m_pending.size() > g_max_pending) {
+        record(m_pending.front(), std::nullopt);
+        m_pending.pop_front();
+    }
+}
+
+auto FrameStats::add_gpu(std::uint64_t frame, double ms) -> void {
+    // Results come in frame order: older frames still waiting lost theirs.
+    while (!m_pending.empty() && m_pending.front().frame <= frame) {
+        auto const pending = m_pending.front();
+        m_pending.pop_front();
+        record(pending, pending.frame == frame ? std::optional{ms} : std::nullopt);
+    }
+}
+
+auto FrameStats::summary(Series series) const -> std::optional<Summary> {
+    return m_series.at(std::to_underlying(series)).summary();
+}
+
+auto FrameStats::format() const -> std::string {
+    auto line = std::string{};
+    for (auto i = std::size_t{0}; i < g_series_count; ++i) {
+        auto const summary = m_series.at(i).summary();
+        if (summary.has_value()) {
+            line += fmt::format("{} {:.2f}/{:.2f}/{:.2f}  ",
+                                g_series_names.at(i),
+                                summary->min,
+                                summary->avg,
+                                summary->p99);
+        } else {
+            line += fmt::format("{} -  ", g_series_names.at(i));
+        }
+    }
+    return line + "ms (min/avg/p99)";
+}
+
+auto FrameStats::record(Pending const &pending, std::optional<double> gpu_ms) -> void {
+    if (gpu_ms.has_value()) {
+        m_series.at(std::to_underlying(Series::GPU)).push(gpu_ms.value());
+    }
+    m_series.at(std::to_underlying(Series::CPU)).push(pending.times.frame);
+    m_series.at(std::to_underlying(Series::INPUT)).push(pending.times.input);
+    m_series.at(std::to_underlying(Series::SWAP)).push(pending.times.swap);
+    if (m_csv.is_open()) {
+        m_csv << fmt::format("{},{},{:.4f},{:.4f},{:.4f}\n",
+                             pending.frame,
+                             gpu_ms.has_value() ? fmt::format("{:.4f}", gpu_ms.value()) : "",
+                             pending.times.frame,
+                             pending.times.input,
+                             pending.times.swap);
+    }
+}
+}  // namespace stats
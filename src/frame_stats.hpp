@@ -0,0 +1,89 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Rolling statistics of frame times, to spot regressions and compare drivers.
+namespace stats {
+enum class Series : std::size_t {
+    // GL_TIME_ELAPSED of the draws of the frame.
+    GPU,
+    // From the start of the frame to the swap: input, GL submission and host work.
+    CPU,
+    INPUT,
+    // Time blocked in the buffer swap.
+    SWAP,
+};
+
+inline constexpr auto g_series_count = std::size_t{4};
+
+struct Summary {
+    double min;
+    double avg;
+    double p99;
+};
+
+// The last s_window samples of a series.
+class Rolling {
+public:
+    inline static constexpr auto s_window = std::size_t{240};
+
+    auto push(double value) -> void;
+    [[nodiscard]] auto summary() const -> std::optional<Summary>;
+
+private:
+    std::vector<double> m_values;
+    std::size_t m_next{0};
+};
+
+// Host side times of a frame, in milliseconds.
+struct CpuTimes {
+    double frame;
+    double input;
+    double swap;
+};
+
+// The GPU time of a frame only arrives a frame or two after its host times: the frame is
+// recorded once it does, or once it is known to be lost.
+class FrameStats {
+public:
+    FrameStats() = default;
+    FrameStats(FrameStats const &) = delete;
+    auto operator=(FrameStats const &) -> FrameStats & = delete;
+    FrameStats(FrameStats &&) = default;
+    auto operator=(FrameStats &&) -> FrameStats & = default;
+    ~FrameStats();
+
+    // Also appends every recorded frame to a CSV file from now on.
+    [[nodiscard]] auto open_csv(std::filesystem::path const &path) -> bool;
+
+    auto add_cpu(std::uint64_t frame, CpuTimes const &times) -> void;
+    auto add_gpu(std::uint64_t frame, double ms) -> void;
+
+    [[nodiscard]] auto summary(Series series) const -> std::optional<Summary>;
+    // min/avg/p99 of every series on one line.
+    [[nodiscard]] auto format() const -> std::string;
+
+private:
+    struct Pending {
+        std::uint64_t frame;
+        CpuTimes times;
+    };
+
+    auto record(Pending const &pending, std::optional<double> gpu_ms) -> void;
+
+    std::array<Rolling, g_series_count> m_series;
+    std::deque<Pending> m_pending;
+    std::ofstream m_csv;
+};
+}  // namespace stats
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef GL_FRAMEBUFFER_HPP
+#define GL_FRAMEBUFFER_HPP
+
+#include "glad/glad.h"
+#include <algorithm>
+#include <utility>
+
+namespace gl {
+// Offscreen render target: a framebuffer object with a texture as color attachment.
+class Framebuffer {
+public:
+    inline static constexpr auto s_granularity = 256;
+
+    // internal_format must be color-renderable; format and type describe a matching pixel
+    // transfer, e.g. GL_RG32F, GL_RG, GL_FLOAT.
+    [[nodiscard]] static auto make(GLenum internal_format, GLenum format, GLenum type)
+        -> Framebuffer {
+        auto fbo = GLuint{};
+        auto tex = GLuint{};
+        glGenFramebuffers(1, &fbo);
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return Framebuffer{fbo, tex, internal_format, format, type};
+    }
+
+    Framebuffer(Framebuffer const &) = delete;
+    auto operator=(Framebuffer const &) -> Framebuffer & = delete;
+
+    Framebuffer(Framebuffer &&other) noexcept
+        : m_fbo{std::exchange(other.m_fbo, 0U)}
+        , m_tex{std::exchange(other.m_tex, 0U)}
+        , m_internal_format{other.m_internal_format}
+        , m_format{other.m_format}
+        , m_type{other.m_type}
+        , m_width{other.m_width}
+        , m_height{other.m_height}
+        , m_allocated_width{other.m_allocated_width}
+        , m_allocated_height{other.m_allocated_height} {
+    }
+
+    auto operator=(Framebuffer &&other) noexcept -> Framebuffer & {
+        m_fbo = std::exchange(other.m_fbo, 0U);
+        m_tex = std::exchange(other.m_tex, 0U);
+        m_internal_format = other.m_internal_format;
+        m_format = other.m_format;
+        m_type = other.m_type;
+        m_width = other.m_width;
+        m_height = other.m_height;
+        m_allocated_width = other.m_allocated_width;
+        m_allocated_height = other.m_allocated_height;
+        return *this;
+    }
+
+    ~Framebuffer() {
+        if (m_tex != 0) {
+            glDeleteTextures(1, &m_tex);
+        }
+        if (m_fbo != 0) {
+            glDeleteFramebuffers(1, &m_fbo);
+        }
+    }
+
+    // Sets the size of the area drawn and read, the bottom left corner of the color attachment.
+    // The first size is allocated as is; after that the attachment only grows, to whole
+    // s_granularity blocks, so that resizing the window or the resolution of a pass seldom
+    // reallocates it. The content is undefined afterwards.
+    auto resize(int w, int h) -> void {
+        m_width = w;
+        m_height = h;
+        if (w <= m_allocated_width && h <= m_allocated_height) {
+            return;
+        }
+        auto max_size = GLint{};
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+        auto const grown = [&](int size, int allocated) {
+            if (allocated == 0) {
+                return size;
+            }
+            auto const rounded = (size + s_granularity - 1) / s_granularity * s_granularity;
+            return std::max(allocated, std::max(size, std::min(rounded, max_size)));
+        };
+        m_allocated_width = grown(w, m_allocated_width);
+        m_allocated_height = grown(h, m_allocated_height);
+        glBindTexture(GL_TEXTURE_2D, m_tex);
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     static_cast<GLint>(m_internal_format),
+                     m_allocated_width,
+                     m_allocated_height,
+                     0,
+                     m_format,
+                     m_type,
+                     nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_tex, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Makes it the target of the following draws, over its whole area.
+    auto bind() const -> void {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glViewport(0, 0, m_width, m_height);
+    }
+
+    // Binds the texture to a texture unit, the value of the sampler uniform.
+    auto bind_texture(GLuint unit) const -> void {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, m_tex);
+    }
+
+    // Copies the content into dst moved by dx, dy pixels; what falls outside dst is dropped.
+    auto blit_to(Framebuffer const &dst, int dx, int dy) const -> void {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst.m_fbo);
+        glBlitFramebuffer(0,
+                          0,
+                          m_width,
+                          m_height,
+                          dx,
+                          dy,
+                          m_width + dx,
+                          m_height + dy,
+                          GL_COLOR_BUFFER_BIT,
+                          GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // glTexSubImage2D() of a rectangle of the area, rows bottom first.
+    auto write(int x, int y, int w, int h, GLenum format, GLenum type, void const *pixels) const
+        -> void {
+        glBindTexture(GL_TEXTURE_2D, m_tex);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format, type, pixels);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // glReadPixels() of the area.
+    auto read(GLenum format, GLenum type, void *pixels) const -> void {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+        glReadPixels(0, 0, m_width, m_height, format, type, pixels);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+
+    [[nodiscard]] auto width() const -> int {
+        return m_width;
+    }
+
+    [[nodiscard]] auto height() const -> int {
+        return m_height;
+    }
+
+private:
+    explicit Framebuffer(GLuint fbo, GLuint tex, GLenum internal_format, GLenum format, GLenum type)
+        : m_fbo{fbo}
+        , m_tex{tex}
+        , m_internal_format{internal_format}
+        , m_format{format}
+        , m_type{type} {
+    }
+
+    GLuint m_fbo;
+    GLuint m_tex;
+    GLenum m_internal_format;
+    GLenum m_format;
+    GLenum m_type;
+    int m_width{0};
+    int m_height{0};
+    int m_allocated_width{0};
+    int m_allocated_height{0};
+};
+}  // namespace gl
+
+#endif
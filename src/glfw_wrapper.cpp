@@ -6,9 +6,12 @@
 
 #include "fmt/base.h"
 #include <cassert>
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <functional>
+#include <memory>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -33,6 +36,24 @@ auto init() -> Terminate {
     return Terminate{};
 }
 
+Window::Window(GLFWwindow *window)
+    : m_window{window}
+    , m_events{std::make_unique<Events>()} {
+    glfwSetWindowUserPointer(m_window, m_events.get());
+    auto const cb = [](GLFWwindow *window, int key, int, int action, int) noexcept {  // NOLINT
+        if (key < 0 || key > GLFW_KEY_LAST || action == GLFW_REPEAT) {
+            return;
+        }
+        auto &events = *static_cast<Events *>(glfwGetWindowUserPointer(window));
+        auto const index = static_cast<std::size_t>(key);
+        events.down.at(index) = action == GLFW_PRESS;
+        if (action == GLFW_PRESS && events.on_press.at(index)) {
+            events.on_press.at(index)();
+        }
+    };
+    glfwSetKeyCallback(m_window, cb);
+}
+
 auto Window::make(Terminate const &, int w, int h, std::string_view title) -> Window {
     auto *window = glfwCreateWindow(w, h, title.data(), nullptr, nullptr);
     if (window == nullptr) {
@@ -42,6 +63,13 @@ auto Window::make(Terminate const &, int w, int h, std::string_view title) -> Wi
     return Window{window};
 }
 
+auto Window::make_hidden(Terminate const &terminate) -> Window {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    auto window = make(terminate, 1, 1, "");
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    return window;
+}
+
 auto Window::make_context_current() -> void {
     glfwMakeContextCurrent(m_window);
 }
@@ -49,27 +77,29 @@ auto Window::make_context_current() -> void {
 auto Window::set_on_frame_buffer_resize_handler(std::unique_ptr<OnFrameBufferResizeHandler> handler)
     -> void {
     assert(handler != nullptr);
-    m_on_resize_handler = std::move(handler);
-    glfwSetWindowUserPointer(m_window, m_on_resize_handler.get());
+    m_events->on_resize = std::move(handler);
     auto const cb = [](GLFWwindow *window, int w, int h) noexcept {  // NOLINT
-        auto *ptr = glfwGetWindowUserPointer(window);
-        if (ptr == nullptr) {
+        auto const &handler = static_cast<Events *>(glfwGetWindowUserPointer(window))->on_resize;
+        if (handler == nullptr) {
             return;
         }
-        static_cast<OnFrameBufferResizeHandler *>(ptr)->on_resize(w, h);
+        handler->on_resize(w, h);
     };
     glfwSetFramebufferSizeCallback(m_window, cb);
 }
 
 auto Window::remove_frame_buffer_resize_handler() -> void {
-    m_on_resize_handler.reset();
-    glfwSetWindowUserPointer(m_window, nullptr);
+    m_events->on_resize.reset();
 }
 
 auto Window::swap_buffers() -> void {
     glfwSwapBuffers(m_window);
 }
 
+auto Window::set_title(std::string const &title) -> void {
+    glfwSetWindowTitle(m_window, title.c_str());
+}
+
 auto Window::should_close() -> bool {
     return glfwWindowShouldClose(m_window) != 0;
 }
@@ -78,20 +108,27 @@ auto Window::set_should_close() -> void {
     glfwSetWindowShouldClose(m_window, 1);
 }
 
-auto Window::get_key(int key) -> int {
-    return glfwGetKey(m_window, key);
+auto Window::on_press(int key, KeyAction action) -> void {
+    m_events->on_press.at(static_cast<std::size_t>(key)) = std::move(action);
 }
 
-auto Window::handle_input() -> void {
-    for (auto const &cb : m_callbacks) {
-        if (cb(*this)) {
-            return;
-        }
-    }
+auto Window::is_down(int key) const -> bool {
+    return m_events->down.at(static_cast<std::size_t>(key));
+}
+
+auto Window::frame_buffer_size() -> std::pair<int, int> {
+    auto w = 0;
+    auto h = 0;
+    glfwGetFramebufferSize(m_window, &w, &h);
+    return {w, h};
+}
+
+auto poll_events() -> void {
+    glfwPollEvents();
 }
 
-auto Window::add_callback(Callback cb) -> void {
-    m_callbacks.push_back(std::move(cb));
+auto wait_events() -> void {
+    glfwWaitEvents();
 }
 
 auto loader_fn(const char *proc_name) noexcept -> void * {
@@ -5,10 +5,12 @@
 
 #include "GLFW/glfw3.h"
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
-#include <vector>
+#include <utility>
 
 namespace glfw {
 class Terminate {
@@ -38,10 +40,15 @@ private:
 [[nodiscard]] auto init() -> Terminate;
 auto loader_fn(const char *proc_name) noexcept -> void *;
 
-class Window {
-    using Callback = std::function<bool(Window &)>;
+// Event callbacks, key actions included, run from these two.
+auto poll_events() -> void;
+// Sleeps until at least one event is available.
+auto wait_events() -> void;
 
+class Window {
 public:
+    using KeyAction = std::function<void()>;
+
     class OnFrameBufferResizeHandler {
     public:
         virtual ~OnFrameBufferResizeHandler() = default;
@@ -52,6 +59,8 @@ public:
                                    int w,
                                    int h,
                                    std::string_view title) -> Window;
+    // Never shown: only provides a GL context, for offscreen rendering.
+    [[nodiscard]] static auto make_hidden(Terminate const &) -> Window;
 
     auto make_context_current() -> void;
 
@@ -61,23 +70,31 @@ public:
 
     auto swap_buffers() -> void;
 
-    auto handle_input() -> void;
+    auto set_title(std::string const &title) -> void;
 
     [[nodiscard]] auto should_close() -> bool;
     auto set_should_close() -> void;
 
-    [[nodiscard]] auto get_key(int key) -> int;
+    // Runs action when key goes down (key repeats excluded), replacing any action of the key.
+    auto on_press(int key, KeyAction action) -> void;
+    // Whether key is held, as of the last event processed.
+    [[nodiscard]] auto is_down(int key) const -> bool;
 
-    auto add_callback(Callback) -> void;
+    [[nodiscard]] auto frame_buffer_size() -> std::pair<int, int>;
 
 private:
-    explicit Window(GLFWwindow *window)
-        : m_window{window} {
-    }
+    // State of the event callbacks, reached through the window user pointer. On the heap so
+    // that its address survives moves of the Window.
+    struct Events {
+        std::unique_ptr<OnFrameBufferResizeHandler> on_resize;
+        std::array<KeyAction, GLFW_KEY_LAST + 1> on_press;
+        std::array<bool, GLFW_KEY_LAST + 1> down{};
+    };
+
+    explicit Window(GLFWwindow *window);
 
     GLFWwindow *m_window;
-    std::unique_ptr<OnFrameBufferResizeHandler> m_on_resize_handler;
-    std::vector<Callback> m_callbacks;
+    std::unique_ptr<Events> m_events;
 };
 }  // namespace glfw
 
@@ -0,0 +1,202 @@
+#ifndef GL_GPU_TIMER_HPP
+#define GL_GPU_TIMER_HPP
+
+#include "glad/glad.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace gl {
+// GL_TIME_ELAPSED queries around the GPU work of a frame. Results are collected a frame or more
+// later, only once available, so that reading them never waits for the GPU. Queries still
+// pending when their object is needed again are dropped.
+class GpuTimer {
+public:
+    struct Sample {
+        std::uint64_t frame;
+        double ms;
+    };
+
+    // Two queries: frame n is measured while the result of frame n - 1 is being produced.
+    inline static constexpr auto s_depth = std::size_t{2};
+
+    [[nodiscard]] static auto make() -> GpuTimer {
+        auto queries = std::array<GLuint, s_depth>{};
+        glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+        return GpuTimer{queries};
+    }
+
+    GpuTimer(GpuTimer const &) = delete;
+    auto operator=(GpuTimer const &) -> GpuTimer & = delete;
+
+    GpuTimer(GpuTimer &&other) noexcept
+        : m_queries{std::exchange(other.m_queries, {})}
+        , m_frames{other.m_frames}
+        , m_next{other.m_next}
+        , m_pending{other.m_pending}
+        , m_dropped{other.m_dropped} {
+    }
+
+    auto operator=(GpuTimer &&other) noexcept -> GpuTimer & {
+        m_queries = std::exchange(other.m_queries, {});
+        m_frames = other.m_frames;
+        m_next = other.m_next;
+        m_pending = other.m_pending;
+        m_dropped = other.m_dropped;
+        return *this;
+    }
+
+    ~GpuTimer() {
+        if (m_queries.front() != 0) {
+            glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+        }
+    }
+
+    // Queries cannot nest: every begin() must be followed by end() before the next one.
+    auto begin(std::uint64_t frame) -> void {
+        if (m_pending == s_depth) {
+            ++m_dropped;
+            --m_pending;
+        }
+        m_frames.at(m_next) = frame;
+        glBeginQuery(GL_TIME_ELAPSED, m_queries.at(m_next));
+    }
+
+    auto end() -> void {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_next = (m_next + 1) % s_depth;
+        ++m_pending;
+    }
+
+    // The oldest measured frame, if its result is available.
+    [[nodiscard]] auto poll() -> std::optional<Sample> {
+        if (m_pending == 0) {
+            return std::nullopt;
+        }
+        auto const oldest = (m_next + s_depth - m_pending) % s_depth;
+        auto available = GLint{};
+        glGetQueryObjectiv(m_queries.at(oldest), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            return std::nullopt;
+        }
+        auto ns = GLuint64{};
+        glGetQueryObjectui64v(m_queries.at(oldest), GL_QUERY_RESULT, &ns);
+        --m_pending;
+        return Sample{
+            .frame = m_frames.at(oldest),
+            .ms = static_cast<double>(ns) * 1e-6,  // NOLINT
+        };
+    }
+
+    // Measures overwritten before their result was available.
+    [[nodiscard]] auto dropped() const -> std::size_t {
+        return m_dropped;
+    }
+
+private:
+    explicit GpuTimer(std::array<GLuint, s_depth> queries)
+        : m_queries{queries} {
+    }
+
+    std::array<GLuint, s_depth> m_queries;
+    std::array<std::uint64_t, s_depth> m_frames{};
+    std::size_t m_next{0};
+    std::size_t m_pending{0};
+    std::size_t m_dropped{0};
+};
+
+// GL_TIMESTAMP queries around a part of the GPU work of a frame. Unlike GL_TIME_ELAPSED ones
+// they can be taken while a GpuTimer measures the whole frame. Same collection as GpuTimer,
+// each measure tagged by its caller.
+class SpanTimer {
+public:
+    struct Sample {
+        std::uint64_t tag;
+        double ms;
+    };
+
+    inline static constexpr auto s_depth = std::size_t{2};
+
+    [[nodiscard]] static auto make() -> SpanTimer {
+        auto queries = std::array<GLuint, 2 * s_depth>{};
+        glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+        return SpanTimer{queries};
+    }
+
+    SpanTimer(SpanTimer const &) = delete;
+    auto operator=(SpanTimer const &) -> SpanTimer & = delete;
+
+    SpanTimer(SpanTimer &&other) noexcept
+        : m_queries{std::exchange(other.m_queries, {})}
+        , m_tags{other.m_tags}
+        , m_next{other.m_next}
+        , m_pending{other.m_pending} {
+    }
+
+    auto operator=(SpanTimer &&other) noexcept -> SpanTimer & {
+        m_queries = std::exchange(other.m_queries, {});
+        m_tags = other.m_tags;
+        m_next = other.m_next;
+        m_pending = other.m_pending;
+        return *this;
+    }
+
+    ~SpanTimer() {
+        if (m_queries.front() != 0) {
+            glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+        }
+    }
+
+    // Every begin() must be followed by end() before the next one.
+    auto begin(std::uint64_t tag) -> void {
+        if (m_pending == s_depth) {
+            --m_pending;
+        }
+        m_tags.at(m_next) = tag;
+        glQueryCounter(m_queries.at(2 * m_next), GL_TIMESTAMP);
+    }
+
+    auto end() -> void {
+        glQueryCounter(m_queries.at((2 * m_next) + 1), GL_TIMESTAMP);
+        m_next = (m_next + 1) % s_depth;
+        ++m_pending;
+    }
+
+    // The oldest measure, if its result is available.
+    [[nodiscard]] auto poll() -> std::optional<Sample> {
+        if (m_pending == 0) {
+            return std::nullopt;
+        }
+        auto const oldest = (m_next + s_depth - m_pending) % s_depth;
+        auto available = GLint{};
+        glGetQueryObjectiv(m_queries.at((2 * oldest) + 1), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            return std::nullopt;
+        }
+        auto start = GLuint64{};
+        auto end = GLuint64{};
+        glGetQueryObjectui64v(m_queries.at(2 * oldest), GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(m_queries.at((2 * oldest) + 1), GL_QUERY_RESULT, &end);
+        --m_pending;
+        return Sample{
+            .tag = m_tags.at(oldest),
+            .ms = static_cast<double>(end - start) * 1e-6,  // NOLINT
+        };
+    }
+
+private:
+    explicit SpanTimer(std::array<GLuint, 2 * s_depth> queries)
+        : m_queries{queries} {
+    }
+
+    // Start and end of each measure.
+    std::array<GLuint, 2 * s_depth> m_queries;
+    std::array<std::uint64_t, s_depth> m_tags{};
+    std::size_t m_next{0};
+    std::size_t m_pending{0};
+};
+}  // namespace gl
+
+#endif
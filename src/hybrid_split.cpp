@@ -0,0 +1,68 @@
+#include "hybrid_split.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+
+namespace {
+
+// Weight of the newest pass in the smoothed rates. The rows of each side change with the split
+// and do not cost the same, so single passes are noisy.
+constexpr auto g_smoothing = 0.3;
+
+auto smooth(std::optional<double> &average, std::size_t pixels, double ms) -> void {
+    if (pixels == 0 || ms <= 0.0) {
+        return;
+    }
+    // Pixels per millisecond are thousands per second.
+    auto const rate = static_cast<double>(pixels) / ms * 1e-3;  // NOLINT
+    average = average.has_value() ? average.value() + ((rate - average.value()) * g_smoothing)
+                                  : rate;
+}
+
+}  // namespace
+
+namespace hybrid {
+
+Balancer::Balancer(double cpu_share)
+    : m_cpu_share{cpu_share} {
+}
+
+auto Balancer::first_cpu_row(int height) const -> int {
+    auto const cpu_rows = static_cast<int>(std::lround(m_cpu_share * height));
+    return std::clamp(height - cpu_rows, 0, height);
+}
+
+auto Balancer::add_gpu(std::size_t pixels, double ms) -> void {
+    smooth(m_gpu_rate, pixels, ms);
+    update_share();
+}
+
+auto Balancer::add_cpu(std::size_t pixels, double ms) -> void {
+    smooth(m_cpu_rate, pixels, ms);
+    update_share();
+}
+
+auto Balancer::cpu_share() const -> double {
+    return m_cpu_share;
+}
+
+auto Balancer::gpu_rate() const -> std::optional<double> {
+    return m_gpu_rate;
+}
+
+auto Balancer::cpu_rate() const -> std::optional<double> {
+    return m_cpu_rate;
+}
+
+auto Balancer::update_share() -> void {
+    if (!m_gpu_rate.has_value() || !m_cpu_rate.has_value()) {
+        return;
+    }
+    // Both sides take the same time when the rows are shared in proportion to the rates.
+    auto const share = m_cpu_rate.value() / (m_cpu_rate.value() + m_gpu_rate.value());
+    m_cpu_share = std::clamp(share, g_min_share, 1.0 - g_min_share);
+}
+
+}  // namespace hybrid
@@ -0,0 +1,39 @@
+#ifndef HYBRID_SPLIT_HPP
+#define HYBRID_SPLIT_HPP
+
+#include <cstddef>
+#include <optional>
+
+// Hybrid rendering: the GPU iterates the bottom rows of a pass while the CPU iterates the top
+// ones. The split follows the measured throughput of each side, so that both finish together.
+namespace hybrid {
+// Neither side gets less than this share of the rows, so that both keep being measured.
+inline constexpr auto g_min_share = 1.0 / 32.0;
+inline constexpr auto g_initial_cpu_share = 0.25;
+
+class Balancer {
+public:
+    explicit Balancer(double cpu_share = g_initial_cpu_share);
+
+    // Rows [0, first) go to the GPU, [first, height) to the CPU.
+    [[nodiscard]] auto first_cpu_row(int height) const -> int;
+
+    // Time each side took for its pixels of a pass.
+    auto add_gpu(std::size_t pixels, double ms) -> void;
+    auto add_cpu(std::size_t pixels, double ms) -> void;
+
+    [[nodiscard]] auto cpu_share() const -> double;
+    // Smoothed Mpixels/s of each side, once measured.
+    [[nodiscard]] auto gpu_rate() const -> std::optional<double>;
+    [[nodiscard]] auto cpu_rate() const -> std::optional<double>;
+
+private:
+    auto update_share() -> void;
+
+    double m_cpu_share;
+    std::optional<double> m_gpu_rate;
+    std::optional<double> m_cpu_rate;
+};
+}  // namespace hybrid
+
+#endif
@@ -0,0 +1,87 @@
+#include "image.hpp"
+
+#include "antialias.hpp"
+#include "colormap.hpp"
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+namespace image {
+
+auto colorize(std::span<std::uint32_t const> iterations,
+              int width,
+              int height,
+              colormap::Table const &color_map,
+              std::uint32_t max_iters,
+              Image &out) -> void {
+    auto const w = static_cast<std::size_t>(width);
+    auto const h = static_cast<std::size_t>(height);
+    assert(iterations.size() == w * h);
+    out.width = width;
+    out.height = height;
+    out.pixels.resize(w * h * 3U);
+    auto dst = out.pixels.begin();
+    for (auto row = h; row-- > 0;) {
+        for (auto const iters : iterations.subspan(row * w, w)) {
+            auto const color = colormap::get_color(color_map, iters, max_iters);
+            *dst++ = colormap::to_unorm8(color.r);
+            *dst++ = colormap::to_unorm8(color.g);
+            *dst++ = colormap::to_unorm8(color.b);
+        }
+    }
+}
+
+auto colorize(std::span<std::uint32_t const> iterations,
+              int width,
+              int height,
+              colormap::Table const &color_map,
+              std::uint32_t max_iters,
+              aa::Samples const &samples,
+              Image &out) -> void {
+    colorize(iterations, width, height, color_map, max_iters, out);
+    auto const w = static_cast<std::size_t>(width);
+    auto const h = static_cast<std::size_t>(height);
+    auto const per_pixel = samples.per_pixel();
+    assert(samples.counts.size() == samples.pixels.size() * per_pixel);
+    for (auto i = std::size_t{0}; i < samples.pixels.size(); ++i) {
+        auto sum = colormap::Rgb{.r = 0.0F, .g = 0.0F, .b = 0.0F};
+        for (auto const iters : std::span{samples.counts}.subspan(i * per_pixel, per_pixel)) {
+            auto const color = colormap::get_color(color_map, iters, max_iters);
+            sum.r += color.r;
+            sum.g += color.g;
+            sum.b += color.b;
+        }
+        auto const scale = 1.0F / static_cast<float>(per_pixel);
+        // Rows of the image are top row first.
+        auto const pixel = samples.pixels[i];
+        auto const row = h - 1 - pixel / w;
+        auto dst = out.pixels.begin() + static_cast<std::ptrdiff_t>((row * w + pixel % w) * 3U);
+        *dst++ = colormap::to_unorm8(sum.r * scale);
+        *dst++ = colormap::to_unorm8(sum.g * scale);
+        *dst = colormap::to_unorm8(sum.b * scale);
+    }
+}
+
+auto write_ppm(std::filesystem::path const &path, Image const &img) -> bool {
+    auto file = std::ofstream{path, std::ios::binary};
+    if (!file.is_open()) {
+        fmt::println(stderr, "Cannot open {} for writing.", path.c_str());
+        return false;
+    }
+    auto const header = fmt::format("P6\n{} {}\n255\n", img.width, img.height);
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.write(reinterpret_cast<char const *>(img.pixels.data()),  // NOLINT
+               static_cast<std::streamsize>(img.pixels.size()));
+    if (!file) {
+        fmt::println(stderr, "Failed to write {}.", path.c_str());
+        return false;
+    }
+    return true;
+}
+}  // namespace image
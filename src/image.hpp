@@ -0,0 +1,41 @@
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include "antialias.hpp"
+#include "colormap.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace image {
+// 8 bit RGB, top row first.
+struct Image {
+    int width{0};
+    int height{0};
+    std::vector<std::uint8_t> pixels;
+};
+
+// Applies a colormap to width * height iteration counts stored bottom row first, as produced
+// by cpu::Renderer and glReadPixels.
+auto colorize(std::span<std::uint32_t const> iterations,
+              int width,
+              int height,
+              colormap::Table const &color_map,
+              std::uint32_t max_iters,
+              Image &out) -> void;
+
+// Same, the color of the pixels of samples being the mean color of their samples.
+auto colorize(std::span<std::uint32_t const> iterations,
+              int width,
+              int height,
+              colormap::Table const &color_map,
+              std::uint32_t max_iters,
+              aa::Samples const &samples,
+              Image &out) -> void;
+
+// Binary PPM (P6).
+[[nodiscard]] auto write_ppm(std::filesystem::path const &path, Image const &img) -> bool;
+}  // namespace image
+
+#endif
@@ -0,0 +1,351 @@
+#include "iteration_file.hpp"
+
+#include "colormap.hpp"
+#include "cpu_renderer.hpp"
+#include "fixed.hpp"
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include "perturbation.hpp"
+#include "tile_scheduler.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto g_magic = std::array<char, 8>{'M', 'B', 'I', 'T', 'E', 'R', '0', '1'};
+// Reads differently on a host of the other byte order.
+constexpr auto g_byte_order = std::uint32_t{0x01020304};
+
+// Rows colorized and written at once by write_ppm().
+constexpr auto g_band_rows = 16;
+
+// Room for a sign, the integer part and 960 decimals: offsets are stored exactly.
+constexpr auto g_offset_chars = std::size_t{1024};
+constexpr auto g_offset_digits = (mp::Fixed::s_max_limbs - 1) * 64;  // NOLINT
+
+// What is stored at the start of the file.
+struct DiskHeader {
+    std::array<char, 8> magic;
+    std::uint32_t byte_order;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t tile_size;
+    std::uint32_t max_iters;
+    double zoom;
+    // Nul terminated decimals.
+    std::array<char, g_offset_chars> x_offset;
+    std::array<char, g_offset_chars> y_offset;
+};
+
+static_assert(sizeof(DiskHeader) <= itfile::g_header_bytes);
+
+auto slot_bytes(itfile::Header const &header) -> std::size_t {
+    auto const side = static_cast<std::size_t>(header.tile_size);
+    return side * side * sizeof(std::uint32_t);
+}
+
+auto file_bytes(itfile::Header const &header) -> std::size_t {
+    auto const tiles = static_cast<std::size_t>(header.columns())
+                     * static_cast<std::size_t>(header.rows());
+    return itfile::g_header_bytes + tiles * slot_bytes(header);
+}
+
+// Tiles must start on pages and cover whole ones.
+auto valid_tile_size(int tile_size) -> bool {
+    return tile_size > 0 && tile_size % 32 == 0;  // NOLINT
+}
+
+auto store_offset(mp::Fixed const &offset, std::array<char, g_offset_chars> &out) -> void {
+    auto const str = offset.to_string(g_offset_digits);
+    auto const size = std::min(str.size(), out.size() - 1);
+    std::ranges::copy(str.substr(0, size), out.begin());
+    out.at(size) = '\0';
+}
+
+auto load_offset(std::array<char, g_offset_chars> const &str) -> std::optional<mp::Fixed> {
+    auto const end = std::ranges::find(str, '\0');
+    if (end == str.end()) {
+        return std::nullopt;
+    }
+    return mp::Fixed::parse(std::string_view{str.begin(), end});
+}
+
+auto encode(itfile::Header const &header) -> DiskHeader {
+    auto disk = DiskHeader{
+        .magic = g_magic,
+        .byte_order = g_byte_order,
+        .width = static_cast<std::uint32_t>(header.camera.width),
+        .height = static_cast<std::uint32_t>(header.camera.height),
+        .tile_size = static_cast<std::uint32_t>(header.tile_size),
+        .max_iters = header.max_iters,
+        .zoom = header.camera.zoom,
+        .x_offset = {},
+        .y_offset = {},
+    };
+    store_offset(header.camera.x_offset, disk.x_offset);
+    store_offset(header.camera.y_offset, disk.y_offset);
+    return disk;
+}
+
+// Anything inconsistent, a file of another byte order included, is rejected.
+auto decode(DiskHeader const &disk) -> std::optional<itfile::Header> {
+    auto const x_offset = load_offset(disk.x_offset);
+    auto const y_offset = load_offset(disk.y_offset);
+    auto const in_range = [](std::uint32_t value) { return value > 0 && value <= INT32_MAX; };
+    if (disk.magic != g_magic || disk.byte_order != g_byte_order || !in_range(disk.width)
+        || !in_range(disk.height) || !in_range(disk.tile_size)
+        || !valid_tile_size(static_cast<int>(disk.tile_size)) || disk.max_iters == 0
+        || !(disk.zoom > 0.0) || !x_offset.has_value() || !y_offset.has_value()) {
+        return std::nullopt;
+    }
+    return itfile::Header{
+        .camera = deep::Camera{
+            .x_offset = x_offset.value(),
+            .y_offset = y_offset.value(),
+            .zoom = disk.zoom,
+            .width = static_cast<int>(disk.width),
+            .height = static_cast<int>(disk.height),
+        },
+        .max_iters = disk.max_iters,
+        .tile_size = static_cast<int>(disk.tile_size),
+    };
+}
+
+auto map(int fd, std::size_t size, int protection) -> std::span<std::byte> {
+    auto *const data = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {  // NOLINT
+        return {};
+    }
+    return {static_cast<std::byte *>(data), size};
+}
+
+}  // namespace
+
+namespace itfile {
+
+auto Header::columns() const -> int {
+    return (camera.width + tile_size - 1) / tile_size;
+}
+
+auto Header::rows() const -> int {
+    return (camera.height + tile_size - 1) / tile_size;
+}
+
+auto Header::area(int column, int row) const -> cpu::Tile {
+    auto const x = column * tile_size;
+    auto const y = row * tile_size;
+    return cpu::Tile{
+        .x = x,
+        .y = y,
+        .width = std::min(tile_size, camera.width - x),
+        .height = std::min(tile_size, camera.height - y),
+    };
+}
+
+auto File::create(std::filesystem::path const &path, Header const &header)
+    -> std::optional<File> {
+    if (!valid_tile_size(header.tile_size) || header.camera.width <= 0
+        || header.camera.height <= 0) {
+        fmt::println(stderr, "Invalid iteration file size or tile size.");
+        return std::nullopt;
+    }
+    auto const fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);  // NOLINT
+    if (fd < 0) {
+        fmt::println(stderr, "Cannot create {}: {}", path.c_str(), std::strerror(errno));
+        return std::nullopt;
+    }
+    // Reserved up front: a store through the mapping that finds the disk full would be SIGBUS.
+    auto const size = file_bytes(header);
+    if (auto const error = posix_fallocate(fd, 0, static_cast<off_t>(size)); error != 0) {
+        fmt::println(stderr,
+                     "Cannot reserve {} MiB for {}: {}",
+                     size >> 20U,  // NOLINT
+                     path.c_str(),
+                     std::strerror(error));
+        close(fd);
+        unlink(path.c_str());
+        return std::nullopt;
+    }
+    auto const mapping = map(fd, size, PROT_READ | PROT_WRITE);  // NOLINT
+    if (mapping.empty()) {
+        fmt::println(stderr, "Cannot map {}: {}", path.c_str(), std::strerror(errno));
+        close(fd);
+        return std::nullopt;
+    }
+    auto const disk = encode(header);
+    std::memcpy(mapping.data(), &disk, sizeof(disk));
+    return File{header, fd, mapping};
+}
+
+auto File::open(std::filesystem::path const &path) -> std::optional<File> {
+    auto const fd = ::open(path.c_str(), O_RDONLY);  // NOLINT
+    if (fd < 0) {
+        fmt::println(stderr, "Cannot open {}: {}", path.c_str(), std::strerror(errno));
+        return std::nullopt;
+    }
+    struct stat status {};
+    auto const size = fstat(fd, &status) == 0 ? static_cast<std::size_t>(status.st_size) : 0;
+    auto disk = DiskHeader{};
+    auto header = std::optional<Header>{};
+    if (size >= g_header_bytes && pread(fd, &disk, sizeof(disk), 0) == sizeof(disk)) {
+        header = decode(disk);
+    }
+    if (!header.has_value() || file_bytes(header.value()) != size) {
+        fmt::println(stderr, "{} is not an iteration file.", path.c_str());
+        close(fd);
+        return std::nullopt;
+    }
+    auto const mapping = map(fd, size, PROT_READ);
+    if (mapping.empty()) {
+        fmt::println(stderr, "Cannot map {}: {}", path.c_str(), std::strerror(errno));
+        close(fd);
+        return std::nullopt;
+    }
+    return File{header.value(), fd, mapping};
+}
+
+File::File(Header const &header, int fd, std::span<std::byte> mapping)
+    : m_header{header}
+    , m_fd{fd}
+    , m_mapping{mapping} {
+}
+
+File::File(File &&other) noexcept
+    : m_header{other.m_header}
+    , m_fd{std::exchange(other.m_fd, -1)}
+    , m_mapping{std::exchange(other.m_mapping, {})} {
+}
+
+auto File::operator=(File &&other) noexcept -> File & {
+    std::swap(m_header, other.m_header);
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_mapping, other.m_mapping);
+    return *this;
+}
+
+File::~File() {
+    if (!m_mapping.empty()) {
+        munmap(m_mapping.data(), m_mapping.size());
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+auto File::header() const -> Header const & {
+    return m_header;
+}
+
+auto File::tile(int column, int row) const -> std::span<std::uint32_t> {
+    auto const index = static_cast<std::size_t>(row) * static_cast<std::size_t>(m_header.columns())
+                     + static_cast<std::size_t>(column);
+    auto const area = m_header.area(column, row);
+    auto *const slot = m_mapping.data() + g_header_bytes + index * slot_bytes(m_header);
+    return {reinterpret_cast<std::uint32_t *>(slot),  // NOLINT
+            static_cast<std::size_t>(area.width) * static_cast<std::size_t>(area.height)};
+}
+
+auto File::release(std::span<std::uint32_t const> counts) const -> void {
+    static auto const page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto const begin = reinterpret_cast<std::uintptr_t>(counts.data());  // NOLINT
+    auto const end = begin + counts.size_bytes();
+    auto const first = (begin + page - 1) / page * page;
+    auto const last = end / page * page;
+    if (first < last) {
+        madvise(reinterpret_cast<void *>(first), last - first, MADV_DONTNEED);  // NOLINT
+    }
+}
+
+auto render(cpu::Renderer &renderer, File const &file) -> void {
+    auto const &header = file.header();
+    auto const &camera = header.camera;
+    auto const orbit = camera.needs_perturbation()
+                           ? std::optional{deep::ReferenceOrbit::compute(camera, header.max_iters)}
+                           : std::nullopt;
+    auto const view = camera.to_view();
+    for (auto row = 0; row < header.rows(); ++row) {
+        for (auto column = 0; column < header.columns(); ++column) {
+            auto const area = header.area(column, row);
+            auto const counts = file.tile(column, row);
+            if (orbit.has_value()) {
+                renderer.render_area(camera, orbit.value(), area, header.max_iters, counts);
+            } else {
+                renderer.render_area(view, area, header.max_iters, counts);
+            }
+            file.release(counts);
+        }
+    }
+}
+
+auto write_ppm(File const &file,
+               colormap::Table const &color_map,
+               std::filesystem::path const &path) -> bool {
+    auto out = std::ofstream{path, std::ios::binary};
+    if (!out.is_open()) {
+        fmt::println(stderr, "Cannot open {} for writing.", path.c_str());
+        return false;
+    }
+    auto const &header = file.header();
+    auto const width = static_cast<std::size_t>(header.camera.width);
+    auto const ppm_header = fmt::format("P6\n{} {}\n255\n", width, header.camera.height);
+    out.write(ppm_header.data(), static_cast<std::streamsize>(ppm_header.size()));
+    auto band = std::vector<std::uint8_t>{};
+    // PPM rows go top to bottom: tile rows and the rows within them are walked downwards.
+    for (auto row = header.rows(); row-- > 0;) {
+        for (auto top = header.area(0, row).height; top > 0; top -= g_band_rows) {
+            auto const bottom = std::max(0, top - g_band_rows);
+            band.resize(width * static_cast<std::size_t>(top - bottom) * 3U);
+            for (auto column = 0; column < header.columns(); ++column) {
+                auto const area = header.area(column, row);
+                auto const stride = static_cast<std::size_t>(area.width);
+                auto const counts = file.tile(column, row);
+                for (auto y = top; y-- > bottom;) {
+                    auto dst = band.begin()
+                             + static_cast<std::ptrdiff_t>(
+                                   (static_cast<std::size_t>(top - 1 - y) * width
+                                    + static_cast<std::size_t>(area.x))
+                                   * 3U);
+                    for (auto const iters :
+                         counts.subspan(static_cast<std::size_t>(y) * stride, stride)) {
+                        auto const color = colormap::get_color(color_map, iters, header.max_iters);
+                        *dst++ = colormap::to_unorm8(color.r);
+                        *dst++ = colormap::to_unorm8(color.g);
+                        *dst++ = colormap::to_unorm8(color.b);
+                    }
+                }
+                file.release(counts.subspan(static_cast<std::size_t>(bottom) * stride,
+                                            static_cast<std::size_t>(top - bottom) * stride));
+            }
+            out.write(reinterpret_cast<char const *>(band.data()),  // NOLINT
+                      static_cast<std::streamsize>(band.size()));
+        }
+        // Faults map the cached neighbors of a page too, released rows included.
+        for (auto column = 0; column < header.columns(); ++column) {
+            file.release(file.tile(column, row));
+        }
+    }
+    if (!out) {
+        fmt::println(stderr, "Failed to write {}.", path.c_str());
+        return false;
+    }
+    return true;
+}
+}  // namespace itfile
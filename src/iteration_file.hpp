@@ -0,0 +1,79 @@
+#ifndef ITERATION_FILE_HPP
+#define ITERATION_FILE_HPP
+
+#include "colormap.hpp"
+#include "cpu_renderer.hpp"
+#include "perturbation.hpp"
+#include "tile_scheduler.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+// Iteration counts of images too large for memory, on disk: a g_header_bytes header with the
+// view, then the tiles of the image, left to right and bottom to top, each in a slot of
+// tile_size * tile_size counts. Slots are whole pages, so that tiles can be mapped, written and
+// dropped from memory independently. Integers are in host byte order.
+namespace itfile {
+inline constexpr auto g_header_bytes = std::size_t{4096};
+// Multiple of 32: 32 * 32 counts are a 4 KiB page.
+inline constexpr auto g_tile_size = 256;
+
+struct Header {
+    deep::Camera camera;
+    std::uint32_t max_iters;
+    int tile_size{g_tile_size};
+
+    [[nodiscard]] auto columns() const -> int;
+    [[nodiscard]] auto rows() const -> int;
+    // The pixels of a tile, clipped to the image.
+    [[nodiscard]] auto area(int column, int row) const -> cpu::Tile;
+};
+
+// A memory mapped iteration file. Tiles are only resident from their first access to their
+// release(): the pages of the file are not memory of the process.
+class File {
+public:
+    // A new file of the size of header, all zeros until the tiles are written.
+    [[nodiscard]] static auto create(std::filesystem::path const &path, Header const &header)
+        -> std::optional<File>;
+    // Read only.
+    [[nodiscard]] static auto open(std::filesystem::path const &path) -> std::optional<File>;
+
+    File(File const &) = delete;
+    auto operator=(File const &) -> File & = delete;
+    File(File &&other) noexcept;
+    auto operator=(File &&other) noexcept -> File &;
+    ~File();
+
+    [[nodiscard]] auto header() const -> Header const &;
+
+    // area(column, row).width * height counts, bottom row first. Only writable in a created
+    // file.
+    [[nodiscard]] auto tile(int column, int row) const -> std::span<std::uint32_t>;
+
+    // Drops the whole pages of counts, part of a tile, from memory. Written counts are kept:
+    // the kernel writes them back to the file.
+    auto release(std::span<std::uint32_t const> counts) const -> void;
+
+private:
+    File(Header const &header, int fd, std::span<std::byte> mapping);
+
+    Header m_header;
+    int m_fd;
+    std::span<std::byte> m_mapping;
+};
+
+// Renders the view of the header into a created file, a tile at a time with every thread of
+// renderer: a single tile is in memory at once.
+auto render(cpu::Renderer &renderer, File const &file) -> void;
+
+// Colorizes file into a binary PPM a band of rows at a time, so that only one band is in memory
+// whatever the size of the image.
+[[nodiscard]] auto write_ppm(File const &file,
+                             colormap::Table const &color_map,
+                             std::filesystem::path const &path) -> bool;
+}  // namespace itfile
+
+#endif
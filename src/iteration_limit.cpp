@@ -0,0 +1,51 @@
+#include "iteration_limit.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace {
+
+constexpr auto g_base = 250.0;
+constexpr auto g_per_decade = 500.0;
+
+// Escaped pixels allowed to need more than half the limit.
+constexpr auto g_tail_fraction = 0.005;
+// Changes smaller than this factor are ignored.
+constexpr auto g_hysteresis = 1.25;
+
+}  // namespace
+
+namespace iters {
+
+auto for_zoom(double zoom) -> std::uint32_t {
+    auto const decades = std::max(0.0, -std::log10(zoom));
+    auto const limit = std::lround(g_base + g_per_decade * decades);
+    return std::clamp(static_cast<std::uint32_t>(limit), g_min, g_max);
+}
+
+auto refine(std::span<std::uint32_t const> counts, std::uint32_t limit, double zoom)
+    -> std::uint32_t {
+    auto escaped = std::vector<std::uint32_t>{};
+    escaped.reserve(counts.size());
+    std::ranges::copy_if(counts, std::back_inserter(escaped), [&](auto c) { return c < limit; });
+    auto target = for_zoom(zoom);
+    if (!escaped.empty()) {
+        auto const tail = static_cast<std::size_t>(static_cast<double>(escaped.size())
+                                                   * (1.0 - g_tail_fraction));
+        auto const nth = escaped.begin() + static_cast<std::ptrdiff_t>(tail);
+        std::ranges::nth_element(escaped, nth);
+        target = std::max(target, 2U * *nth);
+    }
+    target = std::clamp(target, g_min, g_max);
+    auto const ratio = static_cast<double>(target) / static_cast<double>(limit);
+    if (ratio < g_hysteresis && ratio > 1.0 / g_hysteresis) {
+        return limit;
+    }
+    return target;
+}
+}  // namespace iters
@@ -0,0 +1,25 @@
+#ifndef ITERATION_LIMIT_HPP
+#define ITERATION_LIMIT_HPP
+
+#include <cstdint>
+#include <span>
+
+// Automatic iteration limit: deeper views need more iterations before their boundary pixels
+// escape, shallow ones waste them.
+namespace iters {
+inline constexpr auto g_min = std::uint32_t{100};
+inline constexpr auto g_max = std::uint32_t{100'000};
+
+// Starting point for a view of this zoom, growing with log(1 / zoom).
+[[nodiscard]] auto for_zoom(double zoom) -> std::uint32_t;
+
+// Limit for the next frame of a view of this zoom, from the counts of a frame computed with
+// limit (any subsampling will do). It leaves room for twice the count most escaped pixels need,
+// never goes below for_zoom() and only changes by a noticeable factor, so that refining again
+// from the new frame settles instead of oscillating.
+[[nodiscard]] auto refine(std::span<std::uint32_t const> counts,
+                          std::uint32_t limit,
+                          double zoom) -> std::uint32_t;
+}  // namespace iters
+
+#endif
@@ -1,14 +1,178 @@
-
 #include "app.hpp"
 #include "fmt/base.h"
+#include "fmt/format.h"
+#include "resolution_scale.hpp"
+#include "trace.hpp"
+#include "zoom_video.hpp"
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr auto g_usage = R"(Usage: mandelbrot <shaders directory> [options] [color map file...]
+
+In both modes:
+  --aa <int>            most samples of a pixel on an edge of the image, 1 for one sample
+                        everywhere (default 4)
+  --trace <file>        write the zones of every thread as Chrome trace JSON on exit, for
+                        chrome://tracing or ui.perfetto.dev
+
+Without --frames, opens the viewer:
+  --stats-csv <file>    write the GPU, CPU, input and swap times of every frame there
+  --tile-cache <MiB>    GPU memory for the tiles of the views seen before, which then show
+                        one sample per pixel instead of supersampled edges; 0 to always
+                        iterate (default)
+  --frame-budget <ms>   GPU time of a frame while the camera moves, met by lowering the
+                        resolution; 0 for a fixed preview resolution (default 16)
+  --cpu-threads <int>   CPU threads iterating a share of the rows of every frame, balanced
+                        with the GPU by their measured throughput; 0 for none (default)
+
+With --frames, renders a zoom video offscreen:
+  --frames <int>        number of frames
+  --from-x <num>        first camera, real offset (default 0)
+  --from-y <num>        first camera, imaginary offset (default 0)
+  --from-zoom <num>     first camera, zoom (default 1)
+  --to-x <num>          last camera, real offset (default 0)
+  --to-y <num>          last camera, imaginary offset (default 0)
+  --to-zoom <num>       last camera, zoom (default 1)
+  --width <int>         frame width (default 1280)
+  --height <int>        frame height (default 720)
+  --iters <int>         iteration limit of every frame (default: from the zoom of each frame)
+  --colormap <name>     rainbow, inferno, viridis or the path of a color map file
+  --output <dir|->      directory of numbered PPM images, or - for raw RGB24 frames on
+                        stdout (default), e.g. for
+                        ffmpeg -f rawvideo -pix_fmt rgb24 -s 1280x720 -r 30 -i - zoom.mp4)";
+
+[[noreturn]] auto usage_error(std::string_view msg) -> void {
+    fmt::println(stderr, "{}\n\n{}", msg, g_usage);
+    std::abort();
+}
+
+template <typename T>
+auto parse_into(std::string_view option, std::string_view str, T &value) -> void {
+    auto const [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || end != str.data() + str.size()) {
+        usage_error(fmt::format("Invalid value '{}' for {}.", str, option));
+    }
+}
+
+auto parse_fixed(std::string_view option, std::string_view str) -> mp::Fixed {
+    auto const parsed = mp::Fixed::parse(str);
+    if (!parsed.has_value()) {
+        usage_error(fmt::format("Invalid value '{}' for {}.", str, option));
+    }
+    return parsed.value();
+}
+
+struct Args {
+    video::Options video;
+    std::optional<std::filesystem::path> stats_csv;
+    std::optional<std::filesystem::path> trace;
+    std::size_t tile_cache_mib{0};
+    double frame_budget_ms{resolution::g_default_budget_ms};
+    unsigned cpu_threads{0};
+    std::vector<std::filesystem::path> color_map_files;
+};
+
+auto parse_args(std::span<char *const> args) -> Args {
+    auto parsed = Args{};
+    auto &options = parsed.video;
+    for (auto i = std::size_t{0}; i < args.size(); ++i) {
+        auto const arg = std::string_view{args[i]};
+        if (!arg.starts_with("--"sv)) {
+            parsed.color_map_files.emplace_back(arg);
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            usage_error(fmt::format("Missing value for {}.", arg));
+        }
+        auto const value = std::string_view{args[++i]};
+        if (arg == "--aa"sv) {
+            parse_into(arg, value, options.max_samples);
+        } else if (arg == "--trace"sv) {
+            parsed.trace = value;
+        } else if (arg == "--stats-csv"sv) {
+            parsed.stats_csv = value;
+        } else if (arg == "--tile-cache"sv) {
+            parse_into(arg, value, parsed.tile_cache_mib);
+        } else if (arg == "--frame-budget"sv) {
+            parse_into(arg, value, parsed.frame_budget_ms);
+        } else if (arg == "--cpu-threads"sv) {
+            parse_into(arg, value, parsed.cpu_threads);
+        } else if (arg == "--frames"sv) {
+            parse_into(arg, value, options.frames);
+        } else if (arg == "--from-x"sv) {
+            options.from.x_offset = parse_fixed(arg, value);
+        } else if (arg == "--from-y"sv) {
+            options.from.y_offset = parse_fixed(arg, value);
+        } else if (arg == "--from-zoom"sv) {
+            parse_into(arg, value, options.from.zoom);
+        } else if (arg == "--to-x"sv) {
+            options.to.x_offset = parse_fixed(arg, value);
+        } else if (arg == "--to-y"sv) {
+            options.to.y_offset = parse_fixed(arg, value);
+        } else if (arg == "--to-zoom"sv) {
+            parse_into(arg, value, options.to.zoom);
+        } else if (arg == "--width"sv) {
+            parse_into(arg, value, options.width);
+        } else if (arg == "--height"sv) {
+            parse_into(arg, value, options.height);
+        } else if (arg == "--iters"sv) {
+            auto max_iters = std::uint32_t{};
+            parse_into(arg, value, max_iters);
+            options.max_iters = max_iters;
+        } else if (arg == "--colormap"sv) {
+            options.color_map = value;
+        } else if (arg == "--output"sv) {
+            options.output = value;
+        } else {
+            usage_error(fmt::format("Unknown option {}.", arg));
+        }
+    }
+    if (options.width <= 0 || options.height <= 0 || options.from.zoom <= 0.0
+        || options.to.zoom <= 0.0 || options.frames < 0 || options.max_iters == 0U
+        || options.max_samples < 1 || parsed.frame_budget_ms < 0.0) {
+        usage_error(
+            "Invalid size, zoom, frame count, iteration limit, sample count or frame budget."sv);
+    }
+    return parsed;
+}
+
+}  // namespace
 
 auto main(int argc, char *argv[]) -> int {
-    if (argc != 2) {
-        fmt::println(stderr, "Provide path to shaders directory");
-        std::abort();
+    if (argc < 2) {
+        usage_error("Missing shaders directory."sv);
+    }
+    auto const args = std::span{argv, static_cast<std::size_t>(argc)};
+    auto const parsed = parse_args(args.subspan(2));
+    if (parsed.trace.has_value()) {
+        trace::enable();
+        trace::set_thread_name("main");
+    }
+    if (parsed.video.frames > 0) {
+        App{}.export_video(std::filesystem::path{args[1]}, parsed.color_map_files, parsed.video);
+    } else {
+        App{}.run(std::filesystem::path{args[1]},
+                  parsed.color_map_files,
+                  parsed.stats_csv,
+                  parsed.tile_cache_mib << 20U,  // NOLINT
+                  parsed.video.max_samples,
+                  parsed.frame_budget_ms,
+                  parsed.cpu_threads);
+    }
+    if (parsed.trace.has_value() && !trace::write_json(parsed.trace.value())) {
+        return EXIT_FAILURE;
     }
-    App{}.run(std::filesystem::path{argv[1]});  // NOLINT
 }
@@ -0,0 +1,51 @@
+#include "motion.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr auto g_step_seconds
+    = std::chrono::duration<double>{motion::Integrator::Step{1}}.count();
+
+// Share of the gap to the target velocity closed by every step.
+auto const g_blend = 1.0 - std::exp(-g_step_seconds / motion::Integrator::s_response);
+
+// Below this the velocity snaps to the target, so that the camera comes to a stop.
+constexpr auto g_rest_speed = 1e-4;
+
+auto ease(double velocity, double target) -> double {
+    auto const next = velocity + ((target - velocity) * g_blend);
+    return std::abs(next - target) < g_rest_speed ? target : next;
+}
+
+}  // namespace
+
+namespace motion {
+
+auto Integrator::advance(std::chrono::nanoseconds elapsed, Input const &input) -> Delta {
+    m_input = input;
+    m_pending += std::min(elapsed, std::chrono::nanoseconds{s_max_elapsed});
+    auto moved = Delta{};
+    while (m_pending >= Step{1}) {
+        m_pending -= Step{1};
+        m_velocity.x = ease(m_velocity.x, input.x * s_pan_speed);
+        m_velocity.y = ease(m_velocity.y, input.y * s_pan_speed);
+        m_velocity.zoom = ease(m_velocity.zoom, input.zoom * s_zoom_speed);
+        moved.x += m_velocity.x * g_step_seconds;
+        moved.y += m_velocity.y * g_step_seconds;
+        moved.zoom += m_velocity.zoom * g_step_seconds;
+    }
+    if (at_rest()) {
+        // Stopped: the time left over is not carried into the next move.
+        m_pending = Ticks{0};
+    }
+    return moved;
+}
+
+auto Integrator::at_rest() const -> bool {
+    return m_input == Input{} && m_velocity.x == 0.0 && m_velocity.y == 0.0
+           && m_velocity.zoom == 0.0;
+}
+}  // namespace motion
@@ -0,0 +1,59 @@
+#ifndef MOTION_HPP
+#define MOTION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+
+// Camera motion from held keys, integrated in fixed time steps: the path of the camera only
+// depends on how long keys are held, not on the frame rate.
+namespace motion {
+// Held directions, each -1, 0 or 1. zoom 1 zooms in.
+struct Input {
+    int x{0};
+    int y{0};
+    int zoom{0};
+
+    [[nodiscard]] auto operator==(Input const &) const -> bool = default;
+};
+
+// Pan in view sizes along each axis, zoom in e-folds (positive zooms in).
+struct Delta {
+    double x{0.0};
+    double y{0.0};
+    double zoom{0.0};
+};
+
+// The velocity eases towards the one the held keys ask for, so that starting and stopping are
+// smooth, and several keys combine.
+class Integrator {
+public:
+    using Step = std::chrono::duration<std::int64_t, std::ratio<1, 240>>;
+    // Exact for both steady_clock durations and whole steps.
+    using Ticks = std::common_type_t<Step, std::chrono::nanoseconds>;
+
+    // Full speed, in view sizes per second.
+    inline static constexpr auto s_pan_speed = 1.0;
+    // Full speed, in e-folds of the zoom per second.
+    inline static constexpr auto s_zoom_speed = 1.5;
+    // Time constant of the easing, in seconds.
+    inline static constexpr auto s_response = 0.08;
+    // Longer frames (a reference orbit, a stall) only move the camera this much.
+    inline static constexpr auto s_max_elapsed = std::chrono::milliseconds{250};
+
+    // Runs the steps that fit in the time elapsed since the last call, keeping the remainder
+    // for the next one, and returns the distance covered.
+    auto advance(std::chrono::nanoseconds elapsed, Input const &input) -> Delta;
+
+    // No key held and the camera stopped: nothing to redraw until the next key event.
+    [[nodiscard]] auto at_rest() const -> bool;
+
+private:
+    Input m_input;
+    Delta m_velocity;
+    Ticks m_pending{0};
+};
+}  // namespace motion
+
+#endif
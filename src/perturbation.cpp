@@ -0,0 +1,172 @@
+#include "perturbation.hpp"
+
+#include "fixed.hpp"
+#include "view.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace {
+
+// Bits kept beyond the pixel size, so that the rounding of the reference stays invisible.
+constexpr auto g_guard_bits = 32;
+
+// Same schedule as the cycle check of the float kernels.
+constexpr auto g_first_period_check = std::uint32_t{2};
+
+}  // namespace
+
+namespace deep {
+
+auto Camera::needs_perturbation() const -> bool {
+    return zoom < g_perturbation_zoom;
+}
+
+auto Camera::to_view() const -> View {
+    return View{
+        .x_offset = static_cast<float>(x_offset.to_double()),
+        .y_offset = static_cast<float>(y_offset.to_double()),
+        .zoom = static_cast<float>(zoom),
+        .width = width,
+        .height = height,
+    };
+}
+
+auto Camera::precision_bits() const -> int {
+    auto const pixel = static_cast<double>(View::s_scale) * zoom / std::max(width, height);
+    return static_cast<int>(std::ceil(-std::log2(pixel))) + g_guard_bits;
+}
+
+auto Camera::delta_real(int px) const -> double {
+    auto const frag_x = static_cast<double>(px) + 0.5;  // NOLINT
+    return (frag_x / width - View::s_anchor_x) * zoom * View::s_scale;
+}
+
+auto Camera::delta_imag(int py) const -> double {
+    auto const frag_y = static_cast<double>(py) + 0.5;  // NOLINT
+    return (frag_y / height - View::s_anchor_y) * zoom * View::s_scale;
+}
+
+auto ReferenceOrbit::compute(Camera const &camera, std::uint32_t max_iters) -> ReferenceOrbit {
+    auto const limbs = mp::Fixed::limbs_for_bits(camera.precision_bits());
+    auto const scale = mp::Fixed::from_double(View::s_scale, limbs);
+    auto const c_real = scale * camera.x_offset.with_limbs(limbs);
+    auto const c_imag = scale * camera.y_offset.with_limbs(limbs);
+
+    auto orbit = ReferenceOrbit{};
+    orbit.m_points.reserve(static_cast<std::size_t>(max_iters) + 1U);
+    orbit.m_points.push_back(Point{.real = 0.0, .imag = 0.0});
+    auto real = mp::Fixed::from_double(0.0, limbs);
+    auto imag = mp::Fixed::from_double(0.0, limbs);
+    for (auto n = std::uint32_t{0}; n < max_iters; ++n) {
+        auto const real_imag = real * imag;
+        real = real * real - imag * imag + c_real;
+        imag = real_imag + real_imag + c_imag;
+        auto const point = Point{.real = real.to_double(), .imag = imag.to_double()};
+        orbit.m_points.push_back(point);
+        if (point.real * point.real + point.imag * point.imag > View::s_threshold) {
+            break;
+        }
+    }
+    return orbit;
+}
+
+auto ReferenceOrbit::points() const -> std::span<Point const> {
+    return m_points;
+}
+
+auto ReferenceOrbit::to_rg32f() const -> std::vector<float> {
+    auto data = std::vector<float>{};
+    data.reserve(m_points.size() * 2U);
+    for (auto const &point : m_points) {
+        data.push_back(static_cast<float>(point.real));
+        data.push_back(static_cast<float>(point.imag));
+    }
+    return data;
+}
+
+auto calc_iters(ReferenceOrbit const &orbit,
+                double dc_real,
+                double dc_imag,
+                std::uint32_t max_iters,
+                bool interior_checks) -> std::uint32_t {
+    // z_k = X_m + delta, with z_1 = c: returning k - 1 at the first escape gives the same count
+    // as calc_iters(), which starts from z = c.
+    auto const points = orbit.points();
+    auto delta_real = 0.0;
+    auto delta_imag = 0.0;
+    auto m = std::size_t{0};
+    auto saved_real = delta_real;
+    auto saved_imag = delta_imag;
+    auto saved_m = m;
+    auto next_save = g_first_period_check;
+    for (auto k = std::uint32_t{1}; k <= max_iters; ++k) {
+        auto const x = points[m];
+        // delta' = (2 X + delta) delta + dc
+        auto const sum_real = 2.0 * x.real + delta_real;
+        auto const sum_imag = 2.0 * x.imag + delta_imag;
+        auto const next_real = sum_real * delta_real - sum_imag * delta_imag + dc_real;
+        delta_imag = sum_real * delta_imag + sum_imag * delta_real + dc_imag;
+        delta_real = next_real;
+        ++m;
+
+        auto const z_real = points[m].real + delta_real;
+        auto const z_imag = points[m].imag + delta_imag;
+        auto const z_norm = z_real * z_real + z_imag * z_imag;
+        if (z_norm > View::s_threshold) {
+            return k - 1;
+        }
+        if (z_norm < delta_real * delta_real + delta_imag * delta_imag
+            || m + 1 == points.size()) {
+            delta_real = z_real;
+            delta_imag = z_imag;
+            m = 0;
+        }
+        if (interior_checks) {
+            // The next iterations only depend on (m, delta): a repeated state is a cycle.
+            if (m == saved_m && delta_real == saved_real && delta_imag == saved_imag) {
+                return max_iters;
+            }
+            if (k == next_save) {
+                saved_real = delta_real;
+                saved_imag = delta_imag;
+                saved_m = m;
+                next_save *= 2;
+            }
+        }
+    }
+    return max_iters;
+}
+
+auto render_row(Camera const &camera,
+                ReferenceOrbit const &orbit,
+                int y,
+                int x_begin,
+                std::uint32_t max_iters,
+                bool interior_checks,
+                std::span<std::uint32_t> out) -> void {
+    auto const dc_imag = camera.delta_imag(y);
+    auto x = x_begin;
+    for (auto &iters : out) {
+        iters = calc_iters(orbit, camera.delta_real(x), dc_imag, max_iters, interior_checks);
+        ++x;
+    }
+}
+
+auto render_column(Camera const &camera,
+                   ReferenceOrbit const &orbit,
+                   int x,
+                   int y_begin,
+                   std::uint32_t max_iters,
+                   bool interior_checks,
+                   std::span<std::uint32_t> out) -> void {
+    auto const dc_real = camera.delta_real(x);
+    auto y = y_begin;
+    for (auto &iters : out) {
+        iters = calc_iters(orbit, dc_real, camera.delta_imag(y), max_iters, interior_checks);
+        ++y;
+    }
+}
+}  // namespace deep
@@ -0,0 +1,88 @@
+#ifndef PERTURBATION_HPP
+#define PERTURBATION_HPP
+
+#include "fixed.hpp"
+#include "view.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace deep {
+// Below this zoom the float kernels cannot tell neighboring pixels apart anymore.
+inline constexpr auto g_perturbation_zoom = 1e-5;
+
+// View with enough precision for deep zooms: same mapping, fixed-point offsets, double zoom.
+struct Camera {
+    mp::Fixed x_offset;
+    mp::Fixed y_offset;
+    double zoom{1.0};
+    int width{0};
+    int height{0};
+
+    [[nodiscard]] auto needs_perturbation() const -> bool;
+
+    // Float approximation for the plain kernels.
+    [[nodiscard]] auto to_view() const -> View;
+
+    // Fractional bits the reference point needs so that a pixel is still resolved.
+    [[nodiscard]] auto precision_bits() const -> int;
+
+    // Distance of a pixel center from the reference point, the pixel at the view anchor.
+    [[nodiscard]] auto delta_real(int px) const -> double;
+    [[nodiscard]] auto delta_imag(int py) const -> double;
+};
+
+// Orbit X_0 = 0, X_(n+1) = X_n^2 + C of the reference point C = s_scale * (x_offset, y_offset),
+// iterated in fixed point and stored rounded to double. It ends with the first escaped value or
+// after max_iters + 1 values.
+class ReferenceOrbit {
+public:
+    struct Point {
+        double real;
+        double imag;
+    };
+
+    [[nodiscard]] static auto compute(Camera const &camera, std::uint32_t max_iters)
+        -> ReferenceOrbit;
+
+    [[nodiscard]] auto points() const -> std::span<Point const>;
+
+    // Interleaved (real, imag) pairs, the layout of the reference_orbit texture buffer.
+    [[nodiscard]] auto to_rg32f() const -> std::vector<float>;
+
+private:
+    std::vector<Point> m_points;
+};
+
+// calc_iters() of the pixel C + dc iterating only the double precision delta from the
+// reference. A delta larger than its orbit point (|z| < |delta|) is about to lose all its
+// precision, the cause of perturbation glitches: the pixel is then rebased on the start of the
+// reference orbit, as is any pixel that outlives an escaping reference.
+// interior_checks enables the cycle check of cpu::row_kernel() on the (orbit index, delta)
+// state; the bulb test is left out, the pixel being only known relative to the reference.
+[[nodiscard]] auto calc_iters(ReferenceOrbit const &orbit,
+                              double dc_real,
+                              double dc_imag,
+                              std::uint32_t max_iters,
+                              bool interior_checks) -> std::uint32_t;
+
+auto render_row(Camera const &camera,
+                ReferenceOrbit const &orbit,
+                int y,
+                int x_begin,
+                std::uint32_t max_iters,
+                bool interior_checks,
+                std::span<std::uint32_t> out) -> void;
+
+// Pixels (x, y_begin + i), written to out[i].
+auto render_column(Camera const &camera,
+                   ReferenceOrbit const &orbit,
+                   int x,
+                   int y_begin,
+                   std::uint32_t max_iters,
+                   bool interior_checks,
+                   std::span<std::uint32_t> out) -> void;
+}  // namespace deep
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef GL_PIXEL_PACK_RING_HPP
+#define GL_PIXEL_PACK_RING_HPP
+
+#include "glad/glad.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "framebuffer.hpp"
+
+namespace gl {
+// Asynchronous glReadPixels(): each read goes into the next of a ring of pixel pack buffers and
+// returns at once. The pixels are fetched in order, later, once the GPU has written them, so
+// that reading back a frame overlaps the rendering of the following ones.
+class PixelPackRing {
+public:
+    [[nodiscard]] static auto make(std::size_t size) -> PixelPackRing {
+        assert(size > 0);
+        auto slots = std::vector<Slot>(size);
+        for (auto &slot : slots) {
+            glGenBuffers(1, &slot.buf);
+        }
+        return PixelPackRing{std::move(slots)};
+    }
+
+    PixelPackRing(PixelPackRing const &) = delete;
+    auto operator=(PixelPackRing const &) -> PixelPackRing & = delete;
+
+    PixelPackRing(PixelPackRing &&other) noexcept
+        : m_slots{std::exchange(other.m_slots, {})}
+        , m_next{other.m_next}
+        , m_pending{other.m_pending} {
+    }
+
+    auto operator=(PixelPackRing &&other) noexcept -> PixelPackRing & {
+        m_slots = std::exchange(other.m_slots, {});
+        m_next = other.m_next;
+        m_pending = other.m_pending;
+        return *this;
+    }
+
+    ~PixelPackRing() {
+        for (auto &slot : m_slots) {
+            if (slot.fence != nullptr) {
+                glDeleteSync(slot.fence);
+            }
+            glDeleteBuffers(1, &slot.buf);
+        }
+    }
+
+    // Queues a read of the whole color attachment of source as RGBA8. The ring must not be
+    // full().
+    auto start(Framebuffer const &source) -> void {
+        assert(!full());
+        auto &slot = m_slots.at(m_next);
+        slot.bytes = static_cast<std::size_t>(source.width())
+                   * static_cast<std::size_t>(source.height()) * 4U;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buf);
+        glBufferData(
+            GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(slot.bytes), nullptr, GL_STREAM_READ);
+        // With a pack buffer bound, the pointer is an offset into it.
+        source.read(GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_next = (m_next + 1) % m_slots.size();
+        ++m_pending;
+    }
+
+    // Waits for the oldest pending read and copies its pixels, bottom row first, into out.
+    auto finish(std::span<std::uint8_t> out) -> void {
+        assert(m_pending > 0);
+        auto &slot = m_slots.at((m_next + m_slots.size() - m_pending) % m_slots.size());
+        assert(out.size() == slot.bytes);
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, s_wait_ns)
+               == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buf);
+        auto const *pixels = glMapBufferRange(
+            GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(slot.bytes), GL_MAP_READ_BIT);
+        std::memcpy(out.data(), pixels, slot.bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        --m_pending;
+    }
+
+    [[nodiscard]] auto pending() const -> std::size_t {
+        return m_pending;
+    }
+
+    [[nodiscard]] auto full() const -> bool {
+        return m_pending == m_slots.size();
+    }
+
+private:
+    inline static constexpr auto s_wait_ns = GLuint64{1'000'000};
+
+    struct Slot {
+        GLuint buf{0};
+        GLsync fence{nullptr};
+        std::size_t bytes{0};
+    };
+
+    explicit PixelPackRing(std::vector<Slot> slots)
+        : m_slots{std::move(slots)} {
+    }
+
+    std::vector<Slot> m_slots;
+    // Slot of the next start(), and number of reads started but not finished.
+    std::size_t m_next{0};
+    std::size_t m_pending{0};
+};
+}  // namespace gl
+
+#endif
@@ -1,17 +1,29 @@
 #include "program.hpp"
 
 #include "fmt/base.h"
+#include "fmt/format.h"
 #include "glad/glad.h"
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <initializer_list>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "trace.hpp"
 
 namespace {
 [[nodiscard]] inline auto read_file(std::filesystem::path const &path)
@@ -94,38 +106,199 @@ private:
     std::abort();
 }
 
+// Locations of the default block uniforms of a linked program. Uniforms of blocks have none.
+[[nodiscard]] auto uniform_locations(GLuint prog_id)
+    -> std::vector<std::pair<std::string, GLint>> {
+    auto count = GLint{};
+    glGetProgramiv(prog_id, GL_ACTIVE_UNIFORMS, &count);
+    auto max_length = GLint{};
+    glGetProgramiv(prog_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    auto locations = std::vector<std::pair<std::string, GLint>>{};
+    auto name = std::string(static_cast<std::size_t>(max_length), '\0');
+    for (auto i = GLuint{0}; i < static_cast<GLuint>(count); ++i) {
+        auto length = GLsizei{};
+        auto size = GLint{};
+        auto type = GLenum{};
+        glGetActiveUniform(prog_id, i, max_length, &length, &size, &type, name.data());
+        auto const loc = glGetUniformLocation(prog_id, name.c_str());
+        if (loc == -1) {
+            continue;
+        }
+        // Arrays are reported as "name[0]".
+        auto key = name.substr(0, static_cast<std::size_t>(length));
+        if (key.ends_with("[0]")) {
+            key.resize(key.size() - 3);
+        }
+        locations.emplace_back(std::move(key), loc);
+    }
+    std::ranges::sort(locations);
+    return locations;
+}
+
+// The defines go right after the #version line, which must come first. #line keeps the line
+// numbers of compile errors those of the file.
+[[nodiscard]] auto inject_defines(std::string source, std::span<gl::Program::Define const> defines)
+    -> std::string {
+    if (defines.empty()) {
+        return source;
+    }
+    auto block = std::string{};
+    for (auto const &define : defines) {
+        block += fmt::format("#define {} {}\n", define.name, define.value);
+    }
+    block += "#line 2\n";
+    auto const line_end = source.find('\n');
+    source.insert(line_end == std::string::npos ? source.size() : line_end + 1, block);
+    return source;
+}
+
+// FNV-1a.
+auto hash_into(std::uint64_t &hash, std::string_view data) -> void {
+    for (auto const c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;  // NOLINT
+    }
+    // Separator, so that moving text from one piece to the next changes the hash.
+    hash ^= 0xffU;             // NOLINT
+    hash *= 0x100000001b3ULL;  // NOLINT
+}
+
+auto gl_string(GLenum name) -> std::string_view {
+    auto const *const str = glGetString(name);
+    return str == nullptr ? std::string_view{} : reinterpret_cast<char const *>(str);  // NOLINT
+}
+
+// A binary is only valid for the driver that produced it, and for the same sources.
+[[nodiscard]] auto binary_key(std::span<std::string const> sources) -> std::uint64_t {
+    auto hash = std::uint64_t{0xcbf29ce484222325ULL};  // NOLINT
+    for (auto const name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        hash_into(hash, gl_string(name));
+    }
+    for (auto const &source : sources) {
+        hash_into(hash, source);
+    }
+    return hash;
+}
+
+[[nodiscard]] auto binaries_supported() -> bool {
+    if (GLAD_GL_VERSION_4_1 == 0 && GLAD_GL_ARB_get_program_binary == 0) {
+        return false;
+    }
+    auto formats = GLint{};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+// A cached binary is the GLenum binary format followed by the glGetProgramBinary() data.
+[[nodiscard]] auto load_binary(std::filesystem::path const &path) -> std::optional<GLuint> {
+    auto const data = read_file(path);
+    if (!data.has_value() || data->size() <= sizeof(GLenum)) {
+        return std::nullopt;
+    }
+    auto format = GLenum{};
+    std::memcpy(&format, data->data(), sizeof(format));
+    auto const prog_id = glCreateProgram();
+    glProgramBinary(prog_id,
+                    format,
+                    data->data() + sizeof(format),
+                    static_cast<GLsizei>(data->size() - sizeof(format)));
+    auto success = GLint{};
+    glGetProgramiv(prog_id, GL_LINK_STATUS, &success);
+    if (success == 0) {
+        // From another driver version: compiled again and replaced.
+        glDeleteProgram(prog_id);
+        return std::nullopt;
+    }
+    return prog_id;
+}
+
+// Written to a temporary file of this process first, so that a concurrent launch never reads
+// half a binary nor writes into the same temporary file.
+auto save_binary(GLuint prog_id, std::filesystem::path const &path) -> void {
+    auto length = GLint{};
+    glGetProgramiv(prog_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    auto data = std::string(sizeof(GLenum) + static_cast<std::size_t>(length), '\0');
+    auto format = GLenum{};
+    glGetProgramBinary(prog_id, length, nullptr, &format, data.data() + sizeof(format));
+    std::memcpy(data.data(), &format, sizeof(format));
+
+    auto ec = std::error_code{};
+    std::filesystem::create_directories(path.parent_path(), ec);
+    auto tmp = path;
+    tmp += fmt::format(".{}.tmp", ::getpid());
+    {
+        auto file = std::ofstream{tmp, std::ios::binary};
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.good()) {
+            fmt::println(stderr, "Cannot write program binary {}.", tmp.c_str());
+            file.close();
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        fmt::println(stderr, "Cannot write program binary {}: {}", path.c_str(), ec.message());
+        std::filesystem::remove(tmp, ec);
+    }
+}
 
 }  // namespace
 
 namespace gl {
 
 Program::Program(Program &&other) noexcept
-    : m_prog_id{std::exchange(other.m_prog_id, s_invalid_program_id)} {
+    : m_prog_id{std::exchange(other.m_prog_id, s_invalid_program_id)}
+    , m_locations{std::move(other.m_locations)} {
 }
 
 auto Program::operator=(Program &&other) noexcept -> Program & {
     m_prog_id = std::exchange(other.m_prog_id, s_invalid_program_id);
+    m_locations = std::move(other.m_locations);
     return *this;
 }
 
-auto Program::create_and_link(std::initializer_list<std::filesystem::path> shader_paths)
+auto Program::create_and_link(std::initializer_list<std::filesystem::path> shader_paths,
+                              std::span<Define const> defines,
+                              std::optional<std::filesystem::path> const &cache_dir)
     -> std::optional<Program> {
-    auto const prog_id = glCreateProgram();
+    auto const zone = trace::Zone{"create and link program"};
+    auto sources = std::vector<std::string>{};
     for (auto const &shader_path : shader_paths) {
-        auto const src = read_file(shader_path);
-        if (!src.has_value() || !src.has_value()) {
+        auto src = read_file(shader_path);
+        if (!src.has_value()) {
             fmt::println(stderr, "Failed to open read shader file {}.", shader_path.c_str());
-            glDeleteProgram(prog_id);
             return std::nullopt;
         }
+        sources.push_back(inject_defines(std::move(src).value(), defines));
+    }
+
+    auto binary_path = std::optional<std::filesystem::path>{};
+    if (cache_dir.has_value() && binaries_supported()) {
+        binary_path = cache_dir.value() / fmt::format("{:016x}.bin", binary_key(sources));
+        auto const load_zone = trace::Zone{"load program binary"};
+        auto const prog_id = load_binary(binary_path.value());
+        if (prog_id.has_value()) {
+            return Program{prog_id.value(), uniform_locations(prog_id.value())};
+        }
+    }
+
+    auto const prog_id = glCreateProgram();
+    for (auto i = std::size_t{0}; auto const &shader_path : shader_paths) {
         auto const shader_type = get_shader_type(shader_path);
-        auto const shader = create_shader(src->c_str(), shader_type);
+        auto const shader = create_shader(sources.at(i++).c_str(), shader_type);
         if (!shader.has_value()) {
             glDeleteProgram(prog_id);
             return std::nullopt;
         }
         glAttachShader(prog_id, shader.value().id());
     }
+    if (binary_path.has_value()) {
+        glProgramParameteri(prog_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(prog_id);
     {
         GLint success = 0;
@@ -138,20 +311,54 @@ auto Program::create_and_link(std::initializer_list<std::filesystem::path> shade
             return std::nullopt;
         }
     }
-    return Program{prog_id};
+    if (binary_path.has_value()) {
+        save_binary(prog_id, binary_path.value());
+    }
+    return Program{prog_id, uniform_locations(prog_id)};
+}
+
+auto program_cache_dir() -> std::optional<std::filesystem::path> {
+    // NOLINTBEGIN(concurrency-mt-unsafe)
+    if (auto const *const cache_home = std::getenv("XDG_CACHE_HOME"); cache_home != nullptr) {
+        return std::filesystem::path{cache_home} / "mandelbrot";
+    }
+    if (auto const *const home = std::getenv("HOME"); home != nullptr) {
+        return std::filesystem::path{home} / ".cache" / "mandelbrot";
+    }
+    // NOLINTEND(concurrency-mt-unsafe)
+    return std::nullopt;
 }
 
 auto Program::use() const -> void {
     glUseProgram(m_prog_id);
 }
 
+auto Program::bind_uniform_block(std::string_view name, GLuint binding, std::size_t size) const
+    -> void {
+    auto const index = glGetUniformBlockIndex(m_prog_id, std::string{name}.c_str());
+    if (index == GL_INVALID_INDEX) {
+        fmt::println(stderr, "Invalid uniform block name: {}", name);
+        std::abort();
+    }
+    auto block_size = GLint{};
+    glGetActiveUniformBlockiv(m_prog_id, index, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+    if (static_cast<std::size_t>(block_size) != size) {
+        fmt::println(stderr, "Uniform block {} is {} bytes, not {}.", name, block_size, size);
+        std::abort();
+    }
+    glUniformBlockBinding(m_prog_id, index, binding);
+}
+
 auto Program::get_uniform_location(std::string_view name) const -> GLint {
-    auto const loc = glGetUniformLocation(m_prog_id, name.data());
-    if (loc == -1) {
+    auto const it = std::ranges::lower_bound(
+        m_locations, name, {}, [](auto const &location) -> std::string_view {
+            return location.first;
+        });
+    if (it == m_locations.end() || it->first != name) {
         fmt::println(stderr, "Invalid uniform name: {}", name);
         std::abort();
     }
-    return loc;
+    return it->second;
 }
 
 Program::~Program() {
@@ -2,17 +2,55 @@
 #define PROGRAM_HPP
 
 #include "glad/glad.h"
+#include <algorithm>
+#include <cstddef>
 #include <filesystem>
 #include <initializer_list>
 #include <optional>
+#include <span>
+#include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace gl {
+// A uniform name checked at compile time against Names, the uniforms a shader declares: a typo
+// fails to build instead of aborting at the first set_uniform().
+template <auto const &Names>
+class CheckedUniform {
+public:
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    consteval CheckedUniform(std::string_view name)
+        : m_name{name} {
+        if (std::ranges::find(Names, name) == Names.end()) {
+            throw "Not a uniform of this shader";
+        }
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    constexpr operator std::string_view() const {
+        return m_name;
+    }
+
+private:
+    std::string_view m_name;
+};
+
 class Program {
 public:
+    // #define name value, added to every shader of the program right after #version.
+    struct Define {
+        std::string_view name;
+        std::string value;
+    };
+
+    // With cache_dir, the linked program is saved there as a binary and later calls load it
+    // instead of compiling, as long as the sources, defines and driver are the same.
     [[nodiscard]] static auto create_and_link(
-        std::initializer_list<std::filesystem::path> shader_paths) -> std::optional<Program>;
+        std::initializer_list<std::filesystem::path> shader_paths,
+        std::span<Define const> defines = {},
+        std::optional<std::filesystem::path> const &cache_dir = std::nullopt)
+        -> std::optional<Program>;
 
     Program(Program const &) = delete;
     auto operator=(Program const &) -> Program & = delete;
@@ -23,10 +61,18 @@ public:
 
     auto use() const -> void;
 
+    // Binds a std140 uniform block to a uniform buffer binding point. Aborts unless the block
+    // is size bytes, the size of its host copy.
+    auto bind_uniform_block(std::string_view name, GLuint binding, std::size_t size) const -> void;
+
+    // Makes the program current: uniforms always apply to the current program.
     template <typename T>
     auto set_uniform(std::string_view name, T value) const -> void {
+        use();
         auto const loc = get_uniform_location(name);
-        if constexpr (std::is_same_v<T, float>) {
+        if constexpr (std::is_same_v<T, bool>) {
+            glUniform1i(loc, value ? GL_TRUE : GL_FALSE);
+        } else if constexpr (std::is_same_v<T, float>) {
             glUniform1f(loc, value);
         } else if constexpr (std::is_same_v<T, GLint>) {
             glUniform1i(loc, value);
@@ -34,6 +80,8 @@ public:
             glUniform1ui(loc, value);
         } else if constexpr (std::is_same_v<T, std::pair<float, float>>) {
             glUniform2f(loc, value.first, value.second);
+        } else if constexpr (std::is_same_v<T, std::pair<GLint, GLint>>) {
+            glUniform2i(loc, value.first, value.second);
         } else {
             static_assert(false, "Unsupported uniform value");
         }
@@ -42,14 +90,22 @@ public:
 private:
     inline static constexpr auto s_invalid_program_id = GLint{0};
 
-    explicit Program(GLuint prog_id)
-        : m_prog_id{prog_id} {
+    // Uniform name and location, sorted by name.
+    using Locations = std::vector<std::pair<std::string, GLint>>;
+
+    explicit Program(GLuint prog_id, Locations locations)
+        : m_prog_id{prog_id}
+        , m_locations{std::move(locations)} {
     }
 
+    // Lookup in the locations resolved at link time.
     [[nodiscard]] auto get_uniform_location(std::string_view name) const -> GLint;
 
     GLuint m_prog_id;
+    Locations m_locations;
 };
 
+// Per user cache directory for program binaries, if there is one.
+[[nodiscard]] auto program_cache_dir() -> std::optional<std::filesystem::path>;
 }  // namespace gl
 #endif
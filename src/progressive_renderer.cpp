@@ -0,0 +1,363 @@
+#include "progressive_renderer.hpp"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "antialias.hpp"
+#include "framebuffer.hpp"
+#include "gpu_timer.hpp"
+#include "hybrid_split.hpp"
+#include "program.hpp"
+#include "shaders.hpp"
+#include "tile_atlas.hpp"
+#include "trace.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// (count, smooth escape fraction) per pixel.
+[[nodiscard]] auto make_iterations_target() -> gl::Framebuffer {
+    return gl::Framebuffer::make(GL_RG32F, GL_RG, GL_FLOAT);
+}
+
+}  // namespace
+
+namespace gl {
+
+ProgressiveRenderer::ProgressiveRenderer(Program const &iterations,
+                                         Program const &colors,
+                                         std::function<void()> draw,
+                                         int w,
+                                         int h,
+                                         int max_samples)
+    : m_iterations{iterations}
+    , m_colors{colors}
+    , m_draw{std::move(draw)}
+    , m_preview{make_iterations_target()}
+    , m_images{make_iterations_target(), make_iterations_target()}
+    , m_supersampled{make_iterations_target()}
+    , m_width{w}
+    , m_height{h}
+    , m_sample_side{aa::grid_side(max_samples)}
+    , m_split_timer{SpanTimer::make()}
+    , m_preview_timer{SpanTimer::make()} {
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_max_size);
+    m_colors.get().set_uniform(shaders::ColorUniform{"iterations"sv},
+                               static_cast<GLint>(s_iterations_unit));
+}
+
+auto ProgressiveRenderer::set_iterations(Program const &iterations) -> void {
+    m_iterations = iterations;
+}
+
+auto ProgressiveRenderer::set_tile_source(std::unique_ptr<TileSource> source) -> void {
+    m_tiles = std::move(source);
+}
+
+auto ProgressiveRenderer::set_cpu_rows(std::unique_ptr<CpuRows> rows) -> void {
+    m_cpu_rows = std::move(rows);
+}
+
+auto ProgressiveRenderer::invalidate() -> void {
+    m_image_valid = false;
+    m_pan_x = 0;
+    m_pan_y = 0;
+    m_stage = Stage::COARSE;
+    ++m_generation;
+}
+
+auto ProgressiveRenderer::resize(int w, int h) -> void {
+    m_width = w;
+    m_height = h;
+    invalidate();
+}
+
+auto ProgressiveRenderer::pan(int dx, int dy) -> void {
+    if (!m_image_valid) {
+        invalidate();
+        return;
+    }
+    m_pan_x += dx;
+    m_pan_y += dy;
+    m_stage = Stage::FULL;
+}
+
+auto ProgressiveRenderer::recolor() -> void {
+    m_recolor = true;
+}
+
+auto ProgressiveRenderer::set_motion(std::optional<double> scale) -> void {
+    m_motion_scale = scale;
+}
+
+auto ProgressiveRenderer::stage() const -> Stage {
+    return m_stage;
+}
+
+auto ProgressiveRenderer::done() const -> bool {
+    return m_stage == Stage::DONE && !m_recolor;
+}
+
+auto ProgressiveRenderer::preview_current() const -> bool {
+    return m_preview_generation == m_generation;
+}
+
+auto ProgressiveRenderer::preview_counts() const -> std::vector<std::uint32_t> {
+    auto texels = std::vector<float>(static_cast<std::size_t>(m_preview.width())
+                                     * static_cast<std::size_t>(m_preview.height()));
+    m_preview.read(GL_RED, GL_FLOAT, texels.data());
+    auto counts = std::vector<std::uint32_t>{};
+    counts.reserve(texels.size());
+    for (auto const texel : texels) {
+        counts.push_back(static_cast<std::uint32_t>(texel));
+    }
+    return counts;
+}
+
+auto ProgressiveRenderer::split() const -> hybrid::Balancer const & {
+    return m_balancer;
+}
+
+auto ProgressiveRenderer::poll_preview_time() -> std::optional<PreviewTime> {
+    auto const sample = m_preview_timer.poll();
+    if (!sample.has_value()) {
+        return std::nullopt;
+    }
+    return PreviewTime{.scale = std::bit_cast<double>(sample->tag), .ms = sample->ms};
+}
+
+auto ProgressiveRenderer::render_next() -> void {
+    // A view seen before: its last pass is composed right away.
+    if ((m_stage == Stage::COARSE || m_stage == Stage::FULL)
+        && tile_coverage() == TileAtlas::Coverage::COMPLETE) {
+        m_stage = Stage::SUPERSAMPLED;
+    }
+    if (held_back()) {
+        if (m_presented.has_value()) {
+            present(m_presented.value());
+        }
+        m_recolor = false;
+        return;
+    }
+    switch (m_stage) {
+    case Stage::COARSE: {
+        auto const zone = trace::Zone{"coarse pass"};
+        auto const [w, h] = preview_size();
+        if (m_motion_scale.has_value()) {
+            m_preview_timer.begin(std::bit_cast<std::uint64_t>(m_motion_scale.value()));
+            compute(m_preview, w, h);
+            m_preview_timer.end();
+        } else {
+            compute(m_preview, w, h);
+        }
+        m_preview_generation = m_generation;
+        present(Stage::COARSE);
+        m_stage = Stage::FULL;
+        break;
+    }
+    case Stage::FULL: {
+        auto const zone = trace::Zone{"full pass"};
+        compute_full();
+        present(Stage::FULL);
+        m_stage = supersampled_size().has_value() ? Stage::SUPERSAMPLED : Stage::DONE;
+        break;
+    }
+    case Stage::SUPERSAMPLED: {
+        auto const zone = trace::Zone{"supersampled pass"};
+        auto const [w, h] = supersampled_size().value();
+        if (tile_coverage() != TileAtlas::Coverage::NONE) {
+            m_tiles->compose(m_supersampled, w, h);
+        } else {
+            compute(m_supersampled, w, h, m_sample_side);
+        }
+        present(Stage::SUPERSAMPLED);
+        m_stage = Stage::DONE;
+        break;
+    }
+    case Stage::DONE:
+        if (m_presented.has_value()) {
+            present(m_presented.value());
+        }
+        break;
+    }
+    m_recolor = false;
+}
+
+auto ProgressiveRenderer::compute(Framebuffer &target, int w, int h, int sample_side) -> void {
+    target.resize(w, h);
+    target.bind();
+    auto const &program = m_iterations.get();
+    program.set_uniform(shaders::IterationUniform{"view_port"sv},
+                        std::pair{static_cast<float>(w), static_cast<float>(h)});
+    if (sample_side == 1 && m_cpu_rows != nullptr && m_cpu_rows->available(w, h)) {
+        compute_split(target, w, h);
+        return;
+    }
+    if (sample_side > 1) {
+        // After the resize, which unbinds the texture of the active unit.
+        m_images.at(m_front).bind_texture(s_full_iterations_unit);
+        program.set_uniform(shaders::IterationUniform{"full_iterations"sv},
+                            static_cast<GLint>(s_full_iterations_unit));
+        program.set_uniform(shaders::IterationUniform{"edge_threshold"sv}, aa::g_edge_threshold);
+        program.set_uniform(shaders::IterationUniform{"sample_side"sv}, sample_side);
+    }
+    m_draw();
+    // The other users of the program, like the tiles, draw plain passes.
+    if (sample_side > 1) {
+        program.set_uniform(shaders::IterationUniform{"sample_side"sv}, GLint{1});
+    }
+}
+
+auto ProgressiveRenderer::compute_split(Framebuffer const &target, int w, int h) -> void {
+    while (auto const sample = m_split_timer.poll()) {
+        m_balancer.add_gpu(sample->tag, sample->ms);
+    }
+    auto const first = m_balancer.first_cpu_row(h);
+    if (first > 0) {
+        auto const zone = trace::Zone{"gpu rows"};
+        m_split_timer.begin(static_cast<std::uint64_t>(w) * static_cast<std::uint64_t>(first));
+        draw_scissored(0, 0, w, first);
+        m_split_timer.end();
+    }
+    // The GPU works on its rows while the CPU iterates the others.
+    glFlush();
+    if (first == h) {
+        return;
+    }
+    auto const start = std::chrono::steady_clock::now();
+    auto const counts = [&] {
+        auto const zone = trace::Zone{"cpu rows"};
+        return m_cpu_rows->render(w, h, first);
+    }();
+    m_balancer.add_cpu(
+        counts.size(),
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count());
+    // The smooth escape fractions are left at 0: the color pass only maps the counts.
+    auto const zone = trace::Zone{"upload cpu rows"};
+    target.write(0, first, w, h - first, GL_RED, GL_FLOAT, counts.data());
+}
+
+auto ProgressiveRenderer::compute_full() -> void {
+    auto const dx = std::exchange(m_pan_x, 0);
+    auto const dy = std::exchange(m_pan_y, 0);
+    if (!m_image_valid || std::abs(dx) >= m_width || std::abs(dy) >= m_height) {
+        compute(m_images.at(m_front), m_width, m_height);
+        m_image_valid = true;
+        return;
+    }
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+    auto const back = 1U - m_front;
+    auto &image = m_images.at(back);
+    image.resize(m_width, m_height);
+    m_images.at(m_front).blit_to(image, dx, dy);
+    m_front = back;
+    image.bind();
+    m_iterations.get().set_uniform(
+        shaders::IterationUniform{"view_port"sv},
+        std::pair{static_cast<float>(m_width), static_cast<float>(m_height)});
+    // The exposed columns over the whole height, then the exposed rows next to them.
+    draw_scissored(dx > 0 ? 0 : m_width + dx, 0, std::abs(dx), m_height);
+    draw_scissored(
+        std::max(dx, 0), dy > 0 ? 0 : m_height + dy, m_width - std::abs(dx), std::abs(dy));
+}
+
+auto ProgressiveRenderer::preview_size() const -> std::pair<int, int> {
+    if (!m_motion_scale.has_value()) {
+        return std::pair{std::max(m_width / s_coarse_divisor, 1),
+                         std::max(m_height / s_coarse_divisor, 1)};
+    }
+    auto const scaled = [&](int size) {
+        return std::max(static_cast<int>(std::lround(size * m_motion_scale.value())), 1);
+    };
+    return std::pair{scaled(m_width), scaled(m_height)};
+}
+
+auto ProgressiveRenderer::held_back() const -> bool {
+    if (!m_motion_scale.has_value()) {
+        return false;
+    }
+    switch (m_stage) {
+    case Stage::FULL:
+        // Only a pan of the kept counts is cheap.
+        return !m_image_valid;
+    case Stage::SUPERSAMPLED:
+        return tile_coverage() != TileAtlas::Coverage::COMPLETE;
+    case Stage::COARSE:
+    case Stage::DONE:
+        break;
+    }
+    return false;
+}
+
+auto ProgressiveRenderer::supersampled_size() const -> std::optional<std::pair<int, int>> {
+    if (m_sample_side == 1 || std::max(m_width, m_height) * m_sample_side > m_max_size) {
+        return std::nullopt;
+    }
+    return std::pair{m_width * m_sample_side, m_height * m_sample_side};
+}
+
+auto ProgressiveRenderer::tile_coverage() const -> TileAtlas::Coverage {
+    auto const size = supersampled_size();
+    if (m_tiles == nullptr || !size.has_value()) {
+        return TileAtlas::Coverage::NONE;
+    }
+    return m_tiles->coverage(size->first, size->second);
+}
+
+auto ProgressiveRenderer::draw_scissored(int x, int y, int w, int h) const -> void {
+    if (w == 0 || h == 0) {
+        return;
+    }
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x, y, w, h);
+    m_draw();
+    glDisable(GL_SCISSOR_TEST);
+}
+
+auto ProgressiveRenderer::present(Stage stage) -> void {
+    auto const &source = iterations(stage);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, m_width, m_height);
+    source.bind_texture(s_iterations_unit);
+    auto const &colors = m_colors.get();
+    colors.set_uniform(shaders::ColorUniform{"texel_scale"sv},
+                       std::pair{static_cast<float>(source.width()) / static_cast<float>(m_width),
+                                 static_cast<float>(source.height())
+                                     / static_cast<float>(m_height)});
+    colors.set_uniform(shaders::ColorUniform{"samples"sv},
+                       static_cast<GLint>(stage == Stage::SUPERSAMPLED ? m_sample_side : 1));
+    m_draw();
+    m_presented = stage;
+}
+
+auto ProgressiveRenderer::iterations(Stage stage) const -> Framebuffer const & {
+    switch (stage) {
+    case Stage::COARSE:
+        return m_preview;
+    case Stage::SUPERSAMPLED:
+        return m_supersampled;
+    case Stage::FULL:
+    case Stage::DONE:
+        break;
+    }
+    return m_images.at(m_front);
+}
+}  // namespace gl
@@ -0,0 +1,170 @@
+#ifndef PROGRESSIVE_RENDERER_HPP
+#define PROGRESSIVE_RENDERER_HPP
+
+#include "glad/glad.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "framebuffer.hpp"
+#include "gpu_timer.hpp"
+#include "hybrid_split.hpp"
+#include "program.hpp"
+#include "tile_atlas.hpp"
+
+namespace gl {
+// Renders the fractal in passes of increasing quality, one per frame: a coarse preview, then
+// full resolution, then supersampled where the full resolution counts have edges (adaptive
+// mode of shader.frag). Any change of the view restarts from the preview, and
+// once the last pass is on screen there is nothing left to draw until the next change. While
+// the camera moves, previews are rendered at the resolution the owner sets and upscaled, and
+// the later passes wait for the camera to stop, except for the strips exposed by a pan.
+// Each pass computes iteration counts into a texture, which a cheap color pass then maps to the
+// screen: a color map change only reruns the color pass. The full resolution counts are kept,
+// so that a pan only computes the newly exposed strips. With a tile source, the supersampled
+// counts are composed from cached tiles, and a view whose tiles are all cached skips the other
+// passes. With a CPU source, the top rows of the preview and full resolution passes are
+// iterated on the CPU while the GPU iterates the others (hybrid::Balancer), then uploaded.
+class ProgressiveRenderer {
+public:
+    // Tiles of the current view, provided by its owner (TileAtlas).
+    class TileSource {
+    public:
+        virtual ~TileSource() = default;
+        // Of a w x h target.
+        [[nodiscard]] virtual auto coverage(int w, int h) const -> TileAtlas::Coverage = 0;
+        virtual auto compose(Framebuffer &target, int w, int h) -> void = 0;
+    };
+
+    // CPU iteration of the current view, provided by its owner (cpu::Renderer).
+    class CpuRows {
+    public:
+        virtual ~CpuRows() = default;
+        // Whether the CPU iterates the view of a w x h pass like the current program.
+        [[nodiscard]] virtual auto available(int w, int h) const -> bool = 0;
+        // Counts of the rows [first, h) of a w x h pass, bottom row first, valid until the next
+        // call.
+        virtual auto render(int w, int h, int first) -> std::span<float const> = 0;
+    };
+
+    enum class Stage {
+        COARSE,
+        FULL,
+        SUPERSAMPLED,
+        DONE,
+    };
+
+    // Pixels per side of a preview pixel.
+    inline static constexpr auto s_coarse_divisor = 4;
+    // Texture unit of the iterations sampler of the color pass.
+    inline static constexpr auto s_iterations_unit = GLuint{1};
+    // Texture unit of the full resolution counts read by the supersampled pass.
+    inline static constexpr auto s_full_iterations_unit = GLuint{5};
+
+    // draw renders the full viewport with the current program. iterations must have the
+    // uniforms of shader.frag, colors the ones of color.frag. Edge pixels get up to max_samples
+    // samples (aa::grid_side()), 1 leaves out the supersampled pass.
+    ProgressiveRenderer(Program const &iterations,
+                        Program const &colors,
+                        std::function<void()> draw,
+                        int w,
+                        int h,
+                        int max_samples);
+
+    // Program of the next iteration passes, with the same uniforms.
+    auto set_iterations(Program const &iterations) -> void;
+    auto set_tile_source(std::unique_ptr<TileSource> source) -> void;
+    auto set_cpu_rows(std::unique_ptr<CpuRows> rows) -> void;
+    // The view changed: start over from the preview.
+    auto invalidate() -> void;
+    auto resize(int w, int h) -> void;
+    // The view moved by whole pixels: the content shows up dx, dy pixels further (GL window
+    // coordinates). Goes straight to full resolution when the last full image can be reused.
+    auto pan(int dx, int dy) -> void;
+    // Only the color pass changed: shows the last iterations again.
+    auto recolor() -> void;
+    // The camera moves: previews have scale of the full resolution along each side, until
+    // nullopt, when the passes held back resume.
+    auto set_motion(std::optional<double> scale) -> void;
+
+    [[nodiscard]] auto stage() const -> Stage;
+    [[nodiscard]] auto done() const -> bool;
+    // Whether the last preview was rendered since the last invalidate(): a view whose tiles are
+    // all cached skips it.
+    [[nodiscard]] auto preview_current() const -> bool;
+    // Counts of the last preview, a cheap sample of the view if preview_current().
+    [[nodiscard]] auto preview_counts() const -> std::vector<std::uint32_t>;
+    // Split of the passes between the GPU and the CPU rows.
+    [[nodiscard]] auto split() const -> hybrid::Balancer const &;
+
+    struct PreviewTime {
+        double scale;
+        double ms;
+    };
+    // GPU time of the iteration pass of the oldest preview rendered with set_motion(), once
+    // available.
+    [[nodiscard]] auto poll_preview_time() -> std::optional<PreviewTime>;
+
+    // Renders the current stage into the default framebuffer and moves to the next one.
+    auto render_next() -> void;
+
+private:
+    // Iteration pass over the whole target, resized to w x h, adaptive with sample_side above 1.
+    auto compute(Framebuffer &target, int w, int h, int sample_side = 1) -> void;
+    // Plain pass shared with the CPU rows, the target being bound.
+    auto compute_split(Framebuffer const &target, int w, int h) -> void;
+    // Brings the kept full resolution counts up to date.
+    auto compute_full() -> void;
+    [[nodiscard]] auto preview_size() const -> std::pair<int, int>;
+    // The current stage is too slow to render while the camera moves.
+    [[nodiscard]] auto held_back() const -> bool;
+    [[nodiscard]] auto supersampled_size() const -> std::optional<std::pair<int, int>>;
+    [[nodiscard]] auto tile_coverage() const -> TileAtlas::Coverage;
+    auto draw_scissored(int x, int y, int w, int h) const -> void;
+    // Color pass of the counts of a stage to the default framebuffer.
+    auto present(Stage stage) -> void;
+    [[nodiscard]] auto iterations(Stage stage) const -> Framebuffer const &;
+
+    std::reference_wrapper<Program const> m_iterations;
+    std::reference_wrapper<Program const> m_colors;
+    std::function<void()> m_draw;
+    std::unique_ptr<TileSource> m_tiles;
+    Framebuffer m_preview;
+    // Full resolution counts, the front ones and the ones the next pan is copied into.
+    std::array<Framebuffer, 2> m_images;
+    Framebuffer m_supersampled;
+    std::size_t m_front{0};
+    // The front counts show the view as of the last full resolution pass, moved by m_pan.
+    bool m_image_valid{false};
+    int m_pan_x{0};
+    int m_pan_y{0};
+    int m_width;
+    int m_height;
+    // Samples per side of a supersampled pixel.
+    int m_sample_side;
+    std::unique_ptr<CpuRows> m_cpu_rows;
+    hybrid::Balancer m_balancer;
+    // GPU time of its rows, tagged with their pixel count.
+    SpanTimer m_split_timer;
+    // GPU time of the previews while moving, tagged with their scale (std::bit_cast).
+    SpanTimer m_preview_timer;
+    int m_max_size{0};
+    std::optional<double> m_motion_scale;
+    Stage m_stage{Stage::COARSE};
+    // Views started by invalidate(), and the one of the last preview.
+    std::uint64_t m_generation{1};
+    std::uint64_t m_preview_generation{0};
+    // Last stage on screen, and whether it must be colored again.
+    std::optional<Stage> m_presented;
+    bool m_recolor{false};
+};
+}  // namespace gl
+
+#endif
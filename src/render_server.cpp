@@ -0,0 +1,467 @@
+#include "render_server.hpp"
+
+#include "cpu_renderer.hpp"
+#include "fixed.hpp"
+#include "fmt/base.h"
+#include "perturbation.hpp"
+#include "socket.hpp"
+#include "tile_scheduler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// First field of a request, so that a client of another version is turned away.
+constexpr auto g_magic = std::uint32_t{0x4d425431};  // NOLINT "MBT1"
+
+// No message is larger.
+constexpr auto g_max_message = std::uint32_t{64U << 20U};  // NOLINT
+
+// Compressed, a count takes at most a run of one and a 33-bit zigzag difference: 6 bytes.
+constexpr auto g_max_bytes_per_count = std::size_t{6};
+
+// No area is larger, so that its reply fits in a message however incompressible its counts.
+constexpr auto g_max_area_pixels = std::size_t{g_max_message} / g_max_bytes_per_count;
+
+// Requests sent ahead of the reply being read, so that a server never waits for the next one.
+constexpr auto g_in_flight = std::size_t{2};
+
+// A binary fraction of n bits has exactly n decimal digits: the offsets of the camera go over
+// the wire exactly.
+constexpr auto g_offset_digits = (mp::Fixed::s_max_limbs - 1) * 64;  // NOLINT
+
+class MessageWriter {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto put(T value) -> void {
+        auto const offset = m_bytes.size();
+        m_bytes.resize(offset + sizeof(T));
+        std::memcpy(m_bytes.data() + offset, &value, sizeof(T));
+    }
+
+    auto put(std::string_view str) -> void {
+        put(static_cast<std::uint32_t>(str.size()));
+        auto const offset = m_bytes.size();
+        m_bytes.resize(offset + str.size());
+        std::memcpy(m_bytes.data() + offset, str.data(), str.size());
+    }
+
+    [[nodiscard]] auto bytes() const -> std::span<std::byte const> {
+        return m_bytes;
+    }
+
+private:
+    std::vector<std::byte> m_bytes;
+};
+
+class MessageReader {
+public:
+    explicit MessageReader(std::span<std::byte const> bytes)
+        : m_bytes{bytes} {
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] auto get() -> std::optional<T> {
+        if (m_bytes.size() < sizeof(T)) {
+            return std::nullopt;
+        }
+        auto value = T{};
+        std::memcpy(&value, m_bytes.data(), sizeof(T));
+        m_bytes = m_bytes.subspan(sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] auto get_string() -> std::optional<std::string> {
+        auto const size = get<std::uint32_t>();
+        if (!size.has_value() || m_bytes.size() < size.value()) {
+            return std::nullopt;
+        }
+        auto str = std::string{reinterpret_cast<char const *>(m_bytes.data()),  // NOLINT
+                               size.value()};
+        m_bytes = m_bytes.subspan(size.value());
+        return str;
+    }
+
+private:
+    std::span<std::byte const> m_bytes;
+};
+
+auto send_message(net::Socket &socket, std::span<std::byte const> payload) -> bool {
+    auto const size = static_cast<std::uint32_t>(payload.size());
+    return socket.write(std::as_bytes(std::span{&size, 1})) && socket.write(payload);
+}
+
+auto receive_message(net::Socket &socket, std::vector<std::byte> &payload) -> bool {
+    auto size = std::uint32_t{};
+    if (!socket.read(std::as_writable_bytes(std::span{&size, 1})) || size > g_max_message) {
+        return false;
+    }
+    payload.resize(size);
+    return socket.read(payload);
+}
+
+auto encode(remote::Request const &request) -> MessageWriter {
+    auto message = MessageWriter{};
+    message.put(g_magic);
+    message.put(request.max_iters);
+    message.put(request.camera.zoom);
+    for (auto const value : {request.camera.width,
+                             request.camera.height,
+                             request.area.x,
+                             request.area.y,
+                             request.area.width,
+                             request.area.height}) {
+        message.put(value);
+    }
+    message.put(request.camera.x_offset.to_string(g_offset_digits));
+    message.put(request.camera.y_offset.to_string(g_offset_digits));
+    return message;
+}
+
+// Anything malformed, including an area outside the frame, is rejected.
+auto decode(std::span<std::byte const> payload) -> std::optional<remote::Request> {
+    auto message = MessageReader{payload};
+    if (message.get<std::uint32_t>() != g_magic) {
+        return std::nullopt;
+    }
+    auto const max_iters = message.get<std::uint32_t>();
+    auto const zoom = message.get<double>();
+    auto ints = std::array<int, 6>{};  // NOLINT
+    for (auto &value : ints) {
+        auto const parsed = message.get<int>();
+        if (!parsed.has_value()) {
+            return std::nullopt;
+        }
+        value = parsed.value();
+    }
+    auto const x = message.get_string();
+    auto const y = message.get_string();
+    if (!max_iters.has_value() || !zoom.has_value() || !x.has_value() || !y.has_value()) {
+        return std::nullopt;
+    }
+    auto const x_offset = mp::Fixed::parse(x.value());
+    auto const y_offset = mp::Fixed::parse(y.value());
+    if (!x_offset.has_value() || !y_offset.has_value()) {
+        return std::nullopt;
+    }
+    auto const [width, height, area_x, area_y, area_width, area_height] = ints;
+    auto const request = remote::Request{
+        .camera = deep::Camera{
+            .x_offset = x_offset.value(),
+            .y_offset = y_offset.value(),
+            .zoom = zoom.value(),
+            .width = width,
+            .height = height,
+        },
+        .max_iters = max_iters.value(),
+        .area = cpu::Tile{.x = area_x, .y = area_y, .width = area_width, .height = area_height},
+    };
+    if (zoom.value() <= 0.0 || max_iters.value() == 0 || area_x < 0 || area_y < 0
+        || area_width <= 0 || area_height <= 0
+        || std::int64_t{area_x} + std::int64_t{area_width} > std::int64_t{width}
+        || std::int64_t{area_y} + std::int64_t{area_height} > std::int64_t{height}
+        || static_cast<std::uint64_t>(area_width) * static_cast<std::uint64_t>(area_height)
+               > g_max_area_pixels) {
+        return std::nullopt;
+    }
+    return request;
+}
+
+auto put_varint(std::uint64_t value, std::vector<std::byte> &out) -> void {
+    while (value >= 0x80U) {  // NOLINT
+        out.push_back(static_cast<std::byte>((value & 0x7fU) | 0x80U));  // NOLINT
+        value >>= 7U;                                                  // NOLINT
+    }
+    out.push_back(static_cast<std::byte>(value));
+}
+
+auto get_varint(std::span<std::byte const> &data) -> std::optional<std::uint64_t> {
+    auto value = std::uint64_t{0};
+    for (auto shift = 0U; shift < 64U && !data.empty(); shift += 7U) {  // NOLINT
+        auto const byte = std::to_integer<std::uint64_t>(data.front());
+        data = data.subspan(1);
+        value |= (byte & 0x7fU) << shift;  // NOLINT
+        if ((byte & 0x80U) == 0) {         // NOLINT
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+// A request, rendered with the renderer of the server.
+class Session {
+public:
+    Session(net::Socket socket, cpu::Renderer &renderer, std::mutex &renderer_mutex)
+        : m_socket{std::move(socket)}
+        , m_renderer{renderer}
+        , m_renderer_mutex{renderer_mutex} {
+    }
+
+    // Until the client disconnects or sends something invalid.
+    auto run() -> void {
+        auto payload = std::vector<std::byte>{};
+        auto counts = std::vector<std::uint32_t>{};
+        while (receive_message(m_socket, payload)) {
+            auto const request = decode(payload);
+            if (!request.has_value()) {
+                fmt::println(stderr, "Invalid request, closing the connection.");
+                return;
+            }
+            counts.resize(static_cast<std::size_t>(request->area.width)
+                          * static_cast<std::size_t>(request->area.height));
+            render(request.value(), counts);
+            if (!send_message(m_socket, remote::compress(counts))) {
+                return;
+            }
+        }
+    }
+
+private:
+    auto render(remote::Request const &request, std::span<std::uint32_t> counts) -> void {
+        auto const &camera = request.camera;
+        if (!camera.needs_perturbation()) {
+            auto const lock = std::scoped_lock{m_renderer_mutex};
+            m_renderer.render_area(camera.to_view(), request.area, request.max_iters, counts);
+            return;
+        }
+        // The areas of an image share their reference orbit.
+        auto const key = encode(remote::Request{
+            .camera = camera,
+            .max_iters = request.max_iters,
+            .area = cpu::Tile{},
+        });
+        if (!m_orbit.has_value() || !std::ranges::equal(key.bytes(), m_orbit_key)) {
+            m_orbit = deep::ReferenceOrbit::compute(camera, request.max_iters);
+            m_orbit_key.assign(key.bytes().begin(), key.bytes().end());
+        }
+        auto const lock = std::scoped_lock{m_renderer_mutex};
+        m_renderer.render_area(camera, m_orbit.value(), request.area, request.max_iters, counts);
+    }
+
+    net::Socket m_socket;
+    cpu::Renderer &m_renderer;
+    std::mutex &m_renderer_mutex;
+    std::optional<deep::ReferenceOrbit> m_orbit;
+    std::vector<std::byte> m_orbit_key;
+};
+
+// Bands of rows, bottom first, full width unless that makes an area larger than a message
+// allows.
+auto make_areas(int width, int height) -> std::deque<cpu::Tile> {
+    auto const max_width
+        = static_cast<int>(std::min(g_max_area_pixels / std::size_t{remote::g_area_rows},
+                                    static_cast<std::size_t>(width)));
+    auto areas = std::deque<cpu::Tile>{};
+    for (auto y = 0; y < height; y += remote::g_area_rows) {
+        for (auto x = 0; x < width; x += max_width) {
+            areas.push_back(cpu::Tile{
+                .x = x,
+                .y = y,
+                .width = std::min(max_width, width - x),
+                .height = std::min(remote::g_area_rows, height - y),
+            });
+        }
+    }
+    return areas;
+}
+
+}  // namespace
+
+namespace remote {
+
+auto compress(std::span<std::uint32_t const> counts) -> std::vector<std::byte> {
+    auto out = std::vector<std::byte>{};
+    auto previous = std::int64_t{0};
+    for (auto i = std::size_t{0}; i < counts.size();) {
+        auto const value = counts[i];
+        auto run = std::size_t{1};
+        while (i + run < counts.size() && counts[i + run] == value) {
+            ++run;
+        }
+        auto const delta = static_cast<std::int64_t>(value) - previous;
+        put_varint(run, out);
+        // Zigzag: small differences of either sign take few bytes.
+        put_varint((static_cast<std::uint64_t>(delta) << 1U)
+                       ^ static_cast<std::uint64_t>(delta >> 63),  // NOLINT
+                   out);
+        previous = value;
+        i += run;
+    }
+    return out;
+}
+
+auto decompress(std::span<std::byte const> data, std::span<std::uint32_t> counts) -> bool {
+    auto previous = std::int64_t{0};
+    auto filled = std::size_t{0};
+    while (!data.empty()) {
+        auto const run = get_varint(data);
+        auto const zigzag = get_varint(data);
+        if (!run.has_value() || !zigzag.has_value() || run.value() > counts.size() - filled) {
+            return false;
+        }
+        auto const delta = static_cast<std::int64_t>(zigzag.value() >> 1U)
+                         ^ -static_cast<std::int64_t>(zigzag.value() & 1U);
+        previous += delta;
+        if (previous < 0 || previous > UINT32_MAX) {
+            return false;
+        }
+        std::ranges::fill(counts.subspan(filled, run.value()),
+                          static_cast<std::uint32_t>(previous));
+        filled += run.value();
+    }
+    return filled == counts.size();
+}
+
+auto serve(net::Listener &listener, cpu::Renderer::Options const &options) -> void {
+    auto renderer = cpu::Renderer{options};
+    auto renderer_mutex = std::mutex{};
+    // Sessions that ended are joined when the next client connects, so that a long running
+    // server only keeps the threads of live clients and of the last ones.
+    struct Running {
+        std::unique_ptr<std::atomic<bool>> done;
+        std::jthread thread;
+    };
+    auto sessions = std::vector<Running>{};
+    while (auto socket = listener.accept()) {
+        std::erase_if(sessions, [](Running const &running) {
+            return running.done->load(std::memory_order_acquire);
+        });
+        auto done = std::make_unique<std::atomic<bool>>(false);
+        auto thread = std::jthread{[session = Session{std::move(socket).value(),
+                                                      renderer,
+                                                      renderer_mutex},
+                                    &done = *done]() mutable {
+            session.run();
+            done.store(true, std::memory_order_release);
+        }};
+        sessions.push_back(Running{.done = std::move(done), .thread = std::move(thread)});
+    }
+}
+
+auto Client::connect(std::span<net::Address const> servers) -> std::optional<Client> {
+    auto sockets = std::vector<net::Socket>{};
+    for (auto const &address : servers) {
+        if (auto socket = net::Socket::connect(address)) {
+            sockets.push_back(std::move(socket).value());
+        }
+    }
+    if (sockets.empty()) {
+        return std::nullopt;
+    }
+    return Client{std::move(sockets)};
+}
+
+Client::Client(std::vector<net::Socket> servers)
+    : m_servers{std::move(servers)} {
+}
+
+auto Client::server_count() const -> std::size_t {
+    return m_servers.size();
+}
+
+auto Client::render(deep::Camera const &camera,
+                    std::uint32_t max_iters,
+                    std::span<std::uint32_t> out) -> bool {
+    auto const stride = static_cast<std::size_t>(camera.width);
+    auto pending = make_areas(camera.width, camera.height);
+    auto mutex = std::mutex{};
+    auto const next_area = [&]() -> std::optional<cpu::Tile> {
+        auto const lock = std::scoped_lock{mutex};
+        if (pending.empty()) {
+            return std::nullopt;
+        }
+        auto const area = pending.front();
+        pending.pop_front();
+        return area;
+    };
+    // Each server sends the areas it was given back in order. Returns false, with the areas it
+    // had not returned put back, if it fails.
+    auto const feed = [&](net::Socket &server) {
+        auto in_flight = std::deque<cpu::Tile>{};
+        auto reply = std::vector<std::byte>{};
+        auto area_counts = std::vector<std::uint32_t>{};
+        auto ok = true;
+        while (ok) {
+            while (in_flight.size() < g_in_flight) {
+                auto const area = next_area();
+                if (!area.has_value()) {
+                    break;
+                }
+                in_flight.push_back(area.value());
+                auto const request
+                    = Request{.camera = camera, .max_iters = max_iters, .area = area.value()};
+                if (!send_message(server, encode(request).bytes())) {
+                    ok = false;
+                    break;
+                }
+            }
+            if (!ok || in_flight.empty()) {
+                break;
+            }
+            auto const area = in_flight.front();
+            auto const area_width = static_cast<std::size_t>(area.width);
+            auto const rows = static_cast<std::size_t>(area.height);
+            if (area_width == stride) {
+                // The counts of a full width band are contiguous in out.
+                auto const counts
+                    = out.subspan(static_cast<std::size_t>(area.y) * stride, rows * stride);
+                ok = receive_message(server, reply) && decompress(reply, counts);
+            } else {
+                area_counts.resize(area_width * rows);
+                ok = receive_message(server, reply) && decompress(reply, area_counts);
+                for (auto row = std::size_t{0}; ok && row < rows; ++row) {
+                    std::ranges::copy(
+                        std::span{area_counts}.subspan(row * area_width, area_width),
+                        out.begin()
+                            + static_cast<std::ptrdiff_t>(
+                                (static_cast<std::size_t>(area.y) + row) * stride
+                                + static_cast<std::size_t>(area.x)));
+                }
+            }
+            if (ok) {
+                in_flight.pop_front();
+            }
+        }
+        if (!ok) {
+            auto const lock = std::scoped_lock{mutex};
+            pending.insert(pending.end(), in_flight.begin(), in_flight.end());
+        }
+        return ok;
+    };
+    // Areas given back by a failed server are taken over by the others in another round.
+    while (!pending.empty() && !m_servers.empty()) {
+        auto failed = std::vector<char>(m_servers.size(), 0);
+        {
+            auto threads = std::vector<std::jthread>{};
+            for (auto i = std::size_t{0}; i < m_servers.size(); ++i) {
+                threads.emplace_back([&, i] { failed[i] = feed(m_servers[i]) ? 0 : 1; });
+            }
+        }
+        for (auto i = m_servers.size(); i-- > 0;) {
+            if (failed[i] != 0) {
+                fmt::println(stderr, "Render server {} failed, dropping it.", i);
+                m_servers.erase(m_servers.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+    }
+    return pending.empty();
+}
+}  // namespace remote
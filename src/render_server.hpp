@@ -0,0 +1,63 @@
+#ifndef RENDER_SERVER_HPP
+#define RENDER_SERVER_HPP
+
+#include "cpu_renderer.hpp"
+#include "perturbation.hpp"
+#include "socket.hpp"
+#include "tile_scheduler.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Distributed rendering: servers render areas of an image on request and send the counts back
+// compressed, a client spreads the areas of its images over several servers. Messages are a
+// 4-byte size followed by the payload, integers in host byte order: servers and clients must
+// share it.
+namespace remote {
+// Rows of the areas the client asks for: enough work per request that the round trip is
+// negligible, little enough that the last areas keep every server busy.
+inline constexpr auto g_area_rows = 32;
+
+struct Request {
+    deep::Camera camera;
+    std::uint32_t max_iters;
+    cpu::Tile area;
+};
+
+// Runs of equal counts, each stored as its length and its difference from the previous count,
+// both as variable-length integers: counts change little from one pixel to the next and the
+// interior is one long run.
+[[nodiscard]] auto compress(std::span<std::uint32_t const> counts) -> std::vector<std::byte>;
+// False unless data holds exactly counts.size() counts.
+[[nodiscard]] auto decompress(std::span<std::byte const> data, std::span<std::uint32_t> counts)
+    -> bool;
+
+// Serves until accepting fails, each client on its own thread. Areas are rendered one at a time
+// by a single renderer, which uses every thread of options.
+auto serve(net::Listener &listener, cpu::Renderer::Options const &options) -> void;
+
+// Connections to render servers, each fed areas as it returns the previous ones.
+class Client {
+public:
+    // Servers that cannot be reached are left out, with a message.
+    [[nodiscard]] static auto connect(std::span<net::Address const> servers)
+        -> std::optional<Client>;
+
+    // out holds camera.width * camera.height counts, bottom row first. The areas of a server
+    // that fails go to the others; false if they all did.
+    [[nodiscard]] auto render(deep::Camera const &camera,
+                              std::uint32_t max_iters,
+                              std::span<std::uint32_t> out) -> bool;
+
+    [[nodiscard]] auto server_count() const -> std::size_t;
+
+private:
+    explicit Client(std::vector<net::Socket> servers);
+
+    std::vector<net::Socket> m_servers;
+};
+}  // namespace remote
+
+#endif
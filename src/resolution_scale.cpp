@@ -0,0 +1,70 @@
+#include "resolution_scale.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace {
+
+// Weight of the newest frame in the smoothed times: a single slow frame, a reference orbit or a
+// stall, should not halve the resolution.
+constexpr auto g_smoothing = 0.25;
+
+auto smooth(std::optional<double> average, double value) -> double {
+    if (!average.has_value()) {
+        return value;
+    }
+    return average.value() + ((value - average.value()) * g_smoothing);
+}
+
+}  // namespace
+
+namespace resolution {
+
+Controller::Controller(double budget_ms, double initial_scale)
+    : m_budget_ms{budget_ms}
+    , m_scale{initial_scale} {
+}
+
+auto Controller::add_frame(double ms) -> void {
+    m_frame_ms = smooth(m_frame_ms, ms);
+    update();
+}
+
+auto Controller::add_preview(double ms, double scale) -> void {
+    m_preview_ms = smooth(m_preview_ms, ms);
+    m_full_ms = smooth(m_full_ms, ms / (scale * scale));
+    update();
+}
+
+auto Controller::update() -> void {
+    if (!m_full_ms.has_value()) {
+        return;
+    }
+    if (m_full_ms.value() <= 0.0) {
+        m_scale = 1.0;
+        return;
+    }
+    auto const fixed_ms = m_frame_ms.has_value() && m_preview_ms.has_value()
+                              ? std::max(m_frame_ms.value() - m_preview_ms.value(), 0.0)
+                              : 0.0;
+    auto const preview_budget
+        = std::max(m_budget_ms - fixed_ms, m_budget_ms * g_min_preview_share);
+    // Rounded down: the frames of the next scale stay within the budget.
+    auto const fitting = std::sqrt(preview_budget / m_full_ms.value());
+    m_scale = std::clamp(std::floor(fitting / g_scale_step) * g_scale_step, g_min_scale, 1.0);
+}
+
+auto Controller::scale() const -> double {
+    return m_scale;
+}
+
+auto Controller::budget_ms() const -> double {
+    return m_budget_ms;
+}
+
+auto Controller::frame_ms() const -> std::optional<double> {
+    return m_frame_ms;
+}
+
+}  // namespace resolution
@@ -0,0 +1,50 @@
+#ifndef RESOLUTION_SCALE_HPP
+#define RESOLUTION_SCALE_HPP
+
+#include <optional>
+
+// Resolution of the previews shown while the camera moves, chosen from the times of the last
+// ones so that frames keep to a budget: a deep view with a high iteration limit then moves at a
+// fraction of the resolution instead of at a few frames per second. Only the iteration pass of
+// a preview shrinks with it; the rest of a frame, like the color pass over the window, is a
+// fixed cost taken out of the budget first.
+namespace resolution {
+inline constexpr auto g_default_budget_ms = 16.0;
+// Share of each side of the window below which previews are not worth looking at.
+inline constexpr auto g_min_scale = 0.125;
+// Scales are multiples of it, so that the resolution does not change with every frame time.
+inline constexpr auto g_scale_step = 0.0625;
+// Share of the budget left to the previews however large the fixed cost: above the budget, it
+// cannot be helped by lowering the resolution.
+inline constexpr auto g_min_preview_share = 0.5;
+
+class Controller {
+public:
+    // The scale is initial_scale until the first frame time comes.
+    Controller(double budget_ms, double initial_scale);
+
+    // GPU time of a whole frame rendering a preview.
+    auto add_frame(double ms) -> void;
+    // GPU time of the iteration pass of a preview rendered at scale, in proportion to its
+    // pixels.
+    auto add_preview(double ms, double scale) -> void;
+
+    // Of each side of the full resolution, between g_min_scale and 1.
+    [[nodiscard]] auto scale() const -> double;
+    [[nodiscard]] auto budget_ms() const -> double;
+    // Smoothed time of the last frames, once there is one.
+    [[nodiscard]] auto frame_ms() const -> std::optional<double>;
+
+private:
+    auto update() -> void;
+
+    double m_budget_ms;
+    double m_scale;
+    std::optional<double> m_frame_ms;
+    std::optional<double> m_preview_ms;
+    // Smoothed time of the same iteration passes at full resolution.
+    std::optional<double> m_full_ms;
+};
+}  // namespace resolution
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SHADERS_HPP
+#define SHADERS_HPP
+
+#include "glad/glad.h"
+#include "program.hpp"
+#include <array>
+#include <string_view>
+
+// Host side of the interface of shader.frag (iteration pass), color.frag (color pass) and
+// tiles.frag (iteration pass from cached tiles).
+namespace shaders {
+// The default block uniforms of each shader, set with set_uniform().
+inline constexpr auto g_iteration_uniforms = std::array<std::string_view, 5>{
+    "view_port",
+    "reference_orbit",
+    "sample_side",
+    "full_iterations",
+    "edge_threshold",
+};
+
+inline constexpr auto g_color_uniforms = std::array<std::string_view, 5>{
+    "iterations",
+    "texel_scale",
+    "samples",
+    "color_tables",
+    "color_map",
+};
+
+inline constexpr auto g_tile_uniforms = std::array<std::string_view, 6>{
+    "atlas",
+    "slots_per_row",
+    "slots",
+    "layout_size",
+    "origin",
+    "spacing",
+};
+
+using IterationUniform = gl::CheckedUniform<g_iteration_uniforms>;
+using ColorUniform = gl::CheckedUniform<g_color_uniforms>;
+using TileUniform = gl::CheckedUniform<g_tile_uniforms>;
+
+// The ViewBlock uniform block of both shaders, member for member: 4-byte scalars only, so
+// that the std140 layout is the one of this struct.
+struct ViewBlock {
+    inline static constexpr auto s_name = std::string_view{"ViewBlock"};
+    inline static constexpr auto s_binding = GLuint{0};
+
+    float x_offset{0.0F};
+    float y_offset{0.0F};
+    float zoom{0.0F};
+    float x_offset_lo{0.0F};
+    float y_offset_lo{0.0F};
+    float zoom_lo{0.0F};
+    float zoom_mantissa{0.0F};
+    GLint zoom_exponent{0};
+    GLint orbit_length{0};
+    GLuint kernel{0U};
+    GLuint max_iters{0U};
+    // GLSL bool: 0 or 1 in 4 bytes.
+    GLuint interior_checks{0U};
+};
+
+static_assert(sizeof(ViewBlock) == 12 * 4);  // NOLINT
+
+// Makes the block of program read its values from the buffer bound to ViewBlock::s_binding.
+inline auto bind_view_block(gl::Program const &program) -> void {
+    program.bind_uniform_block(ViewBlock::s_name, ViewBlock::s_binding, sizeof(ViewBlock));
+}
+}  // namespace shaders
+
+#endif
@@ -0,0 +1,251 @@
+#include "socket.hpp"
+
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr auto g_unix_prefix = "unix:"sv;
+constexpr auto g_backlog = 64;
+
+// sockaddr_un of a path, if it fits.
+auto unix_address(std::string const &path) -> std::optional<sockaddr_un> {
+    auto address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        fmt::println(stderr, "Socket path too long: {}", path);
+        return std::nullopt;
+    }
+    std::memcpy(static_cast<char *>(address.sun_path), path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Calls use(fd, addrinfo) on a new socket for each resolved address until it returns true.
+template <typename Use>
+auto for_each_tcp(net::Address const &address, int flags, Use const &use) -> int {
+    auto hints = addrinfo{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+    auto *infos = static_cast<addrinfo *>(nullptr);
+    auto const host = address.host.empty() ? nullptr : address.host.c_str();
+    if (auto const err = getaddrinfo(host, address.port.c_str(), &hints, &infos); err != 0) {
+        fmt::println(stderr, "Cannot resolve {}: {}", address.to_string(), gai_strerror(err));
+        return -1;
+    }
+    auto fd = -1;
+    for (auto const *info = infos; info != nullptr && fd < 0; info = info->ai_next) {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd >= 0 && !use(fd, *info)) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(infos);
+    return fd;
+}
+
+// Requests and replies are written whole: no point in waiting for more to send.
+auto set_no_delay(int fd) -> void {
+    auto const on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+}  // namespace
+
+namespace net {
+
+auto Address::parse(std::string_view str) -> std::optional<Address> {
+    if (str.starts_with(g_unix_prefix)) {
+        auto path = str.substr(g_unix_prefix.size());
+        if (path.empty()) {
+            return std::nullopt;
+        }
+        return Address{.kind = Kind::UNIX, .host = std::string{path}, .port = {}};
+    }
+    auto const colon = str.rfind(':');
+    if (colon == std::string_view::npos || colon + 1 == str.size()) {
+        return std::nullopt;
+    }
+    return Address{
+        .kind = Kind::TCP,
+        .host = std::string{str.substr(0, colon)},
+        .port = std::string{str.substr(colon + 1)},
+    };
+}
+
+auto Address::to_string() const -> std::string {
+    if (kind == Kind::UNIX) {
+        return fmt::format("{}{}", g_unix_prefix, host);
+    }
+    return fmt::format("{}:{}", host, port);
+}
+
+auto Socket::connect(Address const &address) -> std::optional<Socket> {
+    if (address.kind == Address::Kind::UNIX) {
+        auto const sun = unix_address(address.host);
+        if (!sun.has_value()) {
+            return std::nullopt;
+        }
+        auto const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0
+            || ::connect(fd, reinterpret_cast<sockaddr const *>(&sun.value()),  // NOLINT
+                         sizeof(sockaddr_un))
+                   != 0) {
+            fmt::println(stderr, "Cannot connect to {}: {}", address.to_string(), strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+            }
+            return std::nullopt;
+        }
+        return Socket{fd};
+    }
+    auto const fd = for_each_tcp(address, 0, [](int fd, addrinfo const &info) {
+        return ::connect(fd, info.ai_addr, info.ai_addrlen) == 0;
+    });
+    if (fd < 0) {
+        fmt::println(stderr, "Cannot connect to {}: {}", address.to_string(), strerror(errno));
+        return std::nullopt;
+    }
+    set_no_delay(fd);
+    return Socket{fd};
+}
+
+Socket::Socket(int fd)
+    : m_fd{fd} {
+}
+
+Socket::Socket(Socket &&other) noexcept
+    : m_fd{std::exchange(other.m_fd, -1)} {
+}
+
+auto Socket::operator=(Socket &&other) noexcept -> Socket & {
+    std::swap(m_fd, other.m_fd);
+    return *this;
+}
+
+Socket::~Socket() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+auto Socket::read(std::span<std::byte> data) -> bool {
+    while (!data.empty()) {
+        auto const n = recv(m_fd, data.data(), data.size(), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data = data.subspan(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+auto Socket::write(std::span<std::byte const> data) -> bool {
+    while (!data.empty()) {
+        // No SIGPIPE from a peer that went away: the error is returned instead.
+        auto const n = send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data = data.subspan(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+auto Listener::listen(Address const &address) -> std::optional<Listener> {
+    if (address.kind == Address::Kind::UNIX) {
+        auto const sun = unix_address(address.host);
+        if (!sun.has_value()) {
+            return std::nullopt;
+        }
+        unlink(address.host.c_str());
+        auto const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0
+            || bind(fd, reinterpret_cast<sockaddr const *>(&sun.value()),  // NOLINT
+                    sizeof(sockaddr_un))
+                   != 0
+            || ::listen(fd, g_backlog) != 0) {
+            fmt::println(stderr, "Cannot listen on {}: {}", address.to_string(), strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+            }
+            return std::nullopt;
+        }
+        return Listener{fd, address.host};
+    }
+    auto const fd = for_each_tcp(address, AI_PASSIVE, [](int fd, addrinfo const &info) {
+        auto const on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        return bind(fd, info.ai_addr, info.ai_addrlen) == 0 && ::listen(fd, g_backlog) == 0;
+    });
+    if (fd < 0) {
+        fmt::println(stderr, "Cannot listen on {}: {}", address.to_string(), strerror(errno));
+        return std::nullopt;
+    }
+    return Listener{fd, {}};
+}
+
+Listener::Listener(int fd, std::string unix_path)
+    : m_fd{fd}
+    , m_unix_path{std::move(unix_path)} {
+}
+
+Listener::Listener(Listener &&other) noexcept
+    : m_fd{std::exchange(other.m_fd, -1)}
+    , m_unix_path{std::exchange(other.m_unix_path, {})} {
+}
+
+auto Listener::operator=(Listener &&other) noexcept -> Listener & {
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_unix_path, other.m_unix_path);
+    return *this;
+}
+
+Listener::~Listener() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+    if (!m_unix_path.empty()) {
+        unlink(m_unix_path.c_str());
+    }
+}
+
+auto Listener::accept() -> std::optional<Socket> {
+    while (true) {
+        auto const fd = ::accept(m_fd, nullptr, nullptr);
+        if (fd >= 0) {
+            set_no_delay(fd);
+            return Socket{fd};
+        }
+        if (errno != EINTR) {
+            fmt::println(stderr, "accept: {}", strerror(errno));
+            return std::nullopt;
+        }
+    }
+}
+}  // namespace net
@@ -0,0 +1,73 @@
+#ifndef SOCKET_HPP
+#define SOCKET_HPP
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Blocking stream sockets over Unix domain or TCP addresses.
+namespace net {
+// "unix:<path>" or "<host>:<port>".
+struct Address {
+    enum class Kind {
+        UNIX,
+        TCP,
+    };
+
+    Kind kind;
+    // Socket path, or host name.
+    std::string host;
+    std::string port;
+
+    [[nodiscard]] static auto parse(std::string_view str) -> std::optional<Address>;
+    [[nodiscard]] auto to_string() const -> std::string;
+};
+
+// Owns a connected socket. Failures are reported on stderr by connect() and accept() only:
+// a peer closing the connection is an expected end for a server.
+class Socket {
+public:
+    [[nodiscard]] static auto connect(Address const &address) -> std::optional<Socket>;
+
+    Socket(Socket const &) = delete;
+    auto operator=(Socket const &) -> Socket & = delete;
+    Socket(Socket &&other) noexcept;
+    auto operator=(Socket &&other) noexcept -> Socket &;
+    ~Socket();
+
+    // Both wait for the whole buffer; false if the connection ended or failed first.
+    [[nodiscard]] auto read(std::span<std::byte> data) -> bool;
+    [[nodiscard]] auto write(std::span<std::byte const> data) -> bool;
+
+private:
+    friend class Listener;
+
+    explicit Socket(int fd);
+
+    int m_fd;
+};
+
+class Listener {
+public:
+    // A Unix socket path is replaced if it exists, and removed again by the destructor.
+    [[nodiscard]] static auto listen(Address const &address) -> std::optional<Listener>;
+
+    Listener(Listener const &) = delete;
+    auto operator=(Listener const &) -> Listener & = delete;
+    Listener(Listener &&other) noexcept;
+    auto operator=(Listener &&other) noexcept -> Listener &;
+    ~Listener();
+
+    [[nodiscard]] auto accept() -> std::optional<Socket>;
+
+private:
+    Listener(int fd, std::string unix_path);
+
+    int m_fd;
+    std::string m_unix_path;
+};
+}  // namespace net
+
+#endif
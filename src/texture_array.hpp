@@ -0,0 +1,65 @@
+#ifndef GL_TEXTURE_ARRAY_HPP
+#define GL_TEXTURE_ARRAY_HPP
+
+#include "glad/glad.h"
+#include <span>
+#include <utility>
+
+namespace gl {
+// Array of 1D RGB float textures, sampled with linear filtering as a sampler1DArray.
+class Texture1DArray {
+public:
+    [[nodiscard]] static auto make() -> Texture1DArray {
+        auto tex = GLuint{};
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_1D_ARRAY, tex);
+        glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_1D_ARRAY, 0);
+        return Texture1DArray{tex};
+    }
+
+    Texture1DArray(Texture1DArray const &) = delete;
+    auto operator=(Texture1DArray const &) -> Texture1DArray & = delete;
+
+    Texture1DArray(Texture1DArray &&other) noexcept
+        : m_tex{std::exchange(other.m_tex, 0U)} {
+    }
+
+    auto operator=(Texture1DArray &&other) noexcept -> Texture1DArray & {
+        m_tex = std::exchange(other.m_tex, 0U);
+        return *this;
+    }
+
+    ~Texture1DArray() {
+        if (m_tex != 0) {
+            glDeleteTextures(1, &m_tex);
+        }
+    }
+
+    // rgb holds width * layers texels, layer after layer.
+    auto set_data(int width, int layers, std::span<float const> rgb) const -> void {
+        glBindTexture(GL_TEXTURE_1D_ARRAY, m_tex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(
+            GL_TEXTURE_1D_ARRAY, 0, GL_RGB32F, width, layers, 0, GL_RGB, GL_FLOAT, rgb.data());
+        glBindTexture(GL_TEXTURE_1D_ARRAY, 0);
+    }
+
+    // Binds the texture to a texture unit, the value of the sampler uniform.
+    auto bind(GLuint unit) const -> void {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_1D_ARRAY, m_tex);
+    }
+
+private:
+    explicit Texture1DArray(GLuint tex)
+        : m_tex{tex} {
+    }
+
+    GLuint m_tex;
+};
+}  // namespace gl
+
+#endif
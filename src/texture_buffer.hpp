@@ -0,0 +1,79 @@
+#ifndef GL_TEXTURE_BUFFER_HPP
+#define GL_TEXTURE_BUFFER_HPP
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace gl {
+// Buffer object exposed to shaders as a samplerBuffer (texelFetch only, no filtering).
+class TextureBuffer {
+public:
+    [[nodiscard]] static auto make(GLenum internal_format) -> TextureBuffer {
+        auto buf = GLuint{};
+        auto tex = GLuint{};
+        glGenBuffers(1, &buf);
+        glGenTextures(1, &tex);
+        // Creates the buffer object, which glTexBuffer() requires even before any set_data().
+        glBindBuffer(GL_TEXTURE_BUFFER, buf);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        return TextureBuffer{buf, tex, internal_format};
+    }
+
+    TextureBuffer(TextureBuffer const &) = delete;
+    auto operator=(TextureBuffer const &) -> TextureBuffer & = delete;
+
+    TextureBuffer(TextureBuffer &&other) noexcept
+        : m_buf{std::exchange(other.m_buf, 0U)}
+        , m_tex{std::exchange(other.m_tex, 0U)}
+        , m_internal_format{other.m_internal_format} {
+    }
+
+    auto operator=(TextureBuffer &&other) noexcept -> TextureBuffer & {
+        m_buf = std::exchange(other.m_buf, 0U);
+        m_tex = std::exchange(other.m_tex, 0U);
+        m_internal_format = other.m_internal_format;
+        return *this;
+    }
+
+    ~TextureBuffer() {
+        if (m_tex != 0) {
+            glDeleteTextures(1, &m_tex);
+        }
+        if (m_buf != 0) {
+            glDeleteBuffers(1, &m_buf);
+        }
+    }
+
+    template <typename T, std::size_t N>
+    auto set_data(std::span<T, N> data) const -> void {
+        glBindBuffer(GL_TEXTURE_BUFFER, m_buf);
+        glBufferData(GL_TEXTURE_BUFFER,
+                     static_cast<GLsizeiptr>(data.size() * sizeof(data[0])),
+                     data.data(),
+                     GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Binds the texture to a texture unit, the value of the sampler uniform.
+    auto bind(GLuint unit) const -> void {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_BUFFER, m_tex);
+        glTexBuffer(GL_TEXTURE_BUFFER, m_internal_format, m_buf);
+    }
+
+private:
+    explicit TextureBuffer(GLuint buf, GLuint tex, GLenum internal_format)
+        : m_buf{buf}
+        , m_tex{tex}
+        , m_internal_format{internal_format} {
+    }
+
+    GLuint m_buf;
+    GLuint m_tex;
+    GLenum m_internal_format;
+};
+}  // namespace gl
+
+#endif
@@ -0,0 +1,134 @@
+#include "tile_atlas.hpp"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "framebuffer.hpp"
+#include "program.hpp"
+#include "shaders.hpp"
+#include "texture_buffer.hpp"
+#include "tile_cache.hpp"
+#include "view.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// A square of slots holding the budget, as far as the largest texture allows.
+auto slots_per_row(std::size_t budget_bytes) -> int {
+    auto max_size = GLint{};
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    auto const tiles = static_cast<double>(budget_bytes / gl::TileAtlas::s_tile_bytes);
+    return std::clamp(static_cast<int>(std::ceil(std::sqrt(tiles))), 1, max_size / tiles::g_size);
+}
+
+auto slot_count(std::size_t budget_bytes, int per_row) -> std::size_t {
+    auto const per_row_size = static_cast<std::size_t>(per_row);
+    return std::min(budget_bytes / gl::TileAtlas::s_tile_bytes, per_row_size * per_row_size);
+}
+
+}  // namespace
+
+namespace gl {
+
+TileAtlas::TileAtlas(Program compose, std::function<void()> draw, std::size_t budget_bytes)
+    : m_compose{std::move(compose)}
+    , m_draw{std::move(draw)}
+    , m_slots_per_row{slots_per_row(budget_bytes)}
+    , m_slots{slot_count(budget_bytes, m_slots_per_row)}
+    , m_atlas{Framebuffer::make(GL_RG32F, GL_RG, GL_FLOAT)}
+    , m_tile{Framebuffer::make(GL_RG32F, GL_RG, GL_FLOAT)}
+    , m_layout_buffer{TextureBuffer::make(GL_R32I)} {
+    auto const slots = static_cast<int>(m_slots.capacity());
+    auto const rows = (slots + m_slots_per_row - 1) / m_slots_per_row;
+    m_atlas.resize(m_slots_per_row * tiles::g_size, rows * tiles::g_size);
+    m_tile.resize(tiles::g_size, tiles::g_size);
+    m_compose.set_uniform(shaders::TileUniform{"atlas"sv}, static_cast<GLint>(s_atlas_unit));
+    m_compose.set_uniform(shaders::TileUniform{"slots"sv}, static_cast<GLint>(s_slots_unit));
+    m_compose.set_uniform(shaders::TileUniform{"slots_per_row"sv}, GLint{m_slots_per_row});
+}
+
+auto TileAtlas::coverage(View const &view, std::uint32_t max_iters) const -> Coverage {
+    auto const layout = tiles::layout(view);
+    if (!fits(layout)) {
+        return Coverage::NONE;
+    }
+    for (auto row = 0; row < layout->rows; ++row) {
+        for (auto column = 0; column < layout->columns; ++column) {
+            if (!m_slots.contains(layout->key(column, row, max_iters))) {
+                return Coverage::PARTIAL;
+            }
+        }
+    }
+    return Coverage::COMPLETE;
+}
+
+auto TileAtlas::compose(Framebuffer &target,
+                        View const &view,
+                        std::uint32_t max_iters,
+                        DrawTile const &draw_tile) -> void {
+    auto const layout = tiles::layout(view).value();
+    auto const columns = static_cast<std::size_t>(layout.columns);
+    auto const key_at = [&](std::size_t i) {
+        return layout.key(static_cast<int>(i % columns), static_cast<int>(i / columns), max_iters);
+    };
+    // The cached tiles first: once they are the most recently used, the missing ones can only
+    // evict tiles of other layouts.
+    m_layout_slots.assign(layout.count(), -1);
+    for (auto i = std::size_t{0}; i < m_layout_slots.size(); ++i) {
+        if (auto const *slot = m_slots.find(key_at(i))) {
+            m_layout_slots[i] = *slot;
+        }
+    }
+    for (auto i = std::size_t{0}; i < m_layout_slots.size(); ++i) {
+        if (m_layout_slots[i] >= 0) {
+            continue;
+        }
+        auto const key = key_at(i);
+        auto [slot, evicted] = m_slots.insert(key, m_next_slot);
+        if (evicted.has_value()) {
+            slot = evicted.value();
+        } else {
+            ++m_next_slot;
+        }
+        m_layout_slots[i] = slot;
+        m_tile.bind();
+        draw_tile(tiles::tile_view(key));
+        m_tile.blit_to(m_atlas,
+                       (slot % m_slots_per_row) * tiles::g_size,
+                       (slot / m_slots_per_row) * tiles::g_size);
+    }
+
+    target.resize(view.width, view.height);
+    target.bind();
+    m_layout_buffer.set_data(std::span{m_layout_slots});
+    m_layout_buffer.bind(s_slots_unit);
+    m_atlas.bind_texture(s_atlas_unit);
+    m_compose.set_uniform(shaders::TileUniform{"layout_size"sv},
+                          std::pair{layout.columns, layout.rows});
+    m_compose.set_uniform(shaders::TileUniform{"origin"sv},
+                          std::pair{static_cast<float>(layout.origin_x),
+                                    static_cast<float>(layout.origin_y)});
+    m_compose.set_uniform(
+        shaders::TileUniform{"spacing"sv},
+        std::pair{static_cast<float>(layout.step_x), static_cast<float>(layout.step_y)});
+    m_draw();
+}
+
+auto TileAtlas::stats() const -> tiles::Stats {
+    return m_slots.stats();
+}
+
+auto TileAtlas::fits(std::optional<tiles::Layout> const &layout) const -> bool {
+    return layout.has_value() && layout->count() <= m_slots.capacity();
+}
+}  // namespace gl
@@ -0,0 +1,72 @@
+#ifndef GL_TILE_ATLAS_HPP
+#define GL_TILE_ATLAS_HPP
+
+#include "glad/glad.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "framebuffer.hpp"
+#include "program.hpp"
+#include "texture_buffer.hpp"
+#include "tile_cache.hpp"
+#include "view.hpp"
+
+namespace gl {
+// GPU side of the tile cache: the counts of each tile (RG32F, like the iteration passes) in a
+// slot of one large texture, the least recently used slot reused once all are taken. A frame is
+// composed from the tiles by tiles.frag, only the tiles never seen before being iterated.
+class TileAtlas {
+public:
+    // Iteration pass of a tiles::tile_view() into the bound framebuffer.
+    using DrawTile = std::function<void(View const &)>;
+
+    enum class Coverage {
+        // Too deep, or more tiles than slots.
+        NONE,
+        PARTIAL,
+        COMPLETE,
+    };
+
+    // Texture units of the atlas and slots samplers of tiles.frag.
+    inline static constexpr auto s_atlas_unit = GLuint{3};
+    inline static constexpr auto s_slots_unit = GLuint{4};
+
+    inline static constexpr auto s_tile_bytes = tiles::g_samples * 2 * sizeof(float);
+
+    // compose is tiles.frag, draw renders the full viewport with the current program. There are
+    // as many slots as fit in budget_bytes and in the largest texture.
+    TileAtlas(Program compose, std::function<void()> draw, std::size_t budget_bytes);
+
+    [[nodiscard]] auto coverage(View const &view, std::uint32_t max_iters) const -> Coverage;
+
+    // Fills target, resized to the size of view, from tiles::layout(view), computing the
+    // missing tiles with draw_tile first. coverage() must not be NONE.
+    auto compose(Framebuffer &target,
+                 View const &view,
+                 std::uint32_t max_iters,
+                 DrawTile const &draw_tile) -> void;
+
+    [[nodiscard]] auto stats() const -> tiles::Stats;
+
+private:
+    [[nodiscard]] auto fits(std::optional<tiles::Layout> const &layout) const -> bool;
+
+    Program m_compose;
+    std::function<void()> m_draw;
+    int m_slots_per_row;
+    tiles::Lru<GLint> m_slots;
+    // Slots never used so far start here.
+    GLint m_next_slot{0};
+    Framebuffer m_atlas;
+    // A tile is drawn here, then copied into its slot.
+    Framebuffer m_tile;
+    TextureBuffer m_layout_buffer;
+    std::vector<GLint> m_layout_slots;
+};
+}  // namespace gl
+
+#endif
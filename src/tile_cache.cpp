@@ -0,0 +1,163 @@
+#include "tile_cache.hpp"
+
+#include "view.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Tile and sample of each pixel along one axis.
+struct Samples {
+    std::vector<int> tile;
+    std::vector<int> sample;
+};
+
+// Pixel p is at origin + p * step tiles from the first of tiles.
+auto samples(double origin, double step, int pixels, int tiles) -> Samples {
+    auto result = Samples{};
+    result.tile.reserve(static_cast<std::size_t>(pixels));
+    result.sample.reserve(static_cast<std::size_t>(pixels));
+    for (auto p = 0; p < pixels; ++p) {
+        auto const position = origin + (p * step);
+        auto const tile = std::clamp(static_cast<int>(std::floor(position)), 0, tiles - 1);
+        result.tile.push_back(tile);
+        result.sample.push_back(std::clamp(
+            static_cast<int>((position - tile) * tiles::g_size), 0, tiles::g_size - 1));
+    }
+    return result;
+}
+
+// Side of the tiles of a level in the complex plane.
+auto side(int level) -> double {
+    return std::ldexp(tiles::g_root_side, -level);
+}
+
+}  // namespace
+
+namespace tiles {
+
+auto KeyHash::operator()(Key const &key) const -> std::size_t {
+    auto hash = std::uint64_t{0xcbf29ce484222325ULL};  // NOLINT
+    for (auto const field : {static_cast<std::uint32_t>(key.level),
+                             static_cast<std::uint32_t>(key.x),
+                             static_cast<std::uint32_t>(key.y),
+                             key.max_iters}) {
+        hash ^= field;
+        hash *= 0x100000001b3ULL;  // NOLINT
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+auto layout(View const &view) -> std::optional<Layout> {
+    auto const zoom = static_cast<double>(view.zoom);
+    auto const scale = static_cast<double>(View::s_scale);
+    auto const pixel_x = zoom * scale / view.width;
+    auto const pixel_y = zoom * scale / view.height;
+    // Rounded up, but for a level that the pixels match up to rounding errors.
+    auto const level = static_cast<int>(std::ceil(
+        std::log2(g_root_side / (g_size * std::min(pixel_x, pixel_y))) - 1e-6));  // NOLINT
+    if (level < 0 || level > g_max_level) {
+        return std::nullopt;
+    }
+    // View::real() and View::imag() of the first and last pixels, in tiles.
+    auto const tile_side = side(level);
+    auto const first_x
+        = (((0.5 / view.width - View::s_anchor_x) * zoom) + view.x_offset) * scale / tile_side;
+    auto const first_y
+        = (((0.5 / view.height - View::s_anchor_y) * zoom) + view.y_offset) * scale / tile_side;
+    auto const step_x = pixel_x / tile_side;
+    auto const step_y = pixel_y / tile_side;
+    auto const x = static_cast<int>(std::floor(first_x));
+    auto const y = static_cast<int>(std::floor(first_y));
+    return Layout{
+        .level = level,
+        .x = x,
+        .y = y,
+        .columns = static_cast<int>(std::floor(first_x + ((view.width - 1) * step_x))) - x + 1,
+        .rows = static_cast<int>(std::floor(first_y + ((view.height - 1) * step_y))) - y + 1,
+        .origin_x = first_x - x,
+        .origin_y = first_y - y,
+        .step_x = step_x,
+        .step_y = step_y,
+    };
+}
+
+auto tile_view(Key const &key) -> View {
+    // Sample i of the tile is at (x + (i + 0.5) / g_size) * side.
+    auto const scale = static_cast<double>(View::s_scale);
+    auto const zoom = side(key.level) / scale;
+    return View{
+        .x_offset = static_cast<float>((key.x * zoom) + (View::s_anchor_x * zoom)),
+        .y_offset = static_cast<float>((key.y * zoom) + (View::s_anchor_y * zoom)),
+        .zoom = static_cast<float>(zoom),
+        .width = g_size,
+        .height = g_size,
+    };
+}
+
+Cache::Cache(std::size_t budget_bytes)
+    : m_tiles{budget_bytes / s_tile_bytes} {
+}
+
+auto Cache::render(View const &view,
+                   std::uint32_t max_iters,
+                   Compute const &compute,
+                   std::span<std::uint32_t> out) -> bool {
+    auto const grid = layout(view);
+    if (!grid.has_value()) {
+        return false;
+    }
+    auto const columns = samples(grid->origin_x, grid->step_x, view.width, grid->columns);
+    auto const rows = samples(grid->origin_y, grid->step_y, view.height, grid->rows);
+    auto const stride = static_cast<std::size_t>(view.width);
+    // Buffer of the next computed tile: an evicted one when the cache is full.
+    auto spare = std::vector<std::uint32_t>{};
+    for (auto row = 0; row < grid->rows; ++row) {
+        // Samples increase with the pixels: the pixels of a tile are a contiguous range.
+        auto const [y_begin, y_end] = std::ranges::equal_range(rows.tile, row);
+        if (y_begin == y_end) {
+            continue;
+        }
+        for (auto column = 0; column < grid->columns; ++column) {
+            auto const [x_begin, x_end] = std::ranges::equal_range(columns.tile, column);
+            if (x_begin == x_end) {
+                continue;
+            }
+            auto const key = grid->key(column, row, max_iters);
+            auto const *tile = m_tiles.find(key);
+            if (tile == nullptr) {
+                spare.resize(g_samples);
+                compute(tile_view(key), spare);
+                auto [stored, evicted] = m_tiles.insert(key, std::move(spare));
+                spare = std::move(evicted).value_or(std::vector<std::uint32_t>{});
+                tile = &stored;
+            }
+            auto const x_first = x_begin - columns.tile.begin();
+            auto const x_last = x_end - columns.tile.begin();
+            for (auto y = y_begin - rows.tile.begin(); y < y_end - rows.tile.begin(); ++y) {
+                auto const *source = tile->data()
+                                   + (static_cast<std::size_t>(rows.sample[y]) * g_size);
+                auto *dst = out.data() + (static_cast<std::size_t>(y) * stride);
+                for (auto x = x_first; x < x_last; ++x) {
+                    dst[x] = source[columns.sample[x]];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+auto Cache::stats() const -> Stats {
+    return m_tiles.stats();
+}
+
+auto Cache::size_bytes() const -> std::size_t {
+    return m_tiles.size() * s_tile_bytes;
+}
+}  // namespace tiles
@@ -0,0 +1,166 @@
+#ifndef TILE_CACHE_HPP
+#define TILE_CACHE_HPP
+
+#include "view.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Iteration counts of fixed squares of the complex plane, so that a region seen before does not
+// have to be iterated again. Level l splits the plane into squares of g_root_side / 2^l, each
+// sampled g_size x g_size times: a view samples the coarsest level at least as fine as its
+// pixels.
+namespace tiles {
+// Samples per side of a tile.
+inline constexpr auto g_size = 128;
+inline constexpr auto g_samples = static_cast<std::size_t>(g_size) * g_size;
+// Side of the tiles of level 0, in the complex plane. Tile (0, 0) starts at the origin.
+inline constexpr auto g_root_side = 4.0;
+// Deeper tiles would need more than the float precision of View.
+inline constexpr auto g_max_level = 20;
+
+struct Key {
+    int level;
+    int x;
+    int y;
+    // Counts at the limit depend on it.
+    std::uint32_t max_iters;
+
+    [[nodiscard]] auto operator==(Key const &) const -> bool = default;
+};
+
+struct KeyHash {
+    [[nodiscard]] auto operator()(Key const &key) const -> std::size_t;
+};
+
+struct Stats {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t evictions{0};
+};
+
+// The tiles of one level covering a frame, and where its pixels fall in them.
+struct Layout {
+    int level;
+    // First tile, bottom-left.
+    int x;
+    int y;
+    int columns;
+    int rows;
+    // Position of the center of pixel (0, 0) in tiles from tile (x, y), and the pixel spacing.
+    double origin_x;
+    double origin_y;
+    double step_x;
+    double step_y;
+
+    [[nodiscard]] auto count() const -> std::size_t {
+        return static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+    }
+
+    [[nodiscard]] auto key(int column, int row, std::uint32_t max_iters) const -> Key {
+        return Key{.level = level, .x = x + column, .y = y + row, .max_iters = max_iters};
+    }
+};
+
+// The coarsest level whose samples are no farther apart than the pixels of view (the finer of
+// its axes), or nothing if the view is too deep for tiles.
+[[nodiscard]] auto layout(View const &view) -> std::optional<Layout>;
+
+// The view whose width x height pixels are the samples of a tile.
+[[nodiscard]] auto tile_view(Key const &key) -> View;
+
+// Least recently used eviction once capacity entries are stored.
+template <typename T>
+class Lru {
+public:
+    explicit Lru(std::size_t capacity)
+        : m_capacity{std::max(capacity, std::size_t{1})} {
+    }
+
+    // The value of key, which becomes the most recently used, counting a hit or a miss.
+    [[nodiscard]] auto find(Key const &key) -> T * {
+        auto const it = m_index.find(key);
+        if (it == m_index.end()) {
+            ++m_stats.misses;
+            return nullptr;
+        }
+        ++m_stats.hits;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->second;
+    }
+
+    // Neither counts nor changes the order.
+    [[nodiscard]] auto contains(Key const &key) const -> bool {
+        return m_index.contains(key);
+    }
+
+    // key must not be stored yet. Returns the evicted value, if any, for reuse.
+    auto insert(Key const &key, T value) -> std::pair<T &, std::optional<T>> {
+        auto evicted = std::optional<T>{};
+        if (m_entries.size() == m_capacity) {
+            ++m_stats.evictions;
+            m_index.erase(m_entries.back().first);
+            evicted = std::move(m_entries.back().second);
+            m_entries.pop_back();
+        }
+        m_entries.emplace_front(key, std::move(value));
+        m_index.emplace(key, m_entries.begin());
+        return {m_entries.front().second, std::move(evicted)};
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t {
+        return m_entries.size();
+    }
+
+    [[nodiscard]] auto capacity() const -> std::size_t {
+        return m_capacity;
+    }
+
+    [[nodiscard]] auto stats() const -> Stats {
+        return m_stats;
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, T>>;
+
+    std::size_t m_capacity;
+    // Most recently used first.
+    Entries m_entries;
+    std::unordered_map<Key, typename Entries::iterator, KeyHash> m_index;
+    Stats m_stats;
+};
+
+// Host memory tiles: g_samples counts each, bottom row first.
+class Cache {
+public:
+    // Fills counts with the samples of a tile_view().
+    using Compute = std::function<void(View const &, std::span<std::uint32_t>)>;
+
+    inline static constexpr auto s_tile_bytes = g_samples * sizeof(std::uint32_t);
+
+    // Keeps as many tiles as fit in budget_bytes, at least one.
+    explicit Cache(std::size_t budget_bytes);
+
+    // Fills out, view.width * view.height counts bottom row first, from the tiles of layout(),
+    // computing the missing ones. False, leaving out untouched, if the view is too deep.
+    auto render(View const &view,
+                std::uint32_t max_iters,
+                Compute const &compute,
+                std::span<std::uint32_t> out) -> bool;
+
+    [[nodiscard]] auto stats() const -> Stats;
+    [[nodiscard]] auto size_bytes() const -> std::size_t;
+
+private:
+    Lru<std::vector<std::uint32_t>> m_tiles;
+};
+}  // namespace tiles
+
+#endif
@@ -0,0 +1,156 @@
+#include "tile_scheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace cpu {
+
+auto make_tiles(int width, int height, int tile_size) -> std::vector<Tile> {
+    auto tiles = std::vector<Tile>{};
+    make_tiles(Tile{.x = 0, .y = 0, .width = width, .height = height}, tile_size, tiles);
+    return tiles;
+}
+
+auto make_tiles(Tile const &area, int tile_size, std::vector<Tile> &tiles) -> void {
+    assert(tile_size > 0);
+    auto const x_end = area.x + area.width;
+    auto const y_end = area.y + area.height;
+    for (auto y = area.y; y < y_end; y += tile_size) {
+        for (auto x = area.x; x < x_end; x += tile_size) {
+            tiles.push_back(Tile{
+                .x = x,
+                .y = y,
+                .width = std::min(tile_size, x_end - x),
+                .height = std::min(tile_size, y_end - y),
+            });
+        }
+    }
+}
+
+auto SchedulerStats::utilization(std::size_t worker) const -> double {
+    if (wall.count() == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(workers.at(worker).busy.count())
+         / static_cast<double>(wall.count());
+}
+
+auto SchedulerStats::mean_utilization() const -> double {
+    if (workers.empty()) {
+        return 0.0;
+    }
+    auto total = 0.0;
+    for (auto i = std::size_t{0}; i < workers.size(); ++i) {
+        total += utilization(i);
+    }
+    return total / static_cast<double>(workers.size());
+}
+
+TileScheduler::TileScheduler(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    for (auto i = 0U; i < threads; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (auto i = std::size_t{0}; i < threads; ++i) {
+        m_threads.emplace_back([this, i](std::stop_token const &stop) { worker_loop(stop, i); });
+    }
+}
+
+auto TileScheduler::thread_count() const -> unsigned {
+    return static_cast<unsigned>(m_workers.size());
+}
+
+auto TileScheduler::run(std::span<Tile const> tiles, Job const &job) -> SchedulerStats {
+    auto const zone = trace::Zone{"scheduler run"};
+    auto const start = std::chrono::steady_clock::now();
+    auto const workers = m_workers.size();
+    for (auto i = std::size_t{0}; i < workers; ++i) {
+        auto const begin = tiles.begin() + static_cast<std::ptrdiff_t>(tiles.size() * i / workers);
+        auto const end
+            = tiles.begin() + static_cast<std::ptrdiff_t>(tiles.size() * (i + 1) / workers);
+        auto &worker = *m_workers[i];
+        auto const lock = std::scoped_lock{worker.mutex};
+        worker.tiles.assign(begin, end);
+        worker.stats = WorkerStats{};
+    }
+    {
+        auto lock = std::unique_lock{m_mutex};
+        m_job = &job;
+        m_running = workers;
+        ++m_generation;
+        m_start.notify_all();
+        m_done.wait(lock, [this] { return m_running == 0; });
+        m_job = nullptr;
+    }
+    auto stats = SchedulerStats{};
+    stats.wall = std::chrono::steady_clock::now() - start;
+    for (auto const &worker : m_workers) {
+        stats.workers.push_back(worker->stats);
+    }
+    return stats;
+}
+
+auto TileScheduler::next_tile(std::size_t index, Tile &tile) -> bool {
+    {
+        auto &own = *m_workers[index];
+        auto const lock = std::scoped_lock{own.mutex};
+        if (!own.tiles.empty()) {
+            tile = own.tiles.front();
+            own.tiles.pop_front();
+            return true;
+        }
+    }
+    for (auto offset = std::size_t{1}; offset < m_workers.size(); ++offset) {
+        auto &victim = *m_workers[(index + offset) % m_workers.size()];
+        auto const lock = std::scoped_lock{victim.mutex};
+        if (!victim.tiles.empty()) {
+            tile = victim.tiles.back();
+            victim.tiles.pop_back();
+            ++m_workers[index]->stats.stolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+auto TileScheduler::worker_loop(std::stop_token const &stop, std::size_t index) -> void {
+    trace::set_thread_name("tile worker");
+    auto seen = std::uint64_t{0};
+    while (true) {
+        Job const *job = nullptr;
+        {
+            auto lock = std::unique_lock{m_mutex};
+            if (!m_start.wait(lock, stop, [&] { return m_generation != seen; })) {
+                return;
+            }
+            seen = m_generation;
+            job = m_job;
+        }
+        auto &stats = m_workers[index]->stats;
+        auto tile = Tile{};
+        while (next_tile(index, tile)) {
+            auto const zone = trace::Zone{"tile"};
+            auto const start = std::chrono::steady_clock::now();
+            (*job)(tile);
+            stats.busy += std::chrono::steady_clock::now() - start;
+            ++stats.tiles;
+        }
+        auto const lock = std::scoped_lock{m_mutex};
+        if (--m_running == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+}  // namespace cpu
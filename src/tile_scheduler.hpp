@@ -0,0 +1,91 @@
+#ifndef TILE_SCHEDULER_HPP
+#define TILE_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace cpu {
+struct Tile {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Splits a width x height frame into tile_size x tile_size tiles, row-major, bottom row first.
+[[nodiscard]] auto make_tiles(int width, int height, int tile_size) -> std::vector<Tile>;
+// Same for a rectangle within a frame, appending to tiles.
+auto make_tiles(Tile const &area, int tile_size, std::vector<Tile> &tiles) -> void;
+
+struct WorkerStats {
+    std::size_t tiles{0};
+    std::size_t stolen{0};
+    std::chrono::nanoseconds busy{0};
+};
+
+struct SchedulerStats {
+    std::chrono::nanoseconds wall{0};
+    std::vector<WorkerStats> workers;
+    // Pixels filled without iterating (cpu::Renderer::Options::subdivide).
+    std::size_t skipped_pixels{0};
+
+    // Fraction of the wall time a worker spent running tiles.
+    [[nodiscard]] auto utilization(std::size_t worker) const -> double;
+    [[nodiscard]] auto mean_utilization() const -> double;
+};
+
+// Persistent pool with one tile deque per thread. Each run() deals the tiles out in contiguous
+// chunks; a worker pops from the front of its own deque and, once that is empty, steals from
+// the back of the others, so threads that drew cheap exterior tiles help with the interior.
+class TileScheduler {
+public:
+    using Job = std::function<void(Tile const &)>;
+
+    // 0 threads means one per hardware thread.
+    explicit TileScheduler(unsigned threads = 0);
+
+    TileScheduler(TileScheduler const &) = delete;
+    auto operator=(TileScheduler const &) -> TileScheduler & = delete;
+    TileScheduler(TileScheduler &&) = delete;
+    auto operator=(TileScheduler &&) -> TileScheduler & = delete;
+
+    ~TileScheduler() = default;
+
+    // Runs job once per tile and returns when all of them are done.
+    auto run(std::span<Tile const> tiles, Job const &job) -> SchedulerStats;
+
+    [[nodiscard]] auto thread_count() const -> unsigned;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Tile> tiles;
+        WorkerStats stats;
+    };
+
+    auto worker_loop(std::stop_token const &stop, std::size_t index) -> void;
+    [[nodiscard]] auto next_tile(std::size_t index, Tile &tile) -> bool;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable_any m_start;
+    std::condition_variable m_done;
+    Job const *m_job{nullptr};
+    std::uint64_t m_generation{0};
+    std::size_t m_running{0};
+    // Declared last: the threads are joined before anything they use is destroyed.
+    std::vector<std::jthread> m_threads;
+};
+}  // namespace cpu
+
+#endif
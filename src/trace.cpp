@@ -0,0 +1,194 @@
+#include "trace.hpp"
+
+#include "fmt/base.h"
+#include "fmt/format.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct Event {
+    char const *name;
+    std::int64_t start_ns;
+    std::int64_t end_ns;
+};
+
+// Written by its thread only. size publishes the events before it to write_json(). When the
+// thread exits, its events move to retired and events goes back to the registry.
+struct Buffer {
+    std::uint32_t tid;
+    std::string name;
+    std::unique_ptr<Event[]> events;  // NOLINT
+    std::vector<Event> retired;
+    std::atomic<std::size_t> size{0};
+    std::atomic<std::size_t> dropped{0};
+};
+
+// The buffers outlive their threads, until the end of the process. Only the events of a
+// thread that exited are copied out, so that threads started over and over, like the workers
+// of a render server, reuse the same few arrays.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<std::unique_ptr<Event[]>> free;  // NOLINT
+};
+
+auto registry() -> Registry & {
+    static auto instance = Registry{};
+    return instance;
+}
+
+auto const g_epoch = std::chrono::steady_clock::now();
+
+// Retires the buffer of its thread on exit.
+struct Owner {
+    Buffer *buffer = nullptr;
+
+    Owner() = default;
+    Owner(Owner const &) = delete;
+    auto operator=(Owner const &) -> Owner & = delete;
+    Owner(Owner &&) = delete;
+    auto operator=(Owner &&) -> Owner & = delete;
+
+    ~Owner() {
+        if (buffer == nullptr) {
+            return;
+        }
+        auto &reg = registry();
+        auto const lock = std::scoped_lock{reg.mutex};
+        auto const size = buffer->size.load(std::memory_order_relaxed);
+        buffer->retired.assign(buffer->events.get(), buffer->events.get() + size);
+        reg.free.push_back(std::move(buffer->events));
+    }
+};
+
+thread_local Owner t_owner;
+
+auto buffer() -> Buffer & {
+    if (t_owner.buffer == nullptr) {
+        auto &reg = registry();
+        auto const lock = std::scoped_lock{reg.mutex};
+        auto &added = reg.buffers.emplace_back(std::make_unique<Buffer>());
+        added->tid = static_cast<std::uint32_t>(reg.buffers.size());
+        if (reg.free.empty()) {
+            added->events = std::make_unique_for_overwrite<Event[]>(trace::g_capacity);  // NOLINT
+        } else {
+            added->events = std::move(reg.free.back());
+            reg.free.pop_back();
+        }
+        t_owner.buffer = added.get();
+    }
+    return *t_owner.buffer;
+}
+
+auto json_escaped(std::string_view str) -> std::string {
+    auto escaped = std::string{};
+    for (auto const c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+}  // namespace
+
+namespace trace {
+
+namespace detail {
+
+auto now_ns() -> std::int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+                                                                - g_epoch)
+        .count();
+}
+
+auto record(char const *name, std::int64_t start_ns, std::int64_t end_ns) -> void {
+    auto &own = buffer();
+    auto const size = own.size.load(std::memory_order_relaxed);
+    if (size == g_capacity) {
+        own.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    own.events[size] = Event{.name = name, .start_ns = start_ns, .end_ns = end_ns};
+    own.size.store(size + 1, std::memory_order_release);
+}
+
+}  // namespace detail
+
+auto enable() -> void {
+    detail::g_enabled.store(true, std::memory_order_relaxed);
+}
+
+auto set_thread_name(char const *name) -> void {
+    if (!enabled()) {
+        return;
+    }
+    auto &own = buffer();
+    auto const lock = std::scoped_lock{registry().mutex};
+    own.name = name;
+}
+
+auto write_json(std::filesystem::path const &path) -> bool {
+    auto out = std::ofstream{path};
+    if (!out) {
+        fmt::println(stderr, "Failed to open {} for writing.", path.string());
+        return false;
+    }
+    auto &reg = registry();
+    auto const lock = std::scoped_lock{reg.mutex};
+    auto separator = "";
+    auto dropped = std::size_t{0};
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (auto const &thread : reg.buffers) {
+        if (!thread->name.empty()) {
+            out << fmt::format(
+                R"({}{{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                separator,
+                thread->tid,
+                json_escaped(thread->name));
+            separator = ",\n";
+        }
+        auto const size = thread->size.load(std::memory_order_acquire);
+        auto const *const events
+            = thread->events != nullptr ? thread->events.get() : thread->retired.data();
+        for (auto i = std::size_t{0}; i < size; ++i) {
+            auto const &event = events[i];  // NOLINT
+            auto const start_us = static_cast<double>(event.start_ns) * 1e-3;  // NOLINT
+            auto const duration_us
+                = static_cast<double>(event.end_ns - event.start_ns) * 1e-3;  // NOLINT
+            out << fmt::format(R"({}{{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},)"
+                               R"("dur":{:.3f}}})",
+                               separator,
+                               json_escaped(event.name),
+                               thread->tid,
+                               start_us,
+                               duration_us);
+            separator = ",\n";
+        }
+        dropped += thread->dropped.load(std::memory_order_relaxed);
+    }
+    out << "\n]}\n";
+    if (dropped > 0) {
+        fmt::println(stderr, "{} trace zones did not fit in their thread's buffer.", dropped);
+    }
+    if (!out) {
+        fmt::println(stderr, "Failed to write {}.", path.string());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace trace
@@ -0,0 +1,63 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Scoped trace zones of every thread, written as Chrome trace_event JSON for chrome://tracing or
+// ui.perfetto.dev. Off until enable(): a zone then costs a relaxed atomic load. Once on, each
+// thread appends its zones to its own buffer without locking; a full buffer drops the newer
+// ones. Zones measure host time: for GL work, the submission and any wait for the GPU.
+namespace trace {
+// Zones per thread.
+inline constexpr auto g_capacity = std::size_t{1} << 18U;
+
+namespace detail {
+inline std::atomic<bool> g_enabled{false};
+
+[[nodiscard]] auto now_ns() -> std::int64_t;
+auto record(char const *name, std::int64_t start_ns, std::int64_t end_ns) -> void;
+}  // namespace detail
+
+// Records the zones of every thread from now on.
+auto enable() -> void;
+
+[[nodiscard]] inline auto enabled() -> bool {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+// Name of the calling thread in the trace, if enabled.
+auto set_thread_name(char const *name) -> void;
+
+// The zones completed so far. Threads may go on recording meanwhile.
+[[nodiscard]] auto write_json(std::filesystem::path const &path) -> bool;
+
+// The time from its construction to its destruction. name must outlive the trace, e.g. a
+// string literal.
+class Zone {
+public:
+    explicit Zone(char const *name)
+        : m_name{name}
+        , m_start{enabled() ? detail::now_ns() : -1} {
+    }
+
+    Zone(Zone const &) = delete;
+    auto operator=(Zone const &) -> Zone & = delete;
+    Zone(Zone &&) = delete;
+    auto operator=(Zone &&) -> Zone & = delete;
+
+    ~Zone() {
+        if (m_start >= 0) {
+            detail::record(m_name, m_start, detail::now_ns());
+        }
+    }
+
+private:
+    char const *m_name;
+    std::int64_t m_start;
+};
+}  // namespace trace
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef GL_UNIFORM_BUFFER_HPP
+#define GL_UNIFORM_BUFFER_HPP
+
+#include "glad/glad.h"
+#include <utility>
+
+namespace gl {
+// Buffer object backing a uniform block, holding one T laid out like the block (std140).
+template <typename T>
+class UniformBuffer {
+public:
+    [[nodiscard]] static auto make() -> UniformBuffer {
+        auto buf = GLuint{};
+        glGenBuffers(1, &buf);
+        glBindBuffer(GL_UNIFORM_BUFFER, buf);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        return UniformBuffer{buf};
+    }
+
+    UniformBuffer(UniformBuffer const &) = delete;
+    auto operator=(UniformBuffer const &) -> UniformBuffer & = delete;
+
+    UniformBuffer(UniformBuffer &&other) noexcept
+        : m_buf{std::exchange(other.m_buf, 0U)} {
+    }
+
+    auto operator=(UniformBuffer &&other) noexcept -> UniformBuffer & {
+        m_buf = std::exchange(other.m_buf, 0U);
+        return *this;
+    }
+
+    ~UniformBuffer() {
+        if (m_buf != 0) {
+            glDeleteBuffers(1, &m_buf);
+        }
+    }
+
+    // All the uniforms of the block in one buffer update.
+    auto set(T const &value) const -> void {
+        glBindBuffer(GL_UNIFORM_BUFFER, m_buf);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &value);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // Binds the buffer to a binding point, the one of the block (Program::bind_uniform_block()).
+    auto bind(GLuint binding) const -> void {
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_buf);
+    }
+
+private:
+    explicit UniformBuffer(GLuint buf)
+        : m_buf{buf} {
+    }
+
+    GLuint m_buf;
+};
+}  // namespace gl
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef VIEW_HPP
+#define VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Camera and framebuffer size. The pixel -> complex plane mapping mirrors real_imag() in
+// shader.frag, operation by operation, so that CPU and GL renders agree pixel for pixel.
+// Pixel (0, 0) is the bottom-left one, like gl_FragCoord.
+struct View {
+    inline static constexpr auto s_anchor_x = 0.7F;
+    inline static constexpr auto s_anchor_y = 0.5F;
+    inline static constexpr auto s_scale = 2.5F;
+    inline static constexpr auto s_threshold = 4.0F;
+    inline static constexpr auto s_max_iters = std::uint32_t{1000U};
+
+    float x_offset;
+    float y_offset;
+    float zoom;
+    int width;
+    int height;
+
+    [[nodiscard]] auto real(int px) const -> float {
+        auto const frag_x = static_cast<float>(px) + 0.5F;  // NOLINT
+        return ((frag_x / static_cast<float>(width) - s_anchor_x) * zoom + x_offset) * s_scale;
+    }
+
+    [[nodiscard]] auto imag(int py) const -> float {
+        auto const frag_y = static_cast<float>(py) + 0.5F;  // NOLINT
+        return ((frag_y / static_cast<float>(height) - s_anchor_y) * zoom + y_offset) * s_scale;
+    }
+
+    [[nodiscard]] auto pixel_count() const -> std::size_t {
+        return static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    }
+};
+
+#endif
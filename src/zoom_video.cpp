@@ -0,0 +1,137 @@
+#include "zoom_video.hpp"
+
+#include "fmt/base.h"
+#include "fmt/format.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <utility>
+
+#include "fixed.hpp"
+#include "image.hpp"
+#include "trace.hpp"
+
+namespace {
+
+// Bottom-up RGBA8 to top-down RGB8.
+auto to_image(std::span<std::uint8_t const> rgba, int width, int height, image::Image &out)
+    -> void {
+    out.width = width;
+    out.height = height;
+    out.pixels.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 3U);
+    auto const stride = static_cast<std::size_t>(width) * 4U;
+    auto dst = out.pixels.begin();
+    for (auto y = height - 1; y >= 0; --y) {
+        auto const row = rgba.subspan(static_cast<std::size_t>(y) * stride, stride);
+        for (auto x = std::size_t{0}; x < row.size(); x += 4) {
+            dst = std::copy_n(row.begin() + static_cast<std::ptrdiff_t>(x), 3, dst);
+        }
+    }
+}
+
+}  // namespace
+
+namespace video {
+
+auto keyframe_at(Keyframe const &from, Keyframe const &to, int index, int frames) -> Keyframe {
+    auto const t = frames > 1 ? static_cast<double>(index) / (frames - 1) : 0.0;
+    auto const zoom = from.zoom * std::pow(to.zoom / from.zoom, t);
+    // Share of the way left, 1 at the first frame and 0 at the last.
+    auto const rest = from.zoom != to.zoom ? (zoom - to.zoom) / (from.zoom - to.zoom) : 1.0 - t;
+    auto const weight = mp::Fixed::from_double(rest);
+    return Keyframe{
+        .x_offset = to.x_offset + (from.x_offset - to.x_offset) * weight,
+        .y_offset = to.y_offset + (from.y_offset - to.y_offset) * weight,
+        .zoom = zoom,
+    };
+}
+
+Encoder::Encoder(int width, int height, std::filesystem::path output)
+    : m_width{width}
+    , m_height{height}
+    , m_output{std::move(output)}
+    , m_thread{[this](std::stop_token const &stop) { loop(stop); }} {
+}
+
+Encoder::~Encoder() {
+    finish();
+}
+
+auto Encoder::acquire() -> Frame {
+    auto lock = std::unique_lock{m_mutex};
+    m_cv.wait(lock, [this] { return m_in_flight < s_depth; });
+    ++m_in_flight;
+    if (m_free.empty()) {
+        auto frame = Frame{};
+        frame.rgba.resize(static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height)
+                          * 4U);
+        return frame;
+    }
+    auto frame = std::move(m_free.back());
+    m_free.pop_back();
+    return frame;
+}
+
+auto Encoder::submit(Frame frame) -> void {
+    auto const lock = std::scoped_lock{m_mutex};
+    m_queue.push_back(std::move(frame));
+    m_cv.notify_all();
+}
+
+auto Encoder::finish() -> void {
+    auto lock = std::unique_lock{m_mutex};
+    m_cv.wait(lock, [this] { return m_in_flight == 0; });
+    if (m_output == "-") {
+        std::fflush(stdout);
+    }
+}
+
+auto Encoder::failures() const -> std::size_t {
+    return m_failures;
+}
+
+auto Encoder::loop(std::stop_token const &stop) -> void {
+    trace::set_thread_name("encoder");
+    auto img = image::Image{};
+    while (true) {
+        auto frame = Frame{};
+        {
+            auto lock = std::unique_lock{m_mutex};
+            if (!m_cv.wait(lock, stop, [this] { return !m_queue.empty(); })) {
+                return;
+            }
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        auto const ok = [&] {
+            auto const zone = trace::Zone{"write frame"};
+            return write(frame, img);
+        }();
+        auto const lock = std::scoped_lock{m_mutex};
+        if (!ok) {
+            ++m_failures;
+        }
+        m_free.push_back(std::move(frame));
+        --m_in_flight;
+        m_cv.notify_all();
+    }
+}
+
+auto Encoder::write(Frame const &frame, image::Image &img) const -> bool {
+    to_image(frame.rgba, m_width, m_height, img);
+    if (m_output != "-") {
+        return image::write_ppm(m_output / fmt::format("frame_{:05}.ppm", frame.index), img);
+    }
+    if (std::fwrite(img.pixels.data(), 1, img.pixels.size(), stdout) != img.pixels.size()) {
+        fmt::println(stderr, "Failed to write frame {} to stdout.", frame.index);
+        return false;
+    }
+    return true;
+}
+}  // namespace video
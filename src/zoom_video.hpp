@@ -0,0 +1,96 @@
+#ifndef ZOOM_VIDEO_HPP
+#define ZOOM_VIDEO_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "antialias.hpp"
+#include "fixed.hpp"
+#include "image.hpp"
+
+namespace video {
+struct Keyframe {
+    mp::Fixed x_offset;
+    mp::Fixed y_offset;
+    double zoom;
+};
+
+// A zoom from one camera to another, rendered offscreen frame by frame.
+struct Options {
+    Keyframe from{mp::Fixed::from_double(0.0), mp::Fixed::from_double(0.0), 1.0};
+    Keyframe to{mp::Fixed::from_double(0.0), mp::Fixed::from_double(0.0), 1.0};
+    int frames{0};
+    int width{1280};   // NOLINT
+    int height{720};   // NOLINT
+    std::string color_map{"rainbow"};
+    // Fixed limit for every frame; iters::for_zoom() of each frame otherwise.
+    std::optional<std::uint32_t> max_iters;
+    // Most samples of a pixel on an edge, see aa::grid_side().
+    int max_samples{aa::g_default_max_samples};
+    // Directory of the numbered PPM images, or "-" for raw RGB24 frames on stdout.
+    std::filesystem::path output{"-"};
+};
+
+// Camera of frame index of frames. The zoom changes by the same factor every frame, and the
+// offsets move in proportion to the zoom, so that the point the zoom converges to stays put on
+// screen instead of drifting through the frame.
+[[nodiscard]] auto keyframe_at(Keyframe const &from, Keyframe const &to, int index, int frames)
+    -> Keyframe;
+
+// RGBA8 pixels of a frame, bottom row first as read back from GL.
+struct Frame {
+    int index{0};
+    std::vector<std::uint8_t> rgba;
+};
+
+// Converts and writes frames on its own thread, so that rendering and readback go on while a
+// frame is being written. At most s_depth frames are in flight: acquire() blocks when the
+// encoder is the slowest stage. Frames must be submitted in order.
+class Encoder {
+public:
+    inline static constexpr auto s_depth = 3U;
+
+    Encoder(int width, int height, std::filesystem::path output);
+
+    Encoder(Encoder const &) = delete;
+    auto operator=(Encoder const &) -> Encoder & = delete;
+    Encoder(Encoder &&) = delete;
+    auto operator=(Encoder &&) -> Encoder & = delete;
+
+    ~Encoder();
+
+    // A frame with a buffer of the right size, recycled when possible.
+    [[nodiscard]] auto acquire() -> Frame;
+    auto submit(Frame frame) -> void;
+    // Waits for all the submitted frames to be written.
+    auto finish() -> void;
+
+    [[nodiscard]] auto failures() const -> std::size_t;
+
+private:
+    auto loop(std::stop_token const &stop) -> void;
+    auto write(Frame const &frame, image::Image &img) const -> bool;
+
+    int m_width;
+    int m_height;
+    std::filesystem::path m_output;
+    std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    std::deque<Frame> m_queue;
+    std::vector<Frame> m_free;
+    std::size_t m_in_flight{0};
+    std::size_t m_failures{0};
+    std::jthread m_thread;
+};
+}  // namespace video
+
+#endif